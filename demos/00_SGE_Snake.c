@@ -3,6 +3,7 @@
 #include "SGE_Logger.h"
 #include "SGE_Math.h"
 #include "SGE_GUI.h"
+#include "SGE_PrimitiveBatch.h"
 #include <stdio.h>
 
 /* Maximum length of the snake */
@@ -366,10 +367,8 @@ void LevelRender()
 	snakeRender(&snake);
 	
 	/* Render the food using two rects, a colored filled rect and a white non-filled rect */
-	SGE_SetDrawColor(foodColor);
-	SGE_DrawFillRect(&food);
-	SGE_SetDrawColor(SGE_COLOR_WHITE);
-	SGE_DrawRect(&food);
+	SGE_PrimitiveBatchFillRect(&food, foodColor);
+	SGE_PrimitiveBatchRect(&food, SGE_COLOR_WHITE);
 	
 	/* Render Information Textures */
 	SGE_RenderTexture(helpInfoImage);
@@ -592,32 +591,24 @@ void snakeUpdate(Snake *snake)
 void snakeRender(Snake *snake)
 {
 	int i = 0;
+	SDL_Color stripeColor = {snake->color.r / 2, snake->color.g / 2, snake->color.b / 2, snake->color.a / 2};
 	
+	/* Every node is queued with it's own color and the whole snake is drawn in one go */
 	for(i = 0; i < snake->nodeCount; i++)
 	{
 		/* Draws the striped pattern */
-		if(i % 2 == 0)
-		{
-			SGE_SetDrawColorRGBA(snake->color.r / 2, snake->color.g / 2, snake->color.b / 2, snake->color.a / 2);
-		}
-		else
-		{
-			SGE_SetDrawColor(snake->color);
-		}
-		SGE_DrawFillRect(&snake->nodes[i].rect);
+		SGE_PrimitiveBatchFillRect(&snake->nodes[i].rect, (i % 2 == 0) ? stripeColor : snake->color);
 	}
 	
 	/* Draws a white non-filled rect at the head's position */
-	SGE_SetDrawColor(SGE_COLOR_WHITE);
-	SGE_DrawRect(&snake->nodes[0].rect);
+	SGE_PrimitiveBatchRect(&snake->nodes[0].rect, SGE_COLOR_WHITE);
 	
 	/* Only draw the turn points if debug mode is enabled */
 	if(debugMode)
 	{
 		for(i = 0; i < snake->turnCount; i++)
 		{
-			SGE_SetDrawColor(SGE_COLOR_GREEN);
-			SGE_DrawRect(&snake->turns[i].rect);
+			SGE_PrimitiveBatchRect(&snake->turns[i].rect, SGE_COLOR_GREEN);
 		}
 	}
 }
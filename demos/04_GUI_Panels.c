@@ -52,6 +52,8 @@ bool LevelInit()
 {
 	SGE_SetBackgroundColor(SGE_COLOR_GRAY);
 	SGE_SetTargetFPS(60);
+	/* Only the panels and labels that change are drawn again */
+	SGE_SetDirtyRectMode(true);
 	
 	/* Set up panels and their controls */
 	buttonPanel = SGE_CreateWindowPanel("Button", 100, 200, 320, 240);
@@ -64,6 +66,8 @@ bool LevelInit()
 	checkBox = SGE_CreateCheckBox(checkBoxLabel->x + checkBoxLabel->boundBox.w, checkBoxLabel->y, checkBoxPanel);
 	checkBox->onMouseUp = toggleAlpha;
 	checkBox->onMouseUp_data = checkBoxPanel;
+	/* Mostly static, drawn from a cached texture until something in it changes */
+	SGE_WindowPanelSetCached(checkBoxPanel, true);
 	
 	sliderPanel = SGE_CreateWindowPanel("Slider", 900, 200, 320, 240);
 	slider = SGE_CreateSlider(110, 100, sliderPanel);
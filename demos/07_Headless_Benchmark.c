@@ -0,0 +1,76 @@
+#include "SGE.h"
+#include "SGE_AnimatedSprite.h"
+#include "SGE_Logger.h"
+#include "SGE_Profiler.h"
+#include "SGE_SpriteBatch.h"
+
+#include <stdlib.h>
+
+static SGE_AnimatedSprite *sprites[100];
+static SGE_SpriteBatch *batch = NULL;
+static double frameBudget = 0;
+
+bool init()
+{
+	int i = 0;
+	for(i = 0; i < 100; i++)
+	{
+		sprites[i] = SGE_CreateAnimatedSprite("assets/SpriteWalk.png", 24, 24);
+		sprites[i]->x = rand() % 1200;
+		sprites[i]->y = rand() % 600;
+	}
+	batch = SGE_CreateSpriteBatch(100);
+	return true;
+}
+
+void quit()
+{
+	int i = 0;
+	for(i = 0; i < 100; i++)
+	{
+		SGE_FreeAnimatedSprite(sprites[i]);
+	}
+	SGE_FreeSpriteBatch(batch);
+
+	SGE_ProfilerPrintStats();
+
+	/* Fail the run if the render phase went over the frame budget */
+	if(frameBudget > 0)
+	{
+		SGE_ProfilerStats stats;
+		SGE_ProfilerGetPhaseStats(SGE_PROFILER_STATE_RENDER, &stats);
+		if(stats.avg > frameBudget)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Render took %.3f ms on average, budget is %.3f ms!", stats.avg, frameBudget);
+			SGE_QuitWithCode(1);
+		}
+	}
+}
+
+void render()
+{
+	int i = 0;
+	SGE_SpriteBatchBegin(batch);
+	for(i = 0; i < 100; i++)
+	{
+		SGE_SpriteBatchDrawAnimatedSprite(batch, sprites[i]);
+	}
+	SGE_SpriteBatchEnd(batch);
+}
+
+/* Usage: 07_Headless_Benchmark [frame count] [render budget in ms] */
+int main(int argc, char **argv)
+{
+	if(argc > 2)
+	{
+		frameBudget = atof(argv[2]);
+	}
+
+	if(SGE_InitHeadless(1280, 720) == NULL)
+	{
+		return 1;
+	}
+	SGE_SetFrameLimit(argc > 1 ? atoi(argv[1]) : 600);
+	SGE_AddState("Benchmark", init, quit, NULL, NULL, render);
+	return SGE_Run("Benchmark");
+}
@@ -7,6 +7,9 @@
 
 #include "SGE_GameState.h"
 
+/* Maximum number of events gathered in a single frame, the rest stay queued for the next frame */
+#define SGE_MAX_FRAME_EVENTS 256
+
 /* Contains globally accessible engine data */
 typedef struct
 {
@@ -23,6 +26,9 @@ typedef struct
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	SDL_Event event;
+	/* Events gathered for the current frame, with consecutive mouse motion merged */
+	SDL_Event frameEvents[SGE_MAX_FRAME_EVENTS];
+	int frameEventCount;
 	unsigned int randSeed;
 
 	/* Current keyboard state */
@@ -33,6 +39,8 @@ typedef struct
 	TTF_Font *defaultFont;
 	/* Default background fill color */
 	SDL_Color defaultScreenClearColor;
+	/* Color used by SGE_DrawRect(), SGE_DrawFillRect() and SGE_DrawLine() */
+	SDL_Color drawColor;
 	
 	int screenWidth;
 	int screenHeight;
@@ -49,18 +57,74 @@ typedef struct
 	bool frameRateCap;
 	double delta;
 	unsigned int lastFrameTime;
+	
+	/* High resolution frame timing data */
+	Uint64 perfFrequency;
+	Uint64 lastFrameCounter;
+	double frameDelta;
+	
+	/* Fixed timestep data, used when fixedUpdateRate is not 0 */
+	int fixedUpdateRate;
+	double fixedDelta;
+	double updateAccumulator;
+	int maxUpdatesPerFrame;
+	int lastUpdateCount;
+	double interpolationAlpha;
+	
+	/* Headless mode data, the renderer draws into an offscreen surface instead of a window */
+	bool isHeadless;
+	SDL_Surface *headlessSurface;
+	
+	/* Frame counter and the frame after which SGE_Run() stops, 0 for no limit */
+	unsigned int frameCount;
+	unsigned int frameLimit;
+	/* Value returned by SGE_Run() */
+	int exitCode;
+	
+	/*
+	 * Renderer state shadowed by SGE_SetDrawColor(), SGE_SetDrawBlendMode(), SGE_SetClipRect() and SGE_SetRenderTarget().
+	 * Calls that would not change the state are not passed on to SDL.
+	 */
+	SDL_BlendMode drawBlendMode;
+	SDL_Rect clipRect;
+	bool isClipEnabled;
+	SDL_Texture *renderTarget;
+	/* Set while blended drawing writes premultiplied alpha, see SGE_SetPremultipliedDrawing() */
+	bool isPremultipliedDrawing;
+	bool isDrawColorKnown;
+	bool isDrawBlendModeKnown;
+	bool isClipRectKnown;
+	/* State calls skipped in the current frame and in the last full frame */
+	int renderStateCallsAvoided;
+	int lastRenderStateCallsAvoided;
+	
+	/* Dirty rect mode data, see SGE_SetDirtyRectMode() */
+	bool isDirtyRectMode;
+	/* Area of the screen drawn again in the last frame, empty when nothing changed */
+	SDL_Rect lastDirtyArea;
+	/* While set, drawing into clipLimitTarget is kept inside clipLimit by SGE_SetClipRect() and SGE_ClearScreen() */
+	bool isClipLimited;
+	SDL_Rect clipLimit;
+	SDL_Texture *clipLimitTarget;
 } SGE_EngineData;
 
 SGE_EngineData *SGE_GetEngineData();
 SGE_GameState *SGE_GetCurrentState();
 
 SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight);
-void SGE_Run(const char *startStateName);
+SGE_EngineData *SGE_InitHeadless(int screenWidth, int screenHeight);
+int SGE_Run(const char *startStateName);
 void SGE_Quit();
+void SGE_QuitWithCode(int exitCode);
+void SGE_SetFrameLimit(unsigned int frames);
 
 void SGE_ToggleFullscreen();
 void SGE_ToggleVsync();
+void SGE_SetVsync(bool vsync);
 void SGE_SetTargetFPS(int fps);
+void SGE_SetFixedUpdateRate(int hz);
+void SGE_SetMaxUpdatesPerFrame(int maxUpdates);
+double SGE_GetInterpolationAlpha();
 
 void SGE_SetBackgroundColor(SDL_Color color);
 void SGE_ClearScreenRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
@@ -70,6 +134,26 @@ void SGE_SetDrawColor(SDL_Color color);
 void SGE_DrawRect(SDL_Rect *rect);
 void SGE_DrawFillRect(SDL_Rect *rect);
 void SGE_DrawLine(int x1, int y1, int x2, int y2);
+void SGE_SetDrawBlendMode(SDL_BlendMode blendMode);
+void SGE_SetClipRect(const SDL_Rect *rect);
+void SGE_SetRenderTarget(SDL_Texture *target);
+bool SGE_SetPremultipliedDrawing(bool enabled);
+SDL_BlendMode SGE_MapDrawBlendMode(SDL_BlendMode blendMode);
+SDL_BlendMode SGE_GetPremultipliedBlendMode();
+void SGE_InvalidateRenderState();
+int SGE_GetRenderStateCallsAvoided();
+
+/*
+ * Dirty rect mode
+ * Frames are drawn into a backbuffer texture that keeps it's contents between frames.
+ * Only the area covering the frame's dirty rects is cleared and drawn again, clipped to that area,
+ * and frames without dirty rects skip the state's render() and the GUI altogether.
+ * GUI changes and camera changes are found automatically, the state reports what it changes
+ * with SGE_AddDirtyRect() or SGE_AddTextureDirtyRect().
+ */
+bool SGE_SetDirtyRectMode(bool enabled);
+void SGE_AddDirtyRect(const SDL_Rect *rect);
+void SGE_InvalidateScreen();
 
 bool SGE_CheckRectsCollision(const SDL_Rect *r1, const SDL_Rect *r2);
 bool SGE_isMouseOver(SDL_Rect *rect);
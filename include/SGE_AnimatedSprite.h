@@ -2,6 +2,7 @@
 #define __SGE_ANIMATEDSPRITE_H__
 
 #include "SGE_Texture.h"
+#include "SGE_SpriteSheet.h"
 #include <stdbool.h>
 
 typedef struct
@@ -20,11 +21,24 @@ typedef struct
 	int fps;
 	int lastDrawTime;
 	bool paused;
+	
+	/* Frames of a sprite sheet, NULL when the texture is a strip of equally sized frames */
+	SGE_SpriteSheet *sheet;
+	/* Use the sheet's frame durations instead of fps, turned off by SGE_SetAnimatedSpriteFPS() */
+	bool useFrameDurations;
 } SGE_AnimatedSprite;
 
+/*
+ * Loads an animated sprite from a horizontal strip of "nFrames" equally sized frames,
+ * or from a sprite sheet when "path" is a .sgesheet file.
+ * For sprite sheets "nFrames" can limit the frames used, 0 uses all of them,
+ * and an "fps" of 0 uses the frame durations stored in the sheet.
+ */
 SGE_AnimatedSprite *SGE_CreateAnimatedSprite(const char *path, int nFrames, int fps);
 void SGE_FreeAnimatedSprite(SGE_AnimatedSprite *sprite);
 void SGE_RenderAnimatedSprite(SGE_AnimatedSprite *sprite);
+/* Advances the animation and copies the sprite's transform to it's texture, without rendering it */
+void SGE_UpdateAnimatedSpriteFrame(SGE_AnimatedSprite *sprite);
 void SGE_RestartAnimatedSprite(SGE_AnimatedSprite *sprite, int frame);
 void SGE_SetAnimatedSpriteFPS(SGE_AnimatedSprite *sprite, int fps);
 
@@ -0,0 +1,78 @@
+#ifndef __SGE_ASSET_CACHE_H__
+#define __SGE_ASSET_CACHE_H__
+
+#include "SGE_Texture.h"
+#include "SGE_Audio.h"
+#include "SGE_SpriteSheet.h"
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+
+/*
+ * Asset cache
+ * Loads every file once and hands the same asset to everyone acquiring it again, found by a hash lookup.
+ * Assets are keyed by their type and normalized path, so "assets/../assets/a.png" and "assets\a.png"
+ * are the same file, fonts are also keyed by their size.
+ *
+ * Every acquire has to be matched by a SGE_ReleaseAsset(), assets are freed once nothing references them.
+ * Never free an acquired asset directly.
+ * Assets released while switching states are kept until the next state finished initializing,
+ * so a state reloading the files of the last one gets them straight from the cache.
+ * Retained assets are kept even when unreferenced, until they are no longer retained or SGE_PurgeAssets() is called.
+ *
+ * Acquired textures are shared, create a region of them with SGE_CreateTextureRegion() to move,
+ * clip or tint a copy on it's own.
+ */
+
+typedef enum
+{
+	SGE_ASSET_TEXTURE,
+	SGE_ASSET_FONT,
+	SGE_ASSET_SFX,
+	SGE_ASSET_MUSIC,
+	SGE_ASSET_SPRITE_SHEET
+} SGE_AssetType;
+
+/* Returns the texture loaded from "path", loading it on the first acquire */
+SGE_Texture *SGE_AcquireTexture(const char *path);
+
+/* Returns the font loaded from "path" at "size" points */
+TTF_Font *SGE_AcquireFont(const char *path, int size);
+
+/* Returns the sound effect loaded from "path" */
+SGE_Sfx *SGE_AcquireSfx(const char *path);
+
+/* Returns the music stream loaded from "path" */
+SGE_Music *SGE_AcquireMusic(const char *path);
+
+/* Returns the sprite sheet loaded from a .sgesheet file */
+SGE_SpriteSheet *SGE_AcquireSpriteSheet(const char *path);
+
+/* Drops a reference to an acquired asset, freeing it when it was the last one */
+void SGE_ReleaseAsset(const void *asset);
+
+/* Returns true if the asset was acquired from the cache */
+bool SGE_IsCachedAsset(const void *asset);
+
+/* Keeps an asset loaded while nothing references it, like music played in every state */
+void SGE_SetAssetRetained(const void *asset, bool isRetained);
+
+/* Sets if assets released while switching states are kept for the next state, on by default */
+void SGE_SetAssetRetainAcrossStates(bool retain);
+
+/* Frees every unreferenced asset, including retained ones */
+void SGE_PurgeAssets();
+
+/* Returns the number of assets loaded in the cache */
+int SGE_GetCachedAssetCount();
+
+/* Prints all cached assets with their reference counts */
+void SGE_PrintAssetList();
+
+/* Called by the engine around switching states */
+void SGE_AssetCacheBeginStateSwitch();
+void SGE_AssetCacheEndStateSwitch();
+
+/* Frees all cached assets, called when the engine quits */
+void SGE_AssetCacheQuit();
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __SGE_CAMERA_H__
+#define __SGE_CAMERA_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * 2D camera
+ * While a camera is set, SGE_RenderTexture(), SGE_RenderAnimatedSprite(), the sprite batch and
+ * SGE_DrawRect(), SGE_DrawFillRect() and SGE_DrawLine() take positions in world space.
+ * Everything is moved, zoomed and rotated into the camera's viewport, and anything outside
+ * the visible area is dropped before it reaches SDL.
+ *
+ * The camera is only used for the state's render(), the GUI is always drawn in screen space.
+ * A new camera shows the world exactly like the screen, with world and screen positions matching.
+ */
+
+typedef struct
+{
+	/* World position shown at the center of the viewport */
+	float x, y;
+	/* Scale of the world on screen, 2 shows everything twice as large */
+	float zoom;
+	/* Rotation of the view in degrees, the world appears rotated the other way */
+	double rotation;
+	/* Area of the screen the camera draws into */
+	SDL_Rect viewport;
+
+	/* Derived from the values above by SGE_UpdateCamera() */
+	float cosRotation, sinRotation;
+	/* Bounding box of the visible part of the world */
+	SDL_FRect visibleArea;
+
+	/* Number of draws dropped for being out of view during the last render() */
+	int culledCount;
+} SGE_Camera;
+
+/* Creates a camera covering the whole screen */
+SGE_Camera *SGE_CreateCamera();
+
+/* Frees a camera, it is unset first if it is the current camera */
+void SGE_FreeCamera(SGE_Camera *camera);
+
+/* Sets the camera used for rendering, NULL to render in screen space */
+void SGE_SetCamera(SGE_Camera *camera);
+
+/* Returns the current camera, NULL if there is none */
+SGE_Camera *SGE_GetCamera();
+
+/*
+ * Recalculates the camera's derived values, call it after changing the camera during render().
+ * The current camera is updated automatically before every render().
+ */
+void SGE_UpdateCamera(SGE_Camera *camera);
+
+/* Converts a world position to a screen position */
+void SGE_CameraWorldToScreen(const SGE_Camera *camera, float worldX, float worldY, float *screenX, float *screenY);
+
+/* Converts a screen position, like the mouse position, to a world position */
+void SGE_CameraScreenToWorld(const SGE_Camera *camera, float screenX, float screenY, float *worldX, float *worldY);
+
+/* Returns true if any part of a world rect rotated by "rotation" degrees around it's center is in view */
+bool SGE_CameraIsVisible(const SGE_Camera *camera, const SDL_FRect *rect, double rotation);
+
+/*
+ * Moves a world rect and it's rotation into screen space.
+ * Returns false, and counts the rect as culled, if it is out of view.
+ */
+bool SGE_CameraApply(SGE_Camera *camera, SDL_FRect *rect, double *rotation);
+
+#endif
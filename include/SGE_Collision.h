@@ -0,0 +1,56 @@
+#ifndef __SGE_COLLISION_H__
+#define __SGE_COLLISION_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Batch rect collision
+ * Tests one rect against many rects stored as separate x, y, w and h arrays, several rects at a time.
+ * The fastest kernel the CPU supports (AVX2, SSE2 or NEON) is picked the first time it is used,
+ * with a plain C kernel for everything else.
+ *
+ * Rects touching only at their edges don't overlap, the same as in SGE_SpatialIndex.
+ */
+
+/* Rects stored as one array per field */
+typedef struct
+{
+	float *x;
+	float *y;
+	float *w;
+	float *h;
+	int count;
+	int capacity;
+} SGE_RectArray;
+
+/* Creates a rect array with room for "capacity" rects, it grows when needed */
+SGE_RectArray *SGE_CreateRectArray(int capacity);
+
+/* Frees a rect array */
+void SGE_FreeRectArray(SGE_RectArray *array);
+
+/* Removes every rect from the array */
+void SGE_RectArrayClear(SGE_RectArray *array);
+
+/* Adds a rect to the end of the array, returns it's index or -1 on failure */
+int SGE_RectArrayAdd(SGE_RectArray *array, const SDL_FRect *rect);
+
+/* Replaces the rect at "index" */
+void SGE_RectArraySet(SGE_RectArray *array, int index, const SDL_FRect *rect);
+
+/*
+ * Tests "query" against "count" rects.
+ * Bit i of "hitMask" is set if rect i overlaps, it needs room for (count + 31) / 32 words.
+ * The indices of the overlapping rects are written in order to "hitIndices", it needs room for "count" indices.
+ * Either of them can be NULL. Returns the number of overlapping rects.
+ */
+int SGE_CollideRectBatch(const SDL_FRect *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *hitMask, int *hitIndices);
+
+/* SGE_CollideRectBatch() for a rect array */
+int SGE_CollideRectArray(const SDL_FRect *query, const SGE_RectArray *array, Uint32 *hitMask, int *hitIndices);
+
+/* Returns the name of the kernel used by SGE_CollideRectBatch(), "AVX2", "SSE2", "NEON" or "Scalar" */
+const char *SGE_GetCollisionKernelName();
+
+#endif
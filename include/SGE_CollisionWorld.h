@@ -0,0 +1,105 @@
+#ifndef __SGE_COLLISION_WORLD_H__
+#define __SGE_COLLISION_WORLD_H__
+
+#include "SGE_Collision.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Collision world
+ * Keeps the rects of moving bodies and finds every overlapping pair once per SGE_CollisionWorldUpdate().
+ * Bodies are kept sorted by their left edge and swept along x, only bodies starting before the end of
+ * a body are tested against it, using SGE_CollideRectBatch(). Bodies move little between frames,
+ * so keeping them sorted with an insertion sort costs about one pass.
+ *
+ * Pairs are reported to the world's contact callback:
+ * SGE_CONTACT_BEGIN when two bodies start overlapping, SGE_CONTACT_STAY every update they keep overlapping,
+ * SGE_CONTACT_END when they stop overlapping or one of them is removed.
+ * Bodies can be added, moved and removed from inside the callback, removals take effect after the update.
+ */
+
+typedef enum
+{
+	SGE_CONTACT_BEGIN,
+	SGE_CONTACT_STAY,
+	SGE_CONTACT_END
+} SGE_ContactEvent;
+
+typedef void (*SGE_ContactCallback)(SGE_ContactEvent event, int bodyA, void *dataA, int bodyB, void *dataB, void *userData);
+
+typedef struct
+{
+	SDL_FRect rect;
+	void *data;
+	bool isUsed;
+	/* Removed from inside the contact callback, freed after the update */
+	bool isRemovePending;
+	/* Next unused body while the body is unused */
+	int nextFree;
+} SGE_CollisionBody;
+
+typedef struct
+{
+	/* Handles index into bodies, unused bodies are reused by later adds */
+	SGE_CollisionBody *bodies;
+	int bodyCount;
+	int bodyCapacity;
+	int firstFree;
+	int count;
+
+	/* Handles of the used bodies sorted by left edge, and their rects in the same order */
+	int *order;
+	int orderCapacity;
+	SGE_RectArray *sorted;
+	int *hits;
+	int hitCapacity;
+
+	/* Overlapping pairs of the last update, sorted, and the pairs being found in the current one */
+	Uint64 *contacts;
+	int contactCount;
+	int contactCapacity;
+	Uint64 *newContacts;
+	int newContactCount;
+	int newContactCapacity;
+
+	SGE_ContactCallback onContact;
+	void *userData;
+
+	bool isUpdating;
+	int pendingRemoveCount;
+
+	/* Number of rect tests done by the last update */
+	int lastPairTests;
+} SGE_CollisionWorld;
+
+/* Creates an empty collision world */
+SGE_CollisionWorld *SGE_CreateCollisionWorld();
+
+/* Frees a collision world, no end contacts are reported */
+void SGE_FreeCollisionWorld(SGE_CollisionWorld *world);
+
+/* Sets the function called for contact events, "userData" is passed to it */
+void SGE_CollisionWorldSetCallback(SGE_CollisionWorld *world, SGE_ContactCallback callback, void *userData);
+
+/* Adds a body, returns it's handle or -1 on failure */
+int SGE_CollisionWorldAdd(SGE_CollisionWorld *world, const SDL_FRect *rect, void *data);
+
+/* Moves or resizes a body, contacts change on the next update */
+void SGE_CollisionWorldMove(SGE_CollisionWorld *world, int body, const SDL_FRect *rect);
+
+/* Removes a body, ending it's contacts, it's handle may be returned by a later add */
+void SGE_CollisionWorldRemove(SGE_CollisionWorld *world, int body);
+
+/* Returns the user data of a body */
+void *SGE_CollisionWorldGetData(SGE_CollisionWorld *world, int body);
+
+/* Returns the rect of a body */
+const SDL_FRect *SGE_CollisionWorldGetRect(SGE_CollisionWorld *world, int body);
+
+/* Finds the overlapping pairs and reports their contact events */
+void SGE_CollisionWorldUpdate(SGE_CollisionWorld *world);
+
+/* Returns the number of overlapping pairs found by the last update */
+int SGE_CollisionWorldGetContactCount(SGE_CollisionWorld *world);
+
+#endif
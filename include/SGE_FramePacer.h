@@ -0,0 +1,34 @@
+#ifndef __SGE_FRAME_PACER_H__
+#define __SGE_FRAME_PACER_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Frame pacer that holds a target frame rate against absolute deadlines in performance counter ticks.
+ * It sleeps with SDL_Delay() until close to the deadline, then yields in a loop for the remaining time,
+ * so the frame time doesn't drift with millisecond rounding or scheduler granularity.
+ */
+
+/* Sets the target frame rate, 0 disables pacing */
+void SGE_FramePacerSetTargetFPS(int fps);
+
+/* Returns true if the pacer has a target frame rate set */
+bool SGE_FramePacerIsEnabled();
+
+/* Sets the minimum time in milliseconds that is spent yielding instead of sleeping before a deadline */
+void SGE_FramePacerSetSpinMargin(double milliseconds);
+
+/* Restarts the deadline sequence from the current time, call after a long pause like loading */
+void SGE_FramePacerReset();
+
+/* Waits until the deadline of the current frame and advances the deadline to the next frame */
+void SGE_FramePacerWait();
+
+/* Returns the time in milliseconds by which the last frame overshot its deadline */
+double SGE_FramePacerGetLastError();
+
+/* Returns the largest absolute pacing error in milliseconds seen since the last call to this function */
+double SGE_FramePacerGetMaxError();
+
+#endif
@@ -303,6 +303,14 @@ typedef struct SGE_WindowPanel
 	int textInputBoxCount;
 	SGE_ListBox *listBoxes[PANEL_MAX_LISTBOXES];
 	int listBoxCount;
+	
+	/* Render-to-texture cache, see SGE_WindowPanelSetCached() */
+	bool isCached;
+	SGE_Texture *cacheTexture;
+	SDL_Rect cacheRect;
+	Uint32 cacheSignature;
+	bool isCacheValid;
+	int cacheRedrawCount;
 } SGE_WindowPanel;
 
 bool SGE_GUI_Init();
@@ -310,6 +318,8 @@ void SGE_GUI_Quit();
 void SGE_GUI_HandleEvents();
 void SGE_GUI_Update();
 void SGE_GUI_Render();
+/* Adds the screen areas of the GUI that changed since the last call as dirty rects, see SGE_SetDirtyRectMode() */
+void SGE_GUI_AddDirtyRects();
 
 void SGE_GUI_UpdateCurrentState(const char *nextState);
 void SGE_GUI_FreeState(const char *state);
@@ -383,6 +393,18 @@ void SGE_WindowPanelCalculateMCR(SGE_WindowPanel *panel, SDL_Rect boundBox);
 void SGE_WindowPanelShouldEnableHorizontalScroll(SGE_WindowPanel *panel);
 void SGE_WindowPanelShouldEnableVerticalScroll(SGE_WindowPanel *panel);
 
+/*
+ * Panel caching
+ * A cached panel is drawn into a texture and shown as a single textured quad while nothing in it changes.
+ * Every frame the panel's state, it's child controls' state, text, position and alpha, and the mouse
+ * position over it are hashed, the panel is only drawn again when the hash changes.
+ * Translucent panels are drawn with premultiplied alpha, so they look the same cached or not.
+ * Renderers without render targets or custom blend modes draw the panel directly.
+ */
+void SGE_WindowPanelSetCached(SGE_WindowPanel *panel, bool cached);
+/* Forces a cached panel to be drawn again, for changes the hash can't see like drawing into a child's texture */
+void SGE_WindowPanelInvalidateCache(SGE_WindowPanel *panel);
+
 SDL_Point SGE_ControlGetPositionNextTo(SDL_Rect controlBoundBox, SDL_Rect targetBoundBox, SGE_ControlDirection direction, int spacing_x, int spacing_y);
 void SGE_ButtonSetPositionNextTo(SGE_Button *button, SDL_Rect targetBoundBox, SGE_ControlDirection direction, int spacing_x, int spacing_y);
 void SGE_CheckBoxSetPositionNextTo(SGE_CheckBox *checkBox, SDL_Rect targetBoundBox, SGE_ControlDirection direction, int spacing_x, int spacing_y);
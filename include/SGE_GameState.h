@@ -44,6 +44,9 @@ void SGE_SwitchStates();
 void SGE_InitState(SGE_GameState *state);
 void SGE_QuitState(SGE_GameState *state);
 
+/* Returns false if a state was created without a handleEvents() function */
+bool SGE_StateHandlesEvents(SGE_GameState *state);
+
 
 /* Get the current state as an internal SGE_GameState */
 SGE_GameState *SGE_GetState(const char *name);
@@ -0,0 +1,73 @@
+#ifndef __SGE_INPUT_H__
+#define __SGE_INPUT_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Per frame input snapshot built from the frame's gathered events.
+ * Lets states poll keyboard and mouse input in update() instead of handling events one at a time.
+ * Press and release edges are kept until a frame runs update(), so they are not lost
+ * when the fixed timestep skips updating in a frame, and are only seen by the first
+ * of several fixed steps run in one frame. Focus loss clears all input.
+ */
+
+/* Number of 32 bit words needed to store one bit per scancode */
+#define SGE_INPUT_KEY_WORDS ((SDL_NUM_SCANCODES + 31) / 32)
+
+typedef struct
+{
+	/* Keyboard bitsets indexed by scancode */
+	Uint32 keys[SGE_INPUT_KEY_WORDS];
+	Uint32 prevKeys[SGE_INPUT_KEY_WORDS];
+	Uint32 pressedKeys[SGE_INPUT_KEY_WORDS];
+	Uint32 releasedKeys[SGE_INPUT_KEY_WORDS];
+	
+	/* Mouse button bitsets in the SDL_BUTTON() format */
+	Uint32 mouseButtons;
+	Uint32 prevMouseButtons;
+	Uint32 pressedMouseButtons;
+	Uint32 releasedMouseButtons;
+	
+	int mouseX, mouseY;
+	int mouseDeltaX, mouseDeltaY;
+	int wheelX, wheelY;
+} SGE_InputState;
+
+/* Internally rebuilds the input snapshot from the current frame's events */
+void SGE_InputUpdate();
+
+/* Internally clears the press and release edges and the mouse motion once an update() has seen them */
+void SGE_InputClearEdges();
+
+/* Clears all input state, called when the window loses focus */
+void SGE_InputReset();
+
+/* Returns the current input snapshot */
+const SGE_InputState *SGE_GetInput();
+
+/* Returns true while a key is held down */
+bool SGE_InputKeyDown(SDL_Scancode scancode);
+
+/* Returns true if a key went down since the last update */
+bool SGE_InputKeyWasPressed(SDL_Scancode scancode);
+
+/* Returns true if a key went up since the last update */
+bool SGE_InputKeyWasReleased(SDL_Scancode scancode);
+
+/* Returns true while a mouse button (SDL_BUTTON_LEFT etc.) is held down */
+bool SGE_InputMouseDown(int button);
+
+/* Returns true if a mouse button went down since the last update */
+bool SGE_InputMouseWasPressed(int button);
+
+/* Returns true if a mouse button went up since the last update */
+bool SGE_InputMouseWasReleased(int button);
+
+/* Gets the mouse motion since the last update */
+void SGE_InputGetMouseDelta(int *dx, int *dy);
+
+/* Gets the mouse wheel scroll since the last update, positive y is away from the user */
+void SGE_InputGetWheel(int *x, int *y);
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef __SGE_PARTICLE_SYSTEM_H__
+#define __SGE_PARTICLE_SYSTEM_H__
+
+#include "SGE_Texture.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Particle system
+ * Emitters spawn particles that fly, fall and fade until their lifetime runs out.
+ * Every emitter keeps it's particles as one array per field and updates them in passes:
+ * moving them, finding the dead ones and packing the live ones together.
+ * The moving and finding passes use the fastest kernel the CPU supports (SSE2 or NEON),
+ * with a plain C kernel for everything else.
+ *
+ * Each emitter draws all it's particles with a single SDL_RenderGeometry() call, as squares facing the screen,
+ * textured with the emitter's texture or filled with their color. Falls back to one draw per particle
+ * on SDL versions older than 2.0.18. Particles live in world space while a camera is set.
+ */
+
+typedef struct
+{
+	/* Spawn area, particles start at a random point of the w * h rect at x, y */
+	float x, y;
+	float w, h;
+	/* Particles spawned per second while isEmitting is set */
+	float rate;
+	bool isEmitting;
+	/* Range of the particles' lifetimes in seconds */
+	float minLifetime, maxLifetime;
+	/* Range of the starting speeds in pixels per second */
+	float minSpeed, maxSpeed;
+	/* Direction particles are sent in and the angle they spread over, in degrees, 0 is to the right */
+	float direction, spread;
+	/* Acceleration applied to all particles in pixels per second squared */
+	float gravityX, gravityY;
+	/* Fraction of the speed lost every second */
+	float drag;
+	/* Size of the particles when spawned and when they die, in pixels */
+	float startSize, endSize;
+	/* Color of the particles when spawned and when they die, each channel of the start color is randomized by up to colorJitter */
+	SDL_Color startColor, endColor;
+	Uint8 colorJitter;
+	/* Texture drawn for each particle, NULL for plain squares */
+	SGE_Texture *texture;
+	SDL_BlendMode blendMode;
+
+	/* Particle data, one array per field, the first "count" particles are alive */
+	float *posX, *posY;
+	float *velX, *velY;
+	float *age, *lifetime;
+	SDL_Color *colors;
+	int count;
+	int capacity;
+	float spawnAccumulator;
+
+	/* Dead particles of the last update, one bit each */
+	Uint32 *deadMask;
+	/* Geometry built when drawing */
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_Vertex *vertices;
+	int *indices;
+#endif
+} SGE_ParticleEmitter;
+
+typedef struct
+{
+	SGE_ParticleEmitter **emitters;
+	int emitterCount;
+	int emitterCapacity;
+	Uint32 randomState;
+
+	/* Number of live particles after the last update */
+	int liveCount;
+	/* Number of draw calls used by the last SGE_ParticleSystemRender() */
+	int lastDrawCalls;
+} SGE_ParticleSystem;
+
+/* Creates an empty particle system */
+SGE_ParticleSystem *SGE_CreateParticleSystem();
+
+/* Frees a particle system and all it's emitters */
+void SGE_FreeParticleSystem(SGE_ParticleSystem *system);
+
+/* Adds an emitter for up to "maxParticles" live particles, it starts out emitting white particles upwards */
+SGE_ParticleEmitter *SGE_ParticleSystemAddEmitter(SGE_ParticleSystem *system, int maxParticles);
+
+/* Removes and frees an emitter along with it's particles */
+void SGE_ParticleSystemRemoveEmitter(SGE_ParticleSystem *system, SGE_ParticleEmitter *emitter);
+
+/* Spawns "count" particles right away, as many as there is room for */
+void SGE_ParticleEmitterBurst(SGE_ParticleSystem *system, SGE_ParticleEmitter *emitter, int count);
+
+/* Removes all of an emitter's particles */
+void SGE_ParticleEmitterClear(SGE_ParticleEmitter *emitter);
+
+/* Moves all particles by "delta" seconds, removes the dead ones and spawns new ones */
+void SGE_ParticleSystemUpdate(SGE_ParticleSystem *system, float delta);
+
+/* Draws every emitter's particles */
+void SGE_ParticleSystemRender(SGE_ParticleSystem *system);
+
+/* Returns the name of the kernel used for updates, "SSE2", "NEON" or "Scalar" */
+const char *SGE_GetParticleKernelName();
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __SGE_PRIMITIVE_BATCH_H__
+#define __SGE_PRIMITIVE_BATCH_H__
+
+#include <SDL2/SDL.h>
+
+/*
+ * Primitive batch
+ * Queues filled rects, outlined rects, lines and filled quads with their own colors and draws them all at once,
+ * as a single colored SDL_RenderGeometry() call, in the order they were queued.
+ * On SDL versions older than 2.0.18, consecutive primitives of the same kind and color
+ * are drawn together with SDL_RenderFillRects() / SDL_RenderDrawRects().
+ *
+ * SGE_DrawRect(), SGE_DrawFillRect() and SGE_DrawLine() queue into this batch.
+ * The batch is flushed before any texture is rendered, and after the state and the GUI render,
+ * so drawing order is kept when mixing primitives and SGE textures.
+ */
+
+/* Queues a filled rect */
+void SGE_PrimitiveBatchFillRect(const SDL_Rect *rect, SDL_Color color);
+
+/* Queues a one pixel wide rect outline */
+void SGE_PrimitiveBatchRect(const SDL_Rect *rect, SDL_Color color);
+
+/* Queues a one pixel wide line between two points, including both end points */
+void SGE_PrimitiveBatchLine(int x1, int y1, int x2, int y2, SDL_Color color);
+
+/* Queues a filled convex quad, the corners are given in order around it's edge */
+void SGE_PrimitiveBatchFillQuad(const SDL_FPoint corners[4], SDL_Color color);
+
+/* Draws and clears all queued primitives */
+void SGE_PrimitiveBatchFlush();
+
+/* Returns the number of primitives waiting to be drawn */
+int SGE_PrimitiveBatchGetCount();
+
+/* Returns the number of draw calls the last flush made */
+int SGE_PrimitiveBatchGetLastDrawCalls();
+
+/* Internally frees the batch's buffers */
+void SGE_PrimitiveBatchQuit();
+
+#endif
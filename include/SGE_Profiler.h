@@ -0,0 +1,70 @@
+#ifndef __SGE_PROFILER_H__
+#define __SGE_PROFILER_H__
+
+#include <stdbool.h>
+
+/*
+ * Frame profiler that times each phase of the SGE_Run() loop.
+ * The time spent in every phase is summed up over a frame and stored in a ring buffer of the last frames,
+ * which can be queried for min / avg / max / 99th percentile timings.
+ */
+
+/* Number of frames kept in the profiler history */
+#define SGE_PROFILER_HISTORY_SIZE 256
+
+/* The phases of a frame in SGE_Run() */
+typedef enum
+{
+	SGE_PROFILER_EVENTS,        // Event polling and the state's handleEvents()
+	SGE_PROFILER_GUI_EVENTS,    // SGE_GUI_HandleEvents()
+	SGE_PROFILER_UPLOAD,        // SGE_UpdateTextureLoading()
+	SGE_PROFILER_GUI_UPDATE,    // SGE_GUI_Update()
+	SGE_PROFILER_STATE_UPDATE,  // The state's update(), summed over fixed steps
+	SGE_PROFILER_STATE_RENDER,  // Screen clear and the state's render()
+	SGE_PROFILER_GUI_RENDER,    // SGE_GUI_Render()
+	SGE_PROFILER_PRESENT,       // SDL_RenderPresent()
+	SGE_PROFILER_STATE_SWITCH,  // SGE_SwitchStates()
+	SGE_PROFILER_FRAME_CAP,     // Waiting for the frame pacer
+	SGE_PROFILER_PHASE_COUNT
+} SGE_ProfilerPhase;
+
+/* Timing statistics of a phase over the recorded history, in milliseconds */
+typedef struct
+{
+	double min;
+	double avg;
+	double max;
+	double p99;
+	double last;
+	int sampleCount;
+} SGE_ProfilerStats;
+
+/* Enables or disables the profiler, enabled by default */
+void SGE_ProfilerSetEnabled(bool enabled);
+bool SGE_ProfilerIsEnabled();
+
+/* Starts timing a phase, a phase can be timed multiple times in a frame */
+void SGE_ProfilerBegin(SGE_ProfilerPhase phase);
+
+/* Stops timing a phase and adds the elapsed time to the phase's total for the current frame, does nothing if the phase wasn't begun */
+void SGE_ProfilerEnd(SGE_ProfilerPhase phase);
+
+/* Stores the current frame's phase timings in the history and starts a new frame */
+void SGE_ProfilerEndFrame();
+
+/* Clears the recorded history */
+void SGE_ProfilerReset();
+
+/* Fills "stats" with the timing statistics of a phase over the recorded history */
+void SGE_ProfilerGetPhaseStats(SGE_ProfilerPhase phase, SGE_ProfilerStats *stats);
+
+/* Returns the phase with the highest average time over the recorded history */
+SGE_ProfilerPhase SGE_ProfilerGetSlowestPhase();
+
+/* Returns a short display name of a phase */
+const char *SGE_ProfilerGetPhaseName(SGE_ProfilerPhase phase);
+
+/* Prints the statistics of all phases to the log */
+void SGE_ProfilerPrintStats();
+
+#endif
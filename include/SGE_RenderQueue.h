@@ -0,0 +1,114 @@
+#ifndef __SGE_RENDER_QUEUE_H__
+#define __SGE_RENDER_QUEUE_H__
+
+#include "SGE_Texture.h"
+#include "SGE_SpriteBatch.h"
+#include "SGE_Camera.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Render queue
+ * Collects draws with a layer and a depth and draws them sorted, instead of in the order they were made.
+ * Lower layers are drawn first, then lower depths within a layer. Draws with the same layer and depth
+ * are grouped by texture and blend mode, so runs of sprites sharing a texture become a single
+ * sprite batch draw call. Give overlapping draws different depths when their order matters.
+ *
+ * Every draw gets a 64 bit sort key: layer, depth, kind of draw, texture and blend mode,
+ * from the highest bits down. The keys are radix sorted, which keeps draws with equal keys in
+ * the order they were queued.
+ *
+ * Draws keep the camera that was set when they were queued, and the texture's modulation at that time.
+ *
+ * The frame queue is drawn by SGE_Run() after the state's render(), with the GUI drawn on
+ * SGE_RENDER_LAYER_GUI, so anything the state queues on a higher layer is drawn over the GUI.
+ * Anything drawn directly in render() is drawn under all queued draws.
+ */
+
+/* Layer the GUI is drawn on when the frame queue is used */
+#define SGE_RENDER_LAYER_GUI 128
+
+typedef Uint64 SGE_RenderKey;
+
+typedef enum
+{
+	SGE_RENDER_COMMAND_FILL_RECT,
+	SGE_RENDER_COMMAND_RECT,
+	SGE_RENDER_COMMAND_LINE,
+	SGE_RENDER_COMMAND_SPRITE,
+	SGE_RENDER_COMMAND_CALLBACK
+} SGE_RenderCommandType;
+
+typedef void (*SGE_RenderCallback)(void *data);
+
+typedef struct
+{
+	SGE_RenderCommandType type;
+	/* Camera set when the draw was queued */
+	SGE_Camera *camera;
+
+	/* Sprites are kept in screen space, ready for the sprite batch */
+	SGE_SpriteBatchItem sprite;
+
+	/* Primitives, a line's end points are stored as x, y and w, h */
+	SDL_Rect rect;
+	SDL_Color color;
+	SDL_BlendMode blendMode;
+
+	SGE_RenderCallback callback;
+	void *data;
+} SGE_RenderCommand;
+
+typedef struct
+{
+	SGE_RenderCommand *commands;
+	SGE_RenderKey *keys;
+	int count;
+	int capacity;
+
+	/* Radix sort buffers, the keys and command indices are sorted back and forth between them */
+	SGE_RenderKey *sortKeys[2];
+	int *sortOrder[2];
+
+	/* Draws the sprite runs */
+	SGE_SpriteBatch *spriteBatch;
+
+	/* Number of sprite and primitive draw calls made by the last SGE_RenderQueueExecute(), callbacks are not counted */
+	int lastDrawCalls;
+	/* Number of draws in the last SGE_RenderQueueExecute() */
+	int lastCommandCount;
+} SGE_RenderQueue;
+
+/* Creates a render queue with room for "capacity" draws, it grows when needed */
+SGE_RenderQueue *SGE_CreateRenderQueue(int capacity);
+
+/* Frees a render queue */
+void SGE_FreeRenderQueue(SGE_RenderQueue *queue);
+
+/* Removes all queued draws without drawing them */
+void SGE_RenderQueueClear(SGE_RenderQueue *queue);
+
+/* Queues a texture using it's own position, size, clip rect, rotation, flip and modulation */
+void SGE_RenderQueueDrawTexture(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_Texture *texture);
+
+/* Queues the "clip" part of a texture into "dest", NULL for "clip" uses the whole texture */
+void SGE_RenderQueueDraw(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_Texture *texture, const SDL_Rect *clip, const SDL_FRect *dest, double rotation, SDL_RendererFlip flip);
+
+/* Queues primitives like SGE_DrawFillRect(), SGE_DrawRect() and SGE_DrawLine(), with the current draw blend mode */
+void SGE_RenderQueueFillRect(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, const SDL_Rect *rect, SDL_Color color);
+void SGE_RenderQueueRect(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, const SDL_Rect *rect, SDL_Color color);
+void SGE_RenderQueueLine(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, int x1, int y1, int x2, int y2, SDL_Color color);
+
+/* Queues a function that draws anything it wants in the queued order, like text or a particle system */
+void SGE_RenderQueueCallback(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_RenderCallback callback, void *data);
+
+/* Sorts and draws all queued draws, then clears the queue */
+void SGE_RenderQueueExecute(SGE_RenderQueue *queue);
+
+/* Returns the queue SGE_Run() draws every frame after the state's render() */
+SGE_RenderQueue *SGE_GetFrameRenderQueue();
+
+/* Internally frees the frame queue */
+void SGE_RenderQueueQuit();
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef __SGE_SPATIAL_INDEX_H__
+#define __SGE_SPATIAL_INDEX_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Spatial index
+ * Stores rects in a uniform grid of square cells hashed into buckets, so only rects sharing cells
+ * with an area are tested instead of every rect. Use it to find collision pairs without testing
+ * all pairs, or to find what is on screen by querying with a camera's visibleArea.
+ *
+ * Rects are added with SGE_SpatialIndexInsert(), which returns a handle used to move and remove them.
+ * Moving a rect only touches the cells it entered or left, rects moving inside their cells cost nothing.
+ * The cell size should be about the size of a typical rect, rects spanning more than
+ * SGE_SPATIAL_INDEX_MAX_SPAN cells on a side are kept in a separate list that is always tested.
+ *
+ * Rects touching only at their edges don't overlap.
+ * Callbacks must not insert, move or remove rects of the index they were called from.
+ */
+
+#define SGE_SPATIAL_INDEX_MAX_SPAN 8
+
+/* A rect stored in the index */
+typedef struct
+{
+	SDL_FRect rect;
+	void *data;
+	/* Range of cells covered by the rect */
+	int minCellX, minCellY, maxCellX, maxCellY;
+	/* Rects too large for the grid are kept in the large list instead */
+	bool isLarge;
+	bool isUsed;
+	/* Last query the entry was tested in, entries spanning several cells are only tested once */
+	unsigned int queryMark;
+	/* Next unused entry while the entry is unused */
+	int nextFree;
+} SGE_SpatialEntry;
+
+/* Entry stored in a cell */
+typedef struct
+{
+	int cellX, cellY;
+	int entry;
+} SGE_SpatialCellItem;
+
+typedef struct
+{
+	SGE_SpatialCellItem *items;
+	int count;
+	int capacity;
+} SGE_SpatialBucket;
+
+typedef struct
+{
+	float cellSize;
+
+	/* Cells hashed into a power of two number of buckets */
+	SGE_SpatialBucket *buckets;
+	int bucketCount;
+	int cellItemCount;
+
+	/* Handles index into entries, unused entries are reused by later inserts */
+	SGE_SpatialEntry *entries;
+	int entryCount;
+	int entryCapacity;
+	int firstFree;
+	int count;
+
+	/* Entries of rects too large for the grid */
+	SGE_SpatialBucket large;
+
+	unsigned int queryMark;
+
+	/* Number of rect tests done by the last query or pair search */
+	int lastTests;
+} SGE_SpatialIndex;
+
+/*
+ * Creates a spatial index with cells of "cellSize" pixels.
+ * "bucketCount" is rounded up to a power of two, 0 uses 1024.
+ */
+SGE_SpatialIndex *SGE_CreateSpatialIndex(float cellSize, int bucketCount);
+
+/* Frees a spatial index */
+void SGE_FreeSpatialIndex(SGE_SpatialIndex *index);
+
+/* Removes every rect from the index */
+void SGE_SpatialIndexClear(SGE_SpatialIndex *index);
+
+/* Adds a rect with some user data, returns the rect's handle or -1 on failure */
+int SGE_SpatialIndexInsert(SGE_SpatialIndex *index, const SDL_FRect *rect, void *data);
+
+/* Moves or resizes a rect */
+void SGE_SpatialIndexMove(SGE_SpatialIndex *index, int handle, const SDL_FRect *rect);
+
+/* Removes a rect, it's handle may be returned by a later insert */
+void SGE_SpatialIndexRemove(SGE_SpatialIndex *index, int handle);
+
+/* Returns the user data of a rect */
+void *SGE_SpatialIndexGetData(SGE_SpatialIndex *index, int handle);
+
+/* Returns the current rect of a handle */
+const SDL_FRect *SGE_SpatialIndexGetRect(SGE_SpatialIndex *index, int handle);
+
+/*
+ * Calls "callback" once for every rect overlapping "area".
+ * Returns the number of rects found, "callback" can be NULL to only count them.
+ */
+int SGE_SpatialIndexQuery(SGE_SpatialIndex *index, const SDL_FRect *area, void (*callback)(int handle, void *data, void *userData), void *userData);
+
+/*
+ * Calls "callback" once for every pair of overlapping rects.
+ * Returns the number of pairs found, "callback" can be NULL to only count them.
+ */
+int SGE_SpatialIndexPairs(SGE_SpatialIndex *index, void (*callback)(int handleA, void *dataA, int handleB, void *dataB, void *userData), void *userData);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __SGE_SPRITE_BATCH_H__
+#define __SGE_SPRITE_BATCH_H__
+
+#include "SGE_Texture.h"
+#include "SGE_AnimatedSprite.h"
+#include <stdbool.h>
+
+/*
+ * Sprite batch renderer
+ * Collects textured quads between SGE_SpriteBatchBegin() and SGE_SpriteBatchEnd(),
+ * then draws every run of quads sharing a texture and blend mode with a single SDL_RenderGeometry() call.
+ * Falls back to one SDL_RenderCopyEx() per quad on SDL versions older than 2.0.18.
+ */
+
+/* A single queued quad */
+typedef struct
+{
+	SDL_Texture *texture;
+	int textureWidth, textureHeight;
+	SDL_BlendMode blendMode;
+	SDL_Rect clip;
+	SDL_FRect dest;
+	double rotation;
+	SDL_RendererFlip flip;
+	SDL_Color color;
+} SGE_SpriteBatchItem;
+
+typedef struct
+{
+	SGE_SpriteBatchItem *items;
+	int itemCount;
+	int capacity;
+
+	/* Draw order of the items, and the geometry built from them when the batch is drawn */
+	int *order;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_Vertex *vertices;
+	int *indices;
+#endif
+
+	/*
+	 * Sort the quads by texture and blend mode before drawing, on by default.
+	 * Sorting is stable, but quads using different textures no longer draw in submission order,
+	 * turn it off when overlapping sprites from different textures have to keep their order.
+	 */
+	bool sortByTexture;
+
+	/* Number of draw calls used for the last SGE_SpriteBatchEnd() */
+	int lastDrawCalls;
+} SGE_SpriteBatch;
+
+/* Creates a sprite batch with room for "capacity" quads, it grows when needed */
+SGE_SpriteBatch *SGE_CreateSpriteBatch(int capacity);
+
+/* Frees a sprite batch */
+void SGE_FreeSpriteBatch(SGE_SpriteBatch *batch);
+
+/* Clears the batch to start collecting quads */
+void SGE_SpriteBatchBegin(SGE_SpriteBatch *batch);
+
+/* Queues a texture using it's own position, size, clip rect, rotation, flip and modulation */
+void SGE_SpriteBatchDrawTexture(SGE_SpriteBatch *batch, SGE_Texture *texture);
+
+/* Queues the "clip" part of a texture into "dest", NULL for "clip" uses the whole texture */
+void SGE_SpriteBatchDraw(SGE_SpriteBatch *batch, SGE_Texture *texture, const SDL_Rect *clip, const SDL_FRect *dest, double rotation, SDL_RendererFlip flip);
+
+/* Queues an item that is already in screen space, it's texture must not be stale */
+void SGE_SpriteBatchDrawItem(SGE_SpriteBatch *batch, const SGE_SpriteBatchItem *item);
+
+/* Advances an animated sprite like SGE_RenderAnimatedSprite() and queues it's current frame */
+void SGE_SpriteBatchDrawAnimatedSprite(SGE_SpriteBatch *batch, SGE_AnimatedSprite *sprite);
+
+/* Sorts and draws all queued quads */
+void SGE_SpriteBatchEnd(SGE_SpriteBatch *batch);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef __SGE_SPRITE_SHEET_H__
+#define __SGE_SPRITE_SHEET_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Sprite sheets
+ * A sprite sheet is an image with animation frames packed in 2D and trimmed of their transparent borders,
+ * next to a .sgesheet file describing every frame. Sheets are built ahead of time with
+ * SGE_BuildSpriteSheet() or the tools/SGE_SpriteSheetBuilder program, and loaded by passing
+ * the .sgesheet file to SGE_CreateAnimatedSprite().
+ *
+ * .sgesheet layout, all values little endian:
+ *   "SGES", Uint16 version, Uint16 frame count, Uint16 image name length, image name (no terminator),
+ *   then for every frame: Uint16 x, y, w, h, Sint16 offsetX, offsetY, Uint16 sourceW, sourceH,
+ *   Sint16 pivotX, pivotY, Uint16 duration.
+ * The image name is relative to the folder of the .sgesheet file.
+ */
+
+#define SGE_SPRITE_SHEET_VERSION 1
+
+typedef struct
+{
+	/* Part of the sheet image holding the trimmed frame */
+	SDL_Rect rect;
+	/* Position of the trimmed frame inside the untrimmed one */
+	int offsetX, offsetY;
+	/* Size of the untrimmed frame */
+	int sourceW, sourceH;
+	/* Anchor point of the frame, relative to the untrimmed frame */
+	int pivotX, pivotY;
+	/* Time to show the frame for in milliseconds, 0 to use the sprite's fps */
+	int duration;
+} SGE_SpriteSheetFrame;
+
+typedef struct
+{
+	/* Path of the sheet image, relative to the working directory */
+	char *imagePath;
+	SGE_SpriteSheetFrame *frames;
+	int frameCount;
+} SGE_SpriteSheet;
+
+/* Loads a .sgesheet file */
+SGE_SpriteSheet *SGE_LoadSpriteSheet(const char *path);
+
+/* Frees a loaded sprite sheet */
+void SGE_FreeSpriteSheet(SGE_SpriteSheet *sheet);
+
+/*
+ * Packs the images 1.png, 2.png, ... [nFrames].png from a folder into a sprite sheet.
+ * Writes [outputPath].png and [outputPath].sgesheet, every frame gets "frameDuration" milliseconds.
+ * The sheet is kept at most "maxSize" pixels wide and high, 0 for 4096.
+ */
+bool SGE_BuildSpriteSheet(const char *folderPath, int nFrames, const char *outputPath, int frameDuration, int maxSize);
+
+#endif
@@ -3,8 +3,35 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
 
-typedef struct
+typedef enum
+{
+	SGE_TEXT_MODE_SOLID,
+	SGE_TEXT_MODE_SHADED,
+	SGE_TEXT_MODE_BLENDED
+} SGE_TextRenderMode;
+
+/* Where a texture's pixels come from, used to upload it again into a new renderer */
+typedef enum
+{
+	SGE_TEXTURE_SOURCE_NONE,
+	SGE_TEXTURE_SOURCE_FILE,
+	SGE_TEXTURE_SOURCE_TEXT,
+	SGE_TEXTURE_SOURCE_PIXELS,
+	SGE_TEXTURE_SOURCE_REGION,
+	SGE_TEXTURE_SOURCE_TARGET
+} SGE_TextureSource;
+
+/* Progress of a texture loaded with SGE_LoadTextureAsync(), other textures are always ready */
+typedef enum
+{
+	SGE_TEXTURE_READY,
+	SGE_TEXTURE_LOADING,
+	SGE_TEXTURE_LOAD_FAILED
+} SGE_TextureLoadState;
+
+typedef struct SGE_Texture
 {
 	int x, y, w, h;
 	int original_w, original_h;
@@ -13,19 +40,55 @@ typedef struct
 	SDL_RendererFlip flip;
 	SDL_Rect clipRect;
 	SDL_Rect destRect;
+	/* Screen area covered by the last SGE_RenderTexture(), including rotation, empty if it was out of view */
+	SDL_Rect drawnRect;
+	
+	/* Modulation and blending set through the SGE_SetTexture*() functions */
+	SDL_Color colorMod;
+	SDL_BlendMode blendMode;
+	
+	/* Source data of the texture */
+	SGE_TextureSource source;
+	char *sourcePath;
+	char *sourceText;
+	TTF_Font *sourceFont;
+	SDL_Color sourceFG;
+	SDL_Color sourceBG;
+	SGE_TextRenderMode sourceTextMode;
+	int sourceWordWrap;
+	void *sourcePixels;
+	
+	/* Set when the SDL_Texture was lost and has to be uploaded again before rendering */
+	bool isStale;
+	/* Textures that are still loading have no size and are skipped when rendered */
+	SGE_TextureLoadState loadState;
+	/* Estimated video memory used by the SDL_Texture in bytes */
+	size_t memorySize;
+	
+	/*
+	 * Texture this one is a region of, like an atlas page, NULL for textures owning their SDL_Texture.
+	 * Regions share their parent's SDL_Texture and apply their own modulation when rendered.
+	 */
+	struct SGE_Texture *parent;
+	/* Number of regions sharing this texture's SDL_Texture */
+	int regionCount;
+	/* Position of the region inside the parent, clipRect starts out covering the region */
+	int regionX, regionY;
+	/* Atlas the texture is packed in, if any */
+	struct SGE_TextureAtlas *atlas;
+	
+	/* Internal list of all live textures */
+	struct SGE_Texture *prev;
+	struct SGE_Texture *next;
 } SGE_Texture;
 
-typedef enum
-{
-	SGE_TEXT_MODE_SOLID,
-	SGE_TEXT_MODE_SHADED,
-	SGE_TEXT_MODE_BLENDED
-} SGE_TextRenderMode;
-
 void SGE_SetTextureFontBGColor(SDL_Color bgColor);
 void SGE_SetTextureWordWrap(int wrap);
 SGE_Texture* SGE_LoadTexture(const char *path);
 SGE_Texture* SGE_CreateTextureFromText(const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode);
+SGE_Texture* SGE_CreateTextureFromPixels(const void *pixels, int w, int h, int pitch);
+SGE_Texture* SGE_CreateTextureRegion(SGE_Texture *parent, const SDL_Rect *region);
+SGE_Texture* SGE_CreateTargetTexture(int w, int h);
 void SGE_UpdateTextureFromText(SGE_Texture *gTexture, const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode);
 void SGE_FreeTexture(SGE_Texture *gTexture);
 void SGE_RenderTexture(SGE_Texture *gTexture);
@@ -33,4 +96,83 @@ void SGE_SetTextureColor(SGE_Texture *gTexture, Uint8 red, Uint8 green, Uint8 bl
 void SGE_SetTextureBlendMode(SGE_Texture *gTexture, SDL_BlendMode blending);
 void SGE_SetTextureAlpha(SGE_Texture *gTexture, Uint8 alpha);
 
+/* Applies a texture's blend mode and mods to it's SDL_Texture again, after it was drawn through SDL with others */
+void SGE_RestoreTextureMods(SGE_Texture *gTexture);
+
+/* Returns the color and alpha mod a texture is drawn with, premultiplied textures have their color scaled by their alpha */
+SDL_Color SGE_GetTextureDrawColor(SGE_Texture *gTexture);
+
+/*
+ * Marks where a texture was last drawn and where it will be drawn next as dirty, see SGE_SetDirtyRectMode().
+ * Call it after moving, resizing, rotating or otherwise changing a texture the state draws.
+ * Only the last place a texture was drawn is known, textures drawn several times a frame need SGE_AddDirtyRect().
+ */
+void SGE_AddTextureDirtyRect(SGE_Texture *gTexture);
+
+/*
+ * Asynchronous loading
+ * SGE_LoadTextureAsync() returns right away with a texture that is still loading. The image is decoded
+ * on a pool of worker threads, and uploaded on the main thread by SGE_Run() at the start of a frame,
+ * which stops uploading once the frame's upload budget is spent. Loading a whole level that way
+ * keeps the window responsive, a loading screen can show SGE_GetLoadingTextureCount().
+ *
+ * The texture gets it's size and blend mode once it is uploaded, like with SGE_LoadTexture(),
+ * unless another blend mode was set while it was loading. Color and alpha mods set while loading are kept.
+ * Check SGE_IsTextureReady() before relying on it's size. Loading textures can be freed at any time.
+ * Regions of a loading texture are drawn once it is ready, they need their rect before it's size is known.
+ */
+SGE_Texture* SGE_LoadTextureAsync(const char *path);
+
+/* Returns true once a texture loaded with SGE_LoadTextureAsync() is uploaded, or a region's parent is, always true for other textures */
+bool SGE_IsTextureReady(SGE_Texture *gTexture);
+
+/* Returns the number of textures still loading */
+int SGE_GetLoadingTextureCount();
+
+/* Sets the time spent uploading loaded textures every frame in milliseconds, 4 by default. At least one texture is uploaded per frame. */
+void SGE_SetTextureUploadBudget(double milliseconds);
+
+/* Uploads loaded textures until the upload budget is spent, called by SGE_Run() every frame */
+void SGE_UpdateTextureLoading();
+
+/* Waits for all loading textures and uploads them */
+void SGE_FinishTextureLoading();
+
+/* Internally stops the loading threads, textures still loading fail */
+void SGE_TextureLoadingQuit();
+
+/*
+ * Texture registry
+ * Every texture remembers where it's pixels came from, so it can be uploaded again when the renderer loses it.
+ * Lost textures are marked stale and uploaded again the next time they are rendered.
+ * Text textures need the font they were created with to still be open.
+ */
+
+/*
+ * Internally marks all live textures as stale.
+ * "rendererDestroyed" is true when the SDL_Textures were already destroyed along with their renderer.
+ */
+void SGE_InvalidateTextures(bool rendererDestroyed);
+
+/*
+ * Internally marks all render target textures as stale, after the renderer lost their contents.
+ * Restoring a target only gives it back empty, whoever draws into it has to check isStale and draw it again.
+ */
+void SGE_InvalidateTargetTextures();
+
+/* Uploads a stale texture again into the current renderer */
+bool SGE_RestoreTexture(SGE_Texture *gTexture);
+
+/* Uploads all stale textures right away instead of on their next render, e.g. behind a loading screen */
+void SGE_ReloadTextures();
+
+/* Returns the number of live textures */
+int SGE_GetTextureCount();
+
+/* Returns the estimated video memory used by all uploaded textures in bytes */
+size_t SGE_GetTextureMemoryUsage();
+
+/* Prints the texture count, memory usage and the source of every live texture to the log */
+void SGE_PrintTextureList();
+
 #endif
\ No newline at end of file
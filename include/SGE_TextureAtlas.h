@@ -0,0 +1,89 @@
+#ifndef __SGE_TEXTURE_ATLAS_H__
+#define __SGE_TEXTURE_ATLAS_H__
+
+#include "SGE_Texture.h"
+#include <stdbool.h>
+
+/*
+ * Texture atlas
+ * Packs small images into shared pages as they are loaded, using a skyline packer.
+ * Every image is returned as an SGE_Texture whose clipRect points into it's page,
+ * so sprites from the same page draw with a single texture bind in a sprite batch.
+ *
+ * The returned textures are freed with SGE_FreeTexture() like any other texture,
+ * which gives their space back to the atlas. Space freed inside a page that is still
+ * in use is only reclaimed by SGE_TextureAtlasRepack(), call it after freeing a state's
+ * textures in it's quit() function.
+ */
+
+#define SGE_ATLAS_DEFAULT_PAGE_SIZE 2048
+
+/* A segment of the skyline, the packed area's top edge across a page */
+typedef struct
+{
+	int x, y, w;
+} SGE_AtlasSkylineNode;
+
+typedef struct
+{
+	/* Page texture, it keeps a copy of the page's pixels in system memory to restore and repack it */
+	SGE_Texture *texture;
+
+	SGE_AtlasSkylineNode *skyline;
+	int skylineCount;
+
+	/* Number of live images in the page and the area they use, including padding */
+	int regionCount;
+	int usedArea;
+} SGE_TextureAtlasPage;
+
+/* A packed image */
+typedef struct
+{
+	SGE_Texture *texture;
+	int page;
+	/* Position and size of the image inside it's page */
+	SDL_Rect rect;
+} SGE_TextureAtlasRegion;
+
+typedef struct SGE_TextureAtlas
+{
+	SGE_TextureAtlasPage *pages;
+	int pageCount;
+	int pageSize;
+
+	SGE_TextureAtlasRegion *regions;
+	int regionCount;
+	int regionCapacity;
+
+	/* Empty pixels kept around every image, stops neighbours from bleeding in when scaled */
+	int padding;
+	/* Images larger than this in any direction get their own texture instead */
+	int maxImageSize;
+} SGE_TextureAtlas;
+
+/* Creates an empty atlas with pages of "pageSize" pixels square, 0 for the default size */
+SGE_TextureAtlas *SGE_CreateTextureAtlas(int pageSize);
+
+/* Frees the atlas, it's pages and all the textures still packed in it */
+void SGE_FreeTextureAtlas(SGE_TextureAtlas *atlas);
+
+/* Loads an image into the atlas, large images are loaded as a normal texture */
+SGE_Texture *SGE_TextureAtlasLoad(SGE_TextureAtlas *atlas, const char *path);
+
+/* Packs 32 bit RGBA pixels into the atlas, "pitch" is the length of a row in bytes */
+SGE_Texture *SGE_TextureAtlasAddPixels(SGE_TextureAtlas *atlas, const void *pixels, int w, int h, int pitch);
+
+/* Frees a packed texture and gives it's space back, SGE_FreeTexture() calls this for packed textures */
+void SGE_TextureAtlasRemove(SGE_TextureAtlas *atlas, SGE_Texture *texture);
+
+/*
+ * Packs all live images again into as few pages as possible and frees the pages left empty.
+ * The textures keep their handles, only their clipRect and SDL_Texture change.
+ */
+void SGE_TextureAtlasRepack(SGE_TextureAtlas *atlas);
+
+/* Prints the page count and how full every page is to the log */
+void SGE_PrintTextureAtlas(SGE_TextureAtlas *atlas);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef __SGE_TEXTURE_FILE_H__
+#define __SGE_TEXTURE_FILE_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Texture files
+ * A .sgetex file holds an image already decoded to the pixel format renderers take directly,
+ * so SGE_LoadTexture() maps the file into memory and uploads it's pixels as they are, without decoding or converting them.
+ * The pixels can be LZ4 compressed, trading a fast decompression for smaller files,
+ * and can have their colors premultiplied by alpha, which SGE_LoadTexture() draws with a premultiplied blend mode.
+ * Files are built ahead of time with SGE_ConvertTextureFile() or the tools/SGE_TextureConverter program.
+ *
+ * .sgetex layout, all values little endian:
+ *   "SGET", Uint16 version, Uint16 flags, Uint16 width, Uint16 height, Uint32 data size,
+ *   then the pixels row by row, 4 bytes each in B, G, R, A order (SDL_PIXELFORMAT_BGRA32),
+ *   or a single LZ4 block holding them when the LZ4 flag is set.
+ */
+
+#define SGE_TEXTURE_FILE_VERSION 1
+
+/* Colors are premultiplied by alpha */
+#define SGE_TEXTURE_FILE_PREMULTIPLIED 0x0001
+/* Pixels are a LZ4 block */
+#define SGE_TEXTURE_FILE_LZ4 0x0002
+
+typedef struct
+{
+	int w, h;
+	int flags;
+	/* w * h pixels in SDL_PIXELFORMAT_BGRA32, valid until the file is closed */
+	const void *pixels;
+
+	/* The mapped or read file and the decompressed pixels, if any */
+	void *data;
+	size_t dataSize;
+	bool isMapped;
+	void *decompressed;
+} SGE_TextureFile;
+
+/* Returns true if the path ends with the texture file extension */
+bool SGE_IsTextureFilePath(const char *path);
+
+/*
+ * Maps a .sgetex file into memory, decompressing it's pixels if needed.
+ * Safe to call from any thread, errors are reported through SDL_GetError() instead of the log.
+ */
+SGE_TextureFile *SGE_OpenTextureFile(const char *path);
+
+/* Unmaps a texture file */
+void SGE_CloseTextureFile(SGE_TextureFile *file);
+
+/* Writes a surface to a .sgetex file, "flags" is a combination of SGE_TEXTURE_FILE_PREMULTIPLIED and SGE_TEXTURE_FILE_LZ4 */
+bool SGE_SaveTextureFile(SDL_Surface *surface, const char *path, int flags);
+
+/* Loads an image with SDL_image and writes it to a .sgetex file */
+bool SGE_ConvertTextureFile(const char *imagePath, const char *outputPath, int flags);
+
+/*
+ * LZ4 block compression, used by texture files.
+ * SGE_LZ4Compress() needs SGE_LZ4CompressBound(srcSize) bytes of room and returns the compressed size.
+ * SGE_LZ4Decompress() returns false unless the block decompresses to exactly "dstSize" bytes.
+ */
+int SGE_LZ4CompressBound(int srcSize);
+int SGE_LZ4Compress(const Uint8 *src, int srcSize, Uint8 *dst);
+bool SGE_LZ4Decompress(const Uint8 *src, int srcSize, Uint8 *dst, int dstSize);
+
+#endif
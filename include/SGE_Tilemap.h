@@ -0,0 +1,102 @@
+#ifndef __SGE_TILEMAP_H__
+#define __SGE_TILEMAP_H__
+
+#include "SGE_Texture.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Tilemap
+ * A grid of tiles in one or more layers, drawn from a tileset texture holding the tiles in rows.
+ * The tileset can be a region of a texture atlas. Tile 0 is empty, tile n is the n-th tile of the tileset,
+ * counting from 1 at the top left, row by row.
+ *
+ * Every layer is split into chunks of SGE_TILEMAP_CHUNK_SIZE * SGE_TILEMAP_CHUNK_SIZE tiles, which are baked
+ * into a render target the first time they are visible and drawn as a single texture after that.
+ * Chunks are made smaller on renderers whose largest texture can't hold that many of the map's tiles.
+ * A chunk is baked again only after one of it's tiles changed, chunks out of view are not drawn or baked at all.
+ * Empty chunks never get a texture.
+ *
+ * The map is placed in the world while a camera is set, and on the screen otherwise.
+ *
+ * .sgemap layout, all values little endian:
+ *   "SGEM", Uint16 version, Uint16 width, height, tile width, tile height, layer count,
+ *   then the tiles of every layer, row by row, as Uint16.
+ */
+
+#define SGE_TILEMAP_VERSION 1
+#define SGE_TILEMAP_CHUNK_SIZE 32
+
+typedef struct
+{
+	/* Baked tiles, NULL until the chunk is first drawn */
+	SGE_Texture *texture;
+	/* Number of non empty tiles in the chunk */
+	int tileCount;
+	/* Set when the tiles changed since the chunk was baked */
+	bool isDirty;
+} SGE_TilemapChunk;
+
+typedef struct
+{
+	/* Tile ids, row by row */
+	Uint16 *tiles;
+	SGE_TilemapChunk *chunks;
+	bool isVisible;
+} SGE_TilemapLayer;
+
+typedef struct
+{
+	SGE_Texture *tileset;
+	int tileWidth, tileHeight;
+	/* Number of tiles in a row of the tileset and in the whole tileset */
+	int tilesetColumns;
+	int tilesetTileCount;
+
+	/* Size of the map in tiles */
+	int w, h;
+	/* Position of the map's top left corner */
+	int x, y;
+
+	SGE_TilemapLayer *layers;
+	int layerCount;
+	/* Number of tiles across and down a chunk, and number of chunks across and down every layer */
+	int chunkSize;
+	int chunksX, chunksY;
+
+	/* Chunks drawn and baked by the last SGE_TilemapRender() or SGE_TilemapRenderLayer() */
+	int lastDrawCalls;
+	int lastBakeCount;
+} SGE_Tilemap;
+
+/* Creates a map of w * h empty tiles in "layerCount" layers, the tileset is not freed with the map */
+SGE_Tilemap *SGE_CreateTilemap(SGE_Texture *tileset, int tileWidth, int tileHeight, int w, int h, int layerCount);
+
+/* Loads a .sgemap file, drawn with "tileset" */
+SGE_Tilemap *SGE_LoadTilemap(const char *path, SGE_Texture *tileset);
+
+/* Saves a map to a .sgemap file */
+bool SGE_SaveTilemap(SGE_Tilemap *map, const char *path);
+
+/* Frees a map and it's baked chunks */
+void SGE_FreeTilemap(SGE_Tilemap *map);
+
+/* Sets a tile, only the chunk holding it is baked again */
+void SGE_TilemapSetTile(SGE_Tilemap *map, int layer, int x, int y, Uint16 tile);
+
+/* Returns a tile, 0 for positions outside the map */
+Uint16 SGE_TilemapGetTile(SGE_Tilemap *map, int layer, int x, int y);
+
+/* Finds the tile under a world position, returns false if it is outside the map */
+bool SGE_TilemapGetTileAt(SGE_Tilemap *map, float worldX, float worldY, int *tileX, int *tileY);
+
+/* Bakes all chunks again before they are next drawn, needed after changing the tileset's pixels */
+void SGE_TilemapInvalidate(SGE_Tilemap *map);
+
+/* Draws the visible chunks of a single layer, to draw sprites between layers */
+void SGE_TilemapRenderLayer(SGE_Tilemap *map, int layer);
+
+/* Draws the visible chunks of all visible layers, from the first layer up */
+void SGE_TilemapRender(SGE_Tilemap *map);
+
+#endif
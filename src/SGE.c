@@ -3,6 +3,13 @@
 #include "SGE_Logger.h"
 #include "SGE_Texture.h"
 #include "SGE_GUI.h"
+#include "SGE_FramePacer.h"
+#include "SGE_Profiler.h"
+#include "SGE_Input.h"
+#include "SGE_PrimitiveBatch.h"
+#include "SGE_Camera.h"
+#include "SGE_RenderQueue.h"
+#include "SGE_AssetCache.h"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -35,6 +42,15 @@ static SGE_EngineData engine;
 /* Current state */
 static SGE_GameState currentState;
 
+/* Dirty rect mode data, the dirty area is the bounding box of the frame's dirty rects */
+static SGE_Texture *backbuffer = NULL;
+static SDL_Rect dirtyArea;
+static bool hasDirtyArea = false;
+static bool isScreenDirty = true;
+/* Camera values of the last drawn frame, the whole viewport is dirty when they change */
+static SGE_Camera *lastCamera = NULL;
+static SGE_Camera lastCameraValues;
+
 SGE_EngineData *SGE_GetEngineData()
 {
 	return &engine;
@@ -45,7 +61,11 @@ SGE_GameState *SGE_GetCurrentState()
 	return &currentState;
 }
 
-SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
+/*
+ * Initializes SDL and the engine, shared by SGE_Init() and SGE_InitHeadless().
+ * In headless mode no window is created and a software renderer draws into an offscreen surface.
+*/
+static SGE_EngineData *SGE_InitEngine(const char *title, int screenWidth, int screenHeight, bool headless)
 {
 	engine.window = NULL;
 	engine.renderer = NULL;
@@ -57,6 +77,7 @@ SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
 	engine.isFullscreen = false;
 	engine.isVsyncOn = false;
 	engine.keyboardState = NULL;
+	engine.frameEventCount = 0;
 	engine.mouse_x = 0;
 	engine.mouse_y = 0;
 	engine.defaultFont = NULL;
@@ -70,24 +91,69 @@ SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
 	engine.delta = 0;
 	engine.lastFrameTime = 0;
 	
+	engine.perfFrequency = 0;
+	engine.lastFrameCounter = 0;
+	engine.frameDelta = 0;
+	
+	engine.fixedUpdateRate = 0;
+	engine.fixedDelta = 0;
+	engine.updateAccumulator = 0;
+	engine.maxUpdatesPerFrame = 5;
+	engine.lastUpdateCount = 0;
+	engine.interpolationAlpha = 1.0;
+	
+	engine.isHeadless = headless;
+	engine.headlessSurface = NULL;
+	engine.frameCount = 0;
+	engine.frameLimit = 0;
+	engine.exitCode = 0;
+	
+	if(headless)
+	{
+		/* Use the dummy drivers unless others were explicitly requested through the environment */
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+	}
+	
 	SDL_Init(SDL_INIT_EVERYTHING);
 	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_WEBP);
 	TTF_Init();
 
-	engine.window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, engine.screenWidth, engine.screenHeight, SDL_WINDOW_SHOWN);
-	if(engine.window == NULL)
+	if(headless)
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Game Window! SDL_Error: %s", SDL_GetError());
-		engine.isRunning = SDL_FALSE;
-		return NULL;
+		engine.headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, engine.screenWidth, engine.screenHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+		if(engine.headlessSurface == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Headless Surface! SDL_Error: %s", SDL_GetError());
+			engine.isRunning = SDL_FALSE;
+			return NULL;
+		}
+		
+		engine.renderer = SDL_CreateSoftwareRenderer(engine.headlessSurface);
+		if(engine.renderer == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Headless Renderer! SDL_Error: %s", SDL_GetError());
+			engine.isRunning = SDL_FALSE;
+			return NULL;
+		}
 	}
-	
-	engine.renderer = SDL_CreateRenderer(engine.window, -1, SDL_RENDERER_ACCELERATED);
-	if(engine.renderer == NULL)
+	else
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Game Renderer! SDL_Error: %s", SDL_GetError());
-		engine.isRunning = SDL_FALSE;
-		return NULL;
+		engine.window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, engine.screenWidth, engine.screenHeight, SDL_WINDOW_SHOWN);
+		if(engine.window == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Game Window! SDL_Error: %s", SDL_GetError());
+			engine.isRunning = SDL_FALSE;
+			return NULL;
+		}
+		
+		engine.renderer = SDL_CreateRenderer(engine.window, -1, SDL_RENDERER_ACCELERATED);
+		if(engine.renderer == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create Game Renderer! SDL_Error: %s", SDL_GetError());
+			engine.isRunning = SDL_FALSE;
+			return NULL;
+		}
 	}
 	
 	engine.defaultFont = TTF_OpenFont("assets/FreeSans.ttf", 24);
@@ -104,8 +170,25 @@ SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
 	engine.defaultScreenClearColor.g = 200;
 	engine.defaultScreenClearColor.b = 255;
 	engine.defaultScreenClearColor.a = 255;
+	engine.drawColor = engine.defaultScreenClearColor;
+	engine.drawBlendMode = SDL_BLENDMODE_NONE;
+	engine.isClipEnabled = false;
+	engine.renderTarget = NULL;
+	engine.isPremultipliedDrawing = false;
+	engine.renderStateCallsAvoided = 0;
+	engine.lastRenderStateCallsAvoided = 0;
+	SGE_InvalidateRenderState();
+	
+	engine.isDirtyRectMode = false;
+	engine.lastDirtyArea.x = 0;
+	engine.lastDirtyArea.y = 0;
+	engine.lastDirtyArea.w = 0;
+	engine.lastDirtyArea.h = 0;
+	engine.isClipLimited = false;
+	engine.clipLimitTarget = NULL;
 
 	engine.keyboardState = SDL_GetKeyboardState(NULL);
+	engine.perfFrequency = SDL_GetPerformanceFrequency();
 
 	SDL_VERSION(&engine.SDL_Version_C);
 	SDL_GetVersion(&engine.SDL_Version_DLL);
@@ -122,6 +205,10 @@ SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
 	SGE_SetStateFunctions(&currentState, "SGE", NULL, NULL, NULL, NULL, NULL);
 	SGE_LogPrintLine(SGE_LOG_INFO, "Straw Hat Game Engine Version 1.0");
 	SGE_LogPrintLine(SGE_LOG_DEBUG, "Platform: %s", SDL_GetPlatform());
+	if(engine.isHeadless)
+	{
+		SGE_LogPrintLine(SGE_LOG_DEBUG, "Running headless, no window created.");
+	}
 	//SGE_LogPrintLine(SGE_LOG_DEBUG, "Video Driver: %s", SDL_GetCurrentVideoDriver());
 	//SGE_LogPrintLine(SGE_LOG_DEBUG, "Audio Driver: %s", SDL_GetCurrentAudioDriver());
 
@@ -163,8 +250,237 @@ SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
 	return &engine;
 }
 
-void SGE_Run(const char *startStateName)
+SGE_EngineData *SGE_Init(const char *title, int screenWidth, int screenHeight)
+{
+	return SGE_InitEngine(title, screenWidth, screenHeight, false);
+}
+
+/*
+ * Initializes the engine without a display, for automated runs and benchmarks.
+ * The whole state, GUI and render pipeline still runs, drawing into an offscreen surface.
+ * Use SGE_SetFrameLimit() to stop SGE_Run() after a number of frames.
+*/
+SGE_EngineData *SGE_InitHeadless(int screenWidth, int screenHeight)
+{
+	return SGE_InitEngine("SGE Headless", screenWidth, screenHeight, true);
+}
+
+/*
+ * Runs the current state's update() for this frame.
+ * In fixed timestep mode, the frame time is accumulated and update() is called
+ * once for every whole fixed step, so it may run zero or several times per frame.
+ * The leftover fraction of a step is stored as the interpolation alpha for render().
+*/
+static void SGE_UpdateState()
+{
+	if(engine.fixedUpdateRate == 0)
+	{
+		engine.delta = engine.frameDelta;
+		engine.lastUpdateCount = 1;
+		engine.interpolationAlpha = 1.0;
+		currentState.update();
+		return;
+	}
+	
+	engine.updateAccumulator += engine.frameDelta;
+	
+	/* Drop the time that can't be simulated within the update limit to avoid a spiral of death */
+	if(engine.updateAccumulator > engine.maxUpdatesPerFrame * engine.fixedDelta)
+	{
+		engine.updateAccumulator = engine.maxUpdatesPerFrame * engine.fixedDelta;
+	}
+	
+	engine.delta = engine.fixedDelta;
+	engine.lastUpdateCount = 0;
+	while(engine.updateAccumulator >= engine.fixedDelta)
+	{
+		currentState.update();
+		engine.updateAccumulator -= engine.fixedDelta;
+		
+		/* Edges and motion belong to the first step, later steps of the frame would count them again */
+		if(engine.lastUpdateCount == 0)
+		{
+			SGE_InputClearEdges();
+		}
+		engine.lastUpdateCount++;
+	}
+	
+	engine.interpolationAlpha = engine.updateAccumulator / engine.fixedDelta;
+}
+
+/*
+ * Drains the SDL event queue into the frame's event batch.
+ * Consecutive mouse motion events from the same mouse are merged into one,
+ * keeping the last position and summing up the relative motion.
+*/
+static void SGE_GatherEvents()
 {
+	SDL_Event peeked[64];
+	int peekedCount = 0;
+	int i = 0;
+	
+	engine.frameEventCount = 0;
+	SDL_PumpEvents();
+	while(engine.frameEventCount < SGE_MAX_FRAME_EVENTS)
+	{
+		/* Never take more events than there is space for, in case none of them get merged */
+		int space = SGE_MAX_FRAME_EVENTS - engine.frameEventCount;
+		if(space > 64)
+		{
+			space = 64;
+		}
+		
+		peekedCount = SDL_PeepEvents(peeked, space, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+		if(peekedCount <= 0)
+		{
+			break;
+		}
+		
+		for(i = 0; i < peekedCount; i++)
+		{
+			if(peeked[i].type == SDL_QUIT)
+			{
+				engine.isRunning = false;
+			}
+			else if(peeked[i].type == SDL_RENDER_DEVICE_RESET)
+			{
+				/* The driver lost all textures, the registry uploads them again when next rendered */
+				SGE_LogPrintLine(SGE_LOG_WARNING, "Render device was reset, restoring textures!");
+				SGE_InvalidateTextures(false);
+				SGE_InvalidateRenderState();
+			}
+			else if(peeked[i].type == SDL_RENDER_TARGETS_RESET)
+			{
+				/* Only the contents of render targets were lost, their owners draw them again */
+				SGE_InvalidateTargetTextures();
+				SGE_InvalidateRenderState();
+			}
+			
+			if(peeked[i].type == SDL_MOUSEMOTION && engine.frameEventCount > 0)
+			{
+				SDL_Event *last = &engine.frameEvents[engine.frameEventCount - 1];
+				if(last->type == SDL_MOUSEMOTION && last->motion.which == peeked[i].motion.which && last->motion.windowID == peeked[i].motion.windowID)
+				{
+					last->motion.timestamp = peeked[i].motion.timestamp;
+					last->motion.state = peeked[i].motion.state;
+					last->motion.x = peeked[i].motion.x;
+					last->motion.y = peeked[i].motion.y;
+					last->motion.xrel += peeked[i].motion.xrel;
+					last->motion.yrel += peeked[i].motion.yrel;
+					continue;
+				}
+			}
+			
+			engine.frameEvents[engine.frameEventCount] = peeked[i];
+			engine.frameEventCount++;
+		}
+	}
+}
+
+/* Draws the GUI from the frame render queue, on it's layer */
+static void SGE_RenderQueuedGUI(void *data)
+{
+	SGE_GUI_Render();
+}
+
+/* Adds the camera's viewport as dirty when the camera or what it shows changed since the last drawn frame */
+static void SGE_AddCameraDirtyRects(SGE_Camera *camera)
+{
+	if(camera == lastCamera)
+	{
+		if(camera == NULL)
+		{
+			return;
+		}
+		if(camera->x == lastCameraValues.x && camera->y == lastCameraValues.y && camera->zoom == lastCameraValues.zoom && camera->rotation == lastCameraValues.rotation && SDL_RectEquals(&camera->viewport, &lastCameraValues.viewport))
+		{
+			return;
+		}
+	}
+	
+	/* A camera was set or unset, the state may have drawn anywhere without one */
+	if(camera == NULL || lastCamera == NULL)
+	{
+		SGE_InvalidateScreen();
+	}
+	else
+	{
+		SGE_AddDirtyRect(&lastCameraValues.viewport);
+		SGE_AddDirtyRect(&camera->viewport);
+	}
+	
+	lastCamera = camera;
+	if(camera != NULL)
+	{
+		lastCameraValues = *camera;
+	}
+}
+
+/*
+ * Starts a frame in dirty rect mode.
+ * Returns false if nothing changed, the backbuffer is then presented as it is.
+ * Otherwise drawing goes into the backbuffer, kept inside the dirty area, until SGE_EndDirtyFrame().
+*/
+static bool SGE_BeginDirtyFrame(SGE_Camera *camera)
+{
+	if(backbuffer->isStale)
+	{
+		if(!SGE_RestoreTexture(backbuffer))
+		{
+			SGE_LogPrintLine(SGE_LOG_WARNING, "Lost the dirty rect backbuffer, drawing full frames!");
+			SGE_SetDirtyRectMode(false);
+			return true;
+		}
+		SGE_InvalidateScreen();
+	}
+	
+	SGE_GUI_AddDirtyRects();
+	SGE_AddCameraDirtyRects(camera);
+	
+	SDL_Rect screen = {0, 0, engine.screenWidth, engine.screenHeight};
+	SDL_Rect area = screen;
+	bool isFrameDirty = isScreenDirty || (hasDirtyArea && SDL_IntersectRect(&dirtyArea, &screen, &area));
+	isScreenDirty = false;
+	hasDirtyArea = false;
+	if(!isFrameDirty)
+	{
+		engine.lastDirtyArea.w = 0;
+		engine.lastDirtyArea.h = 0;
+		return false;
+	}
+	
+	engine.lastDirtyArea = area;
+	SGE_SetRenderTarget(backbuffer->texture);
+	engine.isClipLimited = true;
+	engine.clipLimit = area;
+	engine.clipLimitTarget = backbuffer->texture;
+	engine.isClipRectKnown = false;
+	SGE_SetClipRect(NULL);
+	return true;
+}
+
+/* Puts the backbuffer on the screen, the screen's contents are undefined after presenting so all of it is copied */
+static void SGE_EndDirtyFrame()
+{
+	SDL_Rect screen = {0, 0, engine.screenWidth, engine.screenHeight};
+	
+	SGE_PrimitiveBatchFlush();
+	engine.isClipLimited = false;
+	SGE_SetRenderTarget(NULL);
+	SGE_SetClipRect(NULL);
+	SDL_RenderCopy(engine.renderer, backbuffer->texture, NULL, &screen);
+}
+
+/*
+ * Runs the main loop starting with the state "startStateName" until SGE_Quit() is called
+ * or the frame limit is reached, returning the exit code set with SGE_QuitWithCode().
+*/
+int SGE_Run(const char *startStateName)
+{
+	int i = 0;
+	SGE_Camera *camera = NULL;
+	SGE_RenderQueue *frameQueue = SGE_GetFrameRenderQueue();
+	bool isFrameDrawn = true;
 	SGE_GameState *startState = SGE_GetState(startStateName);
 	if(startState != NULL)
 	{
@@ -180,46 +496,149 @@ void SGE_Run(const char *startStateName)
 	
 	SGE_GUI_UpdateCurrentState(currentState.name);
 	SGE_InitState(&currentState);
+	
+	engine.lastFrameCounter = SDL_GetPerformanceCounter();
+	engine.lastFrameTime = SDL_GetTicks();
+	SGE_FramePacerReset();
 
 	while(engine.isRunning)
 	{
 		/* Calculate Delta time */
+		Uint64 frameCounter = SDL_GetPerformanceCounter();
+		engine.frameDelta = (double)(frameCounter - engine.lastFrameCounter) / engine.perfFrequency;
+		engine.lastFrameCounter = frameCounter;
 		engine.frameStartTime = SDL_GetTicks();
-		engine.delta = (engine.frameStartTime - engine.lastFrameTime) / 1000.0;
 		engine.lastFrameTime = engine.frameStartTime;
 		
 		/* Event Handling */
+		SGE_ProfilerBegin(SGE_PROFILER_EVENTS);
+		SGE_GatherEvents();
 		SDL_GetMouseState(&engine.mouse_x, &engine.mouse_y);
-		while(SDL_PollEvent(&engine.event) != 0)
+		SGE_InputUpdate();
+		SGE_ProfilerEnd(SGE_PROFILER_EVENTS);
+		
+		SGE_ProfilerBegin(SGE_PROFILER_GUI_EVENTS);
+		SGE_GUI_HandleEvents();
+		SGE_ProfilerEnd(SGE_PROFILER_GUI_EVENTS);
+		
+		/* States still receive their events one at a time through engine->event, if they have a handler */
+		if(SGE_StateHandlesEvents(&currentState))
 		{
-			if(engine.event.type == SDL_QUIT)
+			SGE_ProfilerBegin(SGE_PROFILER_EVENTS);
+			for(i = 0; i < engine.frameEventCount; i++)
 			{
-				engine.isRunning = false;
+				engine.event = engine.frameEvents[i];
+				currentState.handleEvents();
 			}
-			SGE_GUI_HandleEvents();
-			currentState.handleEvents();
+			SGE_ProfilerEnd(SGE_PROFILER_EVENTS);
 		}
 		
+		/* Images loaded in the background are uploaded before the state sees them */
+		SGE_ProfilerBegin(SGE_PROFILER_UPLOAD);
+		SGE_UpdateTextureLoading();
+		SGE_ProfilerEnd(SGE_PROFILER_UPLOAD);
+		
 		/* Logic Updates */
+		SGE_ProfilerBegin(SGE_PROFILER_GUI_UPDATE);
 		SGE_GUI_Update();
-		currentState.update();
+		SGE_ProfilerEnd(SGE_PROFILER_GUI_UPDATE);
+		
+		SGE_ProfilerBegin(SGE_PROFILER_STATE_UPDATE);
+		SGE_UpdateState();
+		SGE_ProfilerEnd(SGE_PROFILER_STATE_UPDATE);
 		
 		/* Rendering */
-		SGE_ClearScreen(engine.defaultScreenClearColor);
-		currentState.render();
-		SGE_GUI_Render();
+		SGE_ProfilerBegin(SGE_PROFILER_STATE_RENDER);
+		camera = SGE_GetCamera();
+		if(camera != NULL)
+		{
+			SGE_UpdateCamera(camera);
+			camera->culledCount = 0;
+		}
+		
+		/* In dirty rect mode only the changed area is drawn, and nothing at all if nothing changed */
+		isFrameDrawn = true;
+		if(engine.isDirtyRectMode)
+		{
+			isFrameDrawn = SGE_BeginDirtyFrame(camera);
+		}
+		
+		if(isFrameDrawn)
+		{
+			SGE_ClearScreen(engine.defaultScreenClearColor);
+			if(camera != NULL)
+			{
+				/* The state draws in world space, only inside the camera's viewport */
+				SGE_SetClipRect(&camera->viewport);
+			}
+			currentState.render();
+			SGE_PrimitiveBatchFlush();
+		}
+		SGE_ProfilerEnd(SGE_PROFILER_STATE_RENDER);
+		
+		if(isFrameDrawn)
+		{
+			/* The GUI always draws in screen space */
+			camera = SGE_GetCamera();
+			if(camera != NULL)
+			{
+				SGE_SetCamera(NULL);
+				SGE_SetClipRect(NULL);
+			}
+			SGE_ProfilerBegin(SGE_PROFILER_GUI_RENDER);
+			if(frameQueue != NULL && frameQueue->count > 0)
+			{
+				/* Draws the state queued are sorted together with the GUI */
+				SGE_RenderQueueCallback(frameQueue, SGE_RENDER_LAYER_GUI, 0, SGE_RenderQueuedGUI, NULL);
+				SGE_RenderQueueExecute(frameQueue);
+			}
+			else
+			{
+				SGE_GUI_Render();
+			}
+			SGE_PrimitiveBatchFlush();
+			SGE_ProfilerEnd(SGE_PROFILER_GUI_RENDER);
+			if(camera != NULL)
+			{
+				SGE_SetCamera(camera);
+			}
+		}
+		else if(frameQueue != NULL)
+		{
+			SGE_RenderQueueClear(frameQueue);
+		}
+		
+		SGE_ProfilerBegin(SGE_PROFILER_PRESENT);
+		if(engine.isDirtyRectMode)
+		{
+			SGE_EndDirtyFrame();
+		}
 		SDL_RenderPresent(engine.renderer);
+		SGE_ProfilerEnd(SGE_PROFILER_PRESENT);
 
+		SGE_ProfilerBegin(SGE_PROFILER_STATE_SWITCH);
 		SGE_SwitchStates();
+		SGE_ProfilerEnd(SGE_PROFILER_STATE_SWITCH);
 		
+		engine.lastRenderTime = SDL_GetTicks() - engine.frameStartTime;
 		if(engine.frameRateCap)
-		{			
-			/* Cap the framerate by delaying the next frame */
-			engine.lastRenderTime = SDL_GetTicks() - engine.frameStartTime;
-			if(engine.lastRenderTime < engine.perFrameTime)
-			{
-				SDL_Delay(engine.perFrameTime - engine.lastRenderTime);
-			}
+		{
+			/* Cap the framerate by waiting for the next frame's deadline */
+			SGE_ProfilerBegin(SGE_PROFILER_FRAME_CAP);
+			SGE_FramePacerWait();
+			SGE_ProfilerEnd(SGE_PROFILER_FRAME_CAP);
+		}
+		
+		SGE_ProfilerEndFrame();
+		
+		engine.lastRenderStateCallsAvoided = engine.renderStateCallsAvoided;
+		engine.renderStateCallsAvoided = 0;
+		
+		engine.frameCount++;
+		if(engine.frameLimit != 0 && engine.frameCount >= engine.frameLimit)
+		{
+			SGE_LogPrintLine(SGE_LOG_INFO, "Frame limit of %u reached.", engine.frameLimit);
+			engine.isRunning = false;
 		}
 	}
 	
@@ -229,6 +648,11 @@ void SGE_Run(const char *startStateName)
 	SGE_FreeLoadedStates();
 	SGE_FreeStateList();
 	SGE_GUI_Quit();
+	SGE_PrimitiveBatchQuit();
+	SGE_RenderQueueQuit();
+	SGE_SetDirtyRectMode(false);
+	SGE_TextureLoadingQuit();
+	SGE_AssetCacheQuit();
 	
 	Mix_CloseAudio();
 	Mix_Quit();
@@ -236,13 +660,22 @@ void SGE_Run(const char *startStateName)
 	
 	SDL_DestroyRenderer(engine.renderer);
 	engine.renderer = NULL;
-	SDL_DestroyWindow(engine.window);
-	engine.window = NULL;
+	if(engine.window != NULL)
+	{
+		SDL_DestroyWindow(engine.window);
+		engine.window = NULL;
+	}
+	if(engine.headlessSurface != NULL)
+	{
+		SDL_FreeSurface(engine.headlessSurface);
+		engine.headlessSurface = NULL;
+	}
 	
 	TTF_Quit();
 	IMG_Quit();
 	SDL_Quit();
 	SGE_LogPrintLine(SGE_LOG_INFO, "Quit SGE.");
+	return engine.exitCode;
 }
 
 void SGE_Quit()
@@ -251,11 +684,34 @@ void SGE_Quit()
 	engine.isRunning = false;
 }
 
+/*
+ * Same as SGE_Quit(), but also sets the value returned by SGE_Run().
+*/
+void SGE_QuitWithCode(int exitCode)
+{
+	engine.exitCode = exitCode;
+	SGE_Quit();
+}
+
+/*
+ * Stops SGE_Run() after "frames" frames have been run, or never if "frames" is 0.
+*/
+void SGE_SetFrameLimit(unsigned int frames)
+{
+	engine.frameLimit = frames;
+}
+
 /*
  * Toggles the window to fullscreen or windowed modes.
 */
 void SGE_ToggleFullscreen()
 {
+	if(engine.window == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Can't toggle fullscreen, no window is open!");
+		return;
+	}
+	
 	if(!engine.isFullscreen)
 	{
 		if(SDL_SetWindowFullscreen(engine.window, SDL_WINDOW_FULLSCREEN) == 0)
@@ -283,10 +739,10 @@ void SGE_ToggleFullscreen()
 }
 
 /*
- * Toggles the vsync by destroying and recreating the current renderer and all it's created textures.
- * Will reset the current state and destroy all gui controls to initialize them again.
+ * Recreates the renderer with or without vsync, live textures are restored from the texture registry.
+ * Used when the SDL version can't change vsync on an existing renderer.
 */
-void SGE_ToggleVsync()
+static bool SGE_RecreateRenderer(bool vsync)
 {
 	/* Save the current renderer's draw blend mode and draw color */
 	SDL_BlendMode blendMode;
@@ -294,38 +750,84 @@ void SGE_ToggleVsync()
 	SDL_Color drawColor;
 	SDL_GetRenderDrawColor(engine.renderer, &drawColor.r, &drawColor.g, &drawColor.b, &drawColor.a);
 	
-	/* Quit the current state and the GUI to free all textures */
-	SGE_QuitState(&currentState);
-	SGE_GUI_Quit();
-	
 	SDL_DestroyRenderer(engine.renderer);
 	engine.renderer = NULL;
 	
-	/* Toggle the vsync variable */
-	engine.isVsyncOn = !engine.isVsyncOn;
-	
-	/* Recreate the renderer */
-	if(engine.isVsyncOn)
+	if(vsync)
 		engine.renderer = SDL_CreateRenderer(engine.window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 	else
 		engine.renderer = SDL_CreateRenderer(engine.window, -1, SDL_RENDERER_ACCELERATED);
 	
+	if(engine.renderer == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to recreate Game Renderer! SDL_Error: %s", SDL_GetError());
+		engine.isRunning = false;
+		return false;
+	}
+	
 	/* Set the new renderer's blend mode and color to the old one's */
 	SDL_SetRenderDrawBlendMode(engine.renderer, blendMode);
 	SDL_SetRenderDrawColor(engine.renderer, drawColor.r, drawColor.g, drawColor.b, drawColor.a);
+	/* The clip rect and render target are back to their defaults */
+	SGE_InvalidateRenderState();
+	engine.renderTarget = NULL;
 	
-	/* Reinitialize the GUI and the current state */
-	SGE_GUI_Init();
-	SGE_InitState(&currentState);
+	/* The textures were destroyed along with the old renderer, they get uploaded again when next rendered */
+	SGE_InvalidateTextures(true);
+	return true;
+}
+
+/*
+ * Turns vsync on or off without resetting the current state or the GUI.
+ * The renderer is changed in place where SDL supports it, otherwise it is recreated.
+*/
+void SGE_SetVsync(bool vsync)
+{
+	if(engine.window == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Can't toggle vsync, no window is open!");
+		return;
+	}
 	
+	if(vsync == engine.isVsyncOn)
+	{
+		return;
+	}
+	
+	bool changed = false;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if(SDL_RenderSetVSync(engine.renderer, vsync ? 1 : 0) == 0)
+	{
+		changed = true;
+	}
+	else
+	{
+		SGE_LogPrintLine(SGE_LOG_DEBUG, "Renderer can't change vsync in place, recreating it. SDL_Error: %s", SDL_GetError());
+	}
+#endif
+	if(!changed && !SGE_RecreateRenderer(vsync))
+	{
+		return;
+	}
+	
+	engine.isVsyncOn = vsync;
 	if(engine.isVsyncOn)
 	{
 		engine.frameRateCap = false;
+		SGE_FramePacerSetTargetFPS(0);
 		SGE_LogPrintLine(SGE_LOG_INFO, "Turned OFF frame rate cap!");
 	}
 	SGE_LogPrintLine(SGE_LOG_INFO, "Toggled VSYNC %s!\n", engine.isVsyncOn ? "ON" : "OFF");
 }
 
+/*
+ * Toggles the vsync, see SGE_SetVsync().
+*/
+void SGE_ToggleVsync()
+{
+	SGE_SetVsync(!engine.isVsyncOn);
+}
+
 /*
  * Sets the frame rate cap to "fps", or disables capping if "fps" is 0.
 */
@@ -340,6 +842,7 @@ void SGE_SetTargetFPS(int fps)
 	if(fps == 0)
 	{
 		engine.frameRateCap = false;
+		SGE_FramePacerSetTargetFPS(0);
 		SGE_LogPrintLine(SGE_LOG_INFO, "Turned OFF frame rate cap!");
 	}
 	else
@@ -347,68 +850,475 @@ void SGE_SetTargetFPS(int fps)
 		engine.frameRateCap = true;
 		engine.fps = fps;
 		engine.perFrameTime = 1000 / fps;
+		SGE_FramePacerSetTargetFPS(fps);
 		SGE_LogPrintLine(SGE_LOG_INFO, "Target FPS set to %d", engine.fps);
 	}
 }
 
+/*
+ * Runs the current state's update() at a fixed rate of "hz" times per second, independent of the frame rate.
+ * render() can use SGE_GetInterpolationAlpha() to blend between the last two update steps.
+ * Passing 0 switches back to a single variable timestep update per frame.
+*/
+void SGE_SetFixedUpdateRate(int hz)
+{
+	if(hz <= 0)
+	{
+		engine.fixedUpdateRate = 0;
+		engine.fixedDelta = 0;
+		engine.interpolationAlpha = 1.0;
+		SGE_LogPrintLine(SGE_LOG_INFO, "Turned OFF fixed update rate!");
+	}
+	else
+	{
+		engine.fixedUpdateRate = hz;
+		engine.fixedDelta = 1.0 / hz;
+		engine.updateAccumulator = 0;
+		SGE_LogPrintLine(SGE_LOG_INFO, "Fixed update rate set to %d Hz", engine.fixedUpdateRate);
+	}
+}
+
+/*
+ * Sets the maximum number of fixed updates run in a single frame.
+ * Time beyond this limit is dropped, slowing the simulation down instead of stalling the engine.
+*/
+void SGE_SetMaxUpdatesPerFrame(int maxUpdates)
+{
+	if(maxUpdates < 1)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Max updates per frame must be at least 1!");
+		return;
+	}
+	engine.maxUpdatesPerFrame = maxUpdates;
+}
+
+/*
+ * Returns how far the current frame is between the last and the next fixed update, between 0 and 1.
+ * Always returns 1 when the fixed update rate is off.
+*/
+double SGE_GetInterpolationAlpha()
+{
+	return engine.interpolationAlpha;
+}
+
 /* Rendering Functions */
 
 void SGE_SetBackgroundColor(SDL_Color color)
 {
 	engine.defaultScreenClearColor = color;
+	SGE_InvalidateScreen();
 }
 
 void SGE_ClearScreenRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
-	SDL_SetRenderDrawColor(engine.renderer, r, g, b, a);
+	SGE_PrimitiveBatchFlush();
+	SGE_SetDrawColorRGBA(r, g, b, a);
+	if(engine.isClipLimited && engine.renderTarget == engine.clipLimitTarget)
+	{
+		/* SDL_RenderClear() ignores the clip rect, so only the dirty area is filled */
+		SDL_BlendMode blendMode;
+		SDL_GetRenderDrawBlendMode(engine.renderer, &blendMode);
+		SDL_SetRenderDrawBlendMode(engine.renderer, SDL_BLENDMODE_NONE);
+		SDL_RenderFillRect(engine.renderer, &engine.clipLimit);
+		SDL_SetRenderDrawBlendMode(engine.renderer, blendMode);
+		return;
+	}
 	SDL_RenderClear(engine.renderer);
 }
 
 void SGE_ClearScreen(SDL_Color color)
 {
-	SDL_SetRenderDrawColor(engine.renderer, color.r, color.g, color.b, color.a);
-	SDL_RenderClear(engine.renderer);
+	SGE_ClearScreenRGBA(color.r, color.g, color.b, color.a);
 }
 
 void SGE_SetDrawColorRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
+	if(engine.isDrawColorKnown && engine.drawColor.r == r && engine.drawColor.g == g && engine.drawColor.b == b && engine.drawColor.a == a)
+	{
+		engine.renderStateCallsAvoided++;
+		return;
+	}
+	engine.drawColor.r = r;
+	engine.drawColor.g = g;
+	engine.drawColor.b = b;
+	engine.drawColor.a = a;
+	engine.isDrawColorKnown = true;
 	SDL_SetRenderDrawColor(engine.renderer, r, g, b, a);
 }
 
 void SGE_SetDrawColor(SDL_Color color)
 {
-	SDL_SetRenderDrawColor(engine.renderer, color.r, color.g, color.b, color.a);
+	SGE_SetDrawColorRGBA(color.r, color.g, color.b, color.a);
+}
+
+/* Finds the screen corners of a world rect, returns false if the rect is out of the camera's view */
+static bool SGE_GetCameraRectCorners(SGE_Camera *camera, const SDL_Rect *rect, SDL_FPoint corners[4])
+{
+	SDL_FRect worldRect = {rect->x, rect->y, rect->w, rect->h};
+	if(!SGE_CameraIsVisible(camera, &worldRect, 0))
+	{
+		camera->culledCount++;
+		return false;
+	}
+	SGE_CameraWorldToScreen(camera, rect->x, rect->y, &corners[0].x, &corners[0].y);
+	SGE_CameraWorldToScreen(camera, rect->x + rect->w, rect->y, &corners[1].x, &corners[1].y);
+	SGE_CameraWorldToScreen(camera, rect->x + rect->w, rect->y + rect->h, &corners[2].x, &corners[2].y);
+	SGE_CameraWorldToScreen(camera, rect->x, rect->y + rect->h, &corners[3].x, &corners[3].y);
+	return true;
 }
 
+/* Rounds the screen corners of an unrotated world rect back into a rect */
+static SDL_Rect SGE_GetCameraCornersRect(const SDL_FPoint corners[4])
+{
+	SDL_Rect screenRect;
+	screenRect.x = (int)SDL_floorf(corners[0].x + 0.5f);
+	screenRect.y = (int)SDL_floorf(corners[0].y + 0.5f);
+	screenRect.w = (int)SDL_floorf(corners[2].x + 0.5f) - screenRect.x;
+	screenRect.h = (int)SDL_floorf(corners[2].y + 0.5f) - screenRect.y;
+	return screenRect;
+}
+
+/*
+ * The draw functions queue into the primitive batch with the current draw color,
+ * they are drawn together when the batch is flushed.
+ * With a camera set they take world positions, rects turn into quads when the camera is rotated.
+ */
 void SGE_DrawRect(SDL_Rect *rect)
 {
-	SDL_RenderDrawRect(engine.renderer, rect);
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera == NULL)
+	{
+		SGE_PrimitiveBatchRect(rect, engine.drawColor);
+		return;
+	}
+	
+	SDL_FPoint corners[4];
+	if(!SGE_GetCameraRectCorners(camera, rect, corners))
+	{
+		return;
+	}
+	if(camera->rotation == 0)
+	{
+		SDL_Rect screenRect = SGE_GetCameraCornersRect(corners);
+		SGE_PrimitiveBatchRect(&screenRect, engine.drawColor);
+		return;
+	}
+	
+	/* Round the corners like unrotated rects, truncating shifts them towards 0 and makes the edges wobble while rotating */
+	SDL_Point points[4];
+	int i = 0;
+	for(i = 0; i < 4; i++)
+	{
+		points[i].x = (int)SDL_floorf(corners[i].x + 0.5f);
+		points[i].y = (int)SDL_floorf(corners[i].y + 0.5f);
+	}
+	for(i = 0; i < 4; i++)
+	{
+		SGE_PrimitiveBatchLine(points[i].x, points[i].y, points[(i + 1) % 4].x, points[(i + 1) % 4].y, engine.drawColor);
+	}
 }
 
 void SGE_DrawFillRect(SDL_Rect *rect)
 {
-	SDL_RenderFillRect(engine.renderer, rect);
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera == NULL)
+	{
+		SGE_PrimitiveBatchFillRect(rect, engine.drawColor);
+		return;
+	}
+	
+	SDL_FPoint corners[4];
+	if(!SGE_GetCameraRectCorners(camera, rect, corners))
+	{
+		return;
+	}
+	if(camera->rotation == 0)
+	{
+		SDL_Rect screenRect = SGE_GetCameraCornersRect(corners);
+		SGE_PrimitiveBatchFillRect(&screenRect, engine.drawColor);
+		return;
+	}
+	SGE_PrimitiveBatchFillQuad(corners, engine.drawColor);
 }
 
 void SGE_DrawLine(int x1, int y1, int x2, int y2)
 {
-	SDL_RenderDrawLine(engine.renderer, x1, y1, x2, y2);
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera == NULL)
+	{
+		SGE_PrimitiveBatchLine(x1, y1, x2, y2, engine.drawColor);
+		return;
+	}
+	
+	SDL_FRect bounds = {SDL_min(x1, x2), SDL_min(y1, y2), SDL_abs(x2 - x1) + 1, SDL_abs(y2 - y1) + 1};
+	if(!SGE_CameraIsVisible(camera, &bounds, 0))
+	{
+		camera->culledCount++;
+		return;
+	}
+	float screenX1, screenY1, screenX2, screenY2;
+	SGE_CameraWorldToScreen(camera, x1, y1, &screenX1, &screenY1);
+	SGE_CameraWorldToScreen(camera, x2, y2, &screenX2, &screenY2);
+	/* Rounded like rect corners, so lines along a rect's edges stay on them */
+	SGE_PrimitiveBatchLine((int)SDL_floorf(screenX1 + 0.5f), (int)SDL_floorf(screenY1 + 0.5f), (int)SDL_floorf(screenX2 + 0.5f), (int)SDL_floorf(screenY2 + 0.5f), engine.drawColor);
 }
 
 /*
- * Checks for collision between two rectangles.
+ * Sets the blend mode used for drawing rects and lines.
+ * Queued primitives are drawn with the blend mode set when they are flushed, so they are flushed first.
 */
-bool SGE_CheckRectsCollision(const SDL_Rect *r1, const SDL_Rect *r2)
+void SGE_SetDrawBlendMode(SDL_BlendMode blendMode)
+{
+	if(engine.isDrawBlendModeKnown && engine.drawBlendMode == blendMode)
+	{
+		engine.renderStateCallsAvoided++;
+		return;
+	}
+	SGE_PrimitiveBatchFlush();
+	engine.drawBlendMode = blendMode;
+	engine.isDrawBlendModeKnown = true;
+	SDL_SetRenderDrawBlendMode(engine.renderer, SGE_MapDrawBlendMode(blendMode));
+}
+
+/*
+ * Restricts rendering to a rect, NULL to render everywhere again.
+ * Queued primitives are flushed first so they are clipped by the rect that was set when they were drawn.
+*/
+void SGE_SetClipRect(const SDL_Rect *rect)
 {
-	/* Can be replaced with SDL_HasIntersection() */
-	if(((r1->x >= r2->x) && (r1->x <= (r2->x + r2->w))) || (((r1->x + r1->w) >= r2->x) && ((r1->x + r1->w) <= (r2->x + r2->w))))
+	/* In dirty rect mode nothing may be drawn outside the dirty area */
+	SDL_Rect limitedRect;
+	if(engine.isClipLimited && engine.renderTarget == engine.clipLimitTarget)
 	{
-		if(((r1->y >= r2->y) && (r1->y <= (r2->y + r2->h))) || (((r1->y + r1->h) >= r2->y) && ((r1->y + r1->h) <= (r2->y + r2->h))))
+		if(rect == NULL)
 		{
-			return true;
+			limitedRect = engine.clipLimit;
+		}
+		else if(!SDL_IntersectRect(rect, &engine.clipLimit, &limitedRect))
+		{
+			/* SDL turns clipping off for empty rects, so clip to a pixel off the target instead */
+			limitedRect.x = -1;
+			limitedRect.y = -1;
+			limitedRect.w = 1;
+			limitedRect.h = 1;
 		}
+		rect = &limitedRect;
 	}
-	return false;
+	
+	if(engine.isClipRectKnown)
+	{
+		if(rect == NULL && !engine.isClipEnabled)
+		{
+			engine.renderStateCallsAvoided++;
+			return;
+		}
+		if(rect != NULL && engine.isClipEnabled && SDL_RectEquals(rect, &engine.clipRect))
+		{
+			engine.renderStateCallsAvoided++;
+			return;
+		}
+	}
+	
+	SGE_PrimitiveBatchFlush();
+	if(rect != NULL)
+	{
+		engine.clipRect = *rect;
+		engine.isClipEnabled = true;
+	}
+	else
+	{
+		engine.isClipEnabled = false;
+	}
+	engine.isClipRectKnown = true;
+	SDL_RenderSetClipRect(engine.renderer, rect);
+}
+
+/*
+ * Sets the texture rendering goes to, NULL for the screen.
+ * SDL keeps a separate clip rect for the screen and for targets, so the shadowed clip rect is dropped.
+ * While a dirty rect frame is drawn the backbuffer stands in for the screen, and gets it's clip limit back.
+*/
+void SGE_SetRenderTarget(SDL_Texture *target)
+{
+	if(target == NULL && engine.isClipLimited)
+	{
+		target = engine.clipLimitTarget;
+	}
+	if(engine.renderTarget == target)
+	{
+		engine.renderStateCallsAvoided++;
+		return;
+	}
+	SGE_PrimitiveBatchFlush();
+	if(SDL_SetRenderTarget(engine.renderer, target) != 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to set render target! SDL_Error: %s", SDL_GetError());
+		return;
+	}
+	engine.renderTarget = target;
+	engine.isClipRectKnown = false;
+	if(engine.isClipLimited && target == engine.clipLimitTarget)
+	{
+		SGE_SetClipRect(NULL);
+	}
+}
+
+/* Custom blend modes used for premultiplied drawing, composed the first time they are needed */
+static SDL_BlendMode premultiplyBlendMode = SDL_BLENDMODE_INVALID;
+static SDL_BlendMode premultipliedBlendMode = SDL_BLENDMODE_INVALID;
+
+/*
+ * Turns premultiplied drawing on or off.
+ * While it is on, everything drawn with SDL_BLENDMODE_BLEND into a target cleared to transparent black
+ * writes premultiplied color, so the target can be drawn later with SGE_GetPremultipliedBlendMode()
+ * and look exactly like drawing it's contents straight to the screen, even where they are translucent.
+ * Returns false if the renderer has no custom blend modes, drawing is left as it was.
+*/
+bool SGE_SetPremultipliedDrawing(bool enabled)
+{
+	if(engine.isPremultipliedDrawing == enabled)
+	{
+		return true;
+	}
+	
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	SGE_PrimitiveBatchFlush();
+	if(enabled)
+	{
+		if(premultiplyBlendMode == SDL_BLENDMODE_INVALID)
+		{
+			premultiplyBlendMode = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_SRC_ALPHA, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+		}
+		
+		/* Renderers without custom blend modes, like the software renderer, refuse them */
+		if(SDL_SetRenderDrawBlendMode(engine.renderer, premultiplyBlendMode) != 0)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "Premultiplied drawing is not supported by the renderer! SDL_Error: %s", SDL_GetError());
+			engine.isDrawBlendModeKnown = false;
+			return false;
+		}
+	}
+	
+	engine.isPremultipliedDrawing = enabled;
+	if(engine.isDrawBlendModeKnown)
+	{
+		SDL_SetRenderDrawBlendMode(engine.renderer, SGE_MapDrawBlendMode(engine.drawBlendMode));
+	}
+	return true;
+#else
+	return !enabled;
+#endif
+}
+
+/* Returns the blend mode actually used for drawing with "blendMode", which differs while premultiplied drawing is on */
+SDL_BlendMode SGE_MapDrawBlendMode(SDL_BlendMode blendMode)
+{
+	if(engine.isPremultipliedDrawing && blendMode == SDL_BLENDMODE_BLEND)
+	{
+		return premultiplyBlendMode;
+	}
+	return blendMode;
+}
+
+/* Returns the blend mode for drawing a target filled with premultiplied drawing, SDL_BLENDMODE_INVALID if there is none */
+SDL_BlendMode SGE_GetPremultipliedBlendMode()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	if(premultipliedBlendMode == SDL_BLENDMODE_INVALID)
+	{
+		premultipliedBlendMode = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+	}
+#endif
+	return premultipliedBlendMode;
+}
+
+/*
+ * Forgets the shadowed renderer state, the next state calls are passed on to SDL.
+ * Needed after changing the renderer's state with SDL directly.
+*/
+void SGE_InvalidateRenderState()
+{
+	engine.isDrawColorKnown = false;
+	engine.isDrawBlendModeKnown = false;
+	engine.isClipRectKnown = false;
+}
+
+/* Returns the number of renderer state calls that were skipped in the last frame */
+int SGE_GetRenderStateCallsAvoided()
+{
+	return engine.lastRenderStateCallsAvoided;
+}
+
+/*
+ * Turns dirty rect mode on or off, returns false if the renderer can't draw into a backbuffer.
+ * The whole screen is drawn again on the first frame after turning it on.
+*/
+bool SGE_SetDirtyRectMode(bool enabled)
+{
+	if(enabled == engine.isDirtyRectMode)
+	{
+		return true;
+	}
+	
+	if(enabled)
+	{
+		if(!SDL_RenderTargetSupported(engine.renderer))
+		{
+			SGE_LogPrintLine(SGE_LOG_WARNING, "Dirty rect mode needs render target support!");
+			return false;
+		}
+		
+		backbuffer = SGE_CreateTargetTexture(engine.screenWidth, engine.screenHeight);
+		if(backbuffer == NULL)
+		{
+			return false;
+		}
+		SGE_SetTextureBlendMode(backbuffer, SDL_BLENDMODE_NONE);
+	}
+	else
+	{
+		SGE_FreeTexture(backbuffer);
+		backbuffer = NULL;
+	}
+	
+	engine.isDirtyRectMode = enabled;
+	SGE_InvalidateScreen();
+	return true;
+}
+
+/* Marks an area of the screen to be drawn again in the next frame, does nothing outside dirty rect mode */
+void SGE_AddDirtyRect(const SDL_Rect *rect)
+{
+	if(!engine.isDirtyRectMode || isScreenDirty || rect->w <= 0 || rect->h <= 0)
+	{
+		return;
+	}
+	
+	if(hasDirtyArea)
+	{
+		SDL_UnionRect(&dirtyArea, rect, &dirtyArea);
+	}
+	else
+	{
+		dirtyArea = *rect;
+		hasDirtyArea = true;
+	}
+}
+
+/* Marks the whole screen to be drawn again in the next frame */
+void SGE_InvalidateScreen()
+{
+	isScreenDirty = true;
+	hasDirtyArea = false;
+}
+
+/*
+ * Checks for collision between two rectangles, rectangles touching at their edges collide.
+ * Also catches one rectangle being larger than the other on both sides.
+*/
+bool SGE_CheckRectsCollision(const SDL_Rect *r1, const SDL_Rect *r2)
+{
+	return r1->x <= r2->x + r2->w && r2->x <= r1->x + r1->w && r1->y <= r2->y + r2->h && r2->y <= r1->y + r1->h;
 }
 
 /*
@@ -1,10 +1,19 @@
 #include "SGE_AnimatedSprite.h"
 #include "SGE.h"
 #include "SGE_Logger.h"
+#include "SGE_AssetCache.h"
 #include <SDL2/SDL_image.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* Returns true if the path ends with the sprite sheet extension */
+static bool SGE_IsSpriteSheetPath(const char *path)
+{
+	const char *extension = strrchr(path, '.');
+	return extension != NULL && strcmp(extension, ".sgesheet") == 0;
+}
 
 SGE_AnimatedSprite *SGE_CreateAnimatedSprite(const char *path, int nFrames, int fps)
 {
@@ -14,17 +23,57 @@ SGE_AnimatedSprite *SGE_CreateAnimatedSprite(const char *path, int nFrames, int
 	sprite->fps = fps;
 	sprite->increment = 1;
 	sprite->lastDrawTime = 0;
+	sprite->paused = false;
+	sprite->sheet = NULL;
+	sprite->useFrameDurations = false;
 	
-	sprite->texture = SGE_LoadTexture(path);
-	if(sprite->texture == NULL)
+	if(SGE_IsSpriteSheetPath(path))
+	{
+		sprite->sheet = SGE_AcquireSpriteSheet(path);
+		if(sprite->sheet == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load sprite sheet for AnimatedSprite!");
+			free(sprite);
+			return NULL;
+		}
+		if(nFrames <= 0 || nFrames > sprite->sheet->frameCount)
+		{
+			sprite->frameCount = sprite->sheet->frameCount;
+		}
+		if(fps <= 0)
+		{
+			sprite->useFrameDurations = true;
+			sprite->fps = 1;
+		}
+	}
+	
+	/* Sprites of the same image share the cached texture, each drawing it through a region of it's own */
+	SGE_Texture *image = SGE_AcquireTexture((sprite->sheet != NULL) ? sprite->sheet->imagePath : path);
+	if(image == NULL)
 	{
 		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load texture for AnimatedSprite!");
+		if(sprite->sheet != NULL)
+		{
+			SGE_ReleaseAsset(sprite->sheet);
+		}
 		free(sprite);
 		return NULL;
 	}
 	
-	sprite->texture->clipRect.w = sprite->texture->original_w / sprite->frameCount;
-	sprite->texture->w = sprite->texture->clipRect.w;
+	SDL_Rect imageRect = {0, 0, image->original_w, image->original_h};
+	sprite->texture = SGE_CreateTextureRegion(image, &imageRect);
+	
+	if(sprite->sheet != NULL)
+	{
+		/* The sprite is as large as the untrimmed frames */
+		sprite->texture->w = sprite->sheet->frames[0].sourceW;
+		sprite->texture->h = sprite->sheet->frames[0].sourceH;
+	}
+	else
+	{
+		sprite->texture->clipRect.w = sprite->texture->original_w / sprite->frameCount;
+		sprite->texture->w = sprite->texture->clipRect.w;
+	}
 	
 	sprite->x = sprite->texture->x;
 	sprite->y = sprite->texture->y;
@@ -40,7 +89,13 @@ void SGE_FreeAnimatedSprite(SGE_AnimatedSprite *sprite)
 {
 	if(sprite != NULL)
 	{
+		SGE_Texture *image = sprite->texture->parent;
 		SGE_FreeTexture(sprite->texture);
+		SGE_ReleaseAsset(image);
+		if(sprite->sheet != NULL)
+		{
+			SGE_ReleaseAsset(sprite->sheet);
+		}
 		free(sprite);
 	}
 	else
@@ -49,35 +104,81 @@ void SGE_FreeAnimatedSprite(SGE_AnimatedSprite *sprite)
 	}
 }
 
-void SGE_RenderAnimatedSprite(SGE_AnimatedSprite *sprite)
+/* Places the current sheet frame inside the sprite's rect, scaling the trim offsets with the sprite */
+static void SGE_UpdateAnimatedSpriteSheetFrame(SGE_AnimatedSprite *sprite)
+{
+	int index = (sprite->currentFrame >= 0 && sprite->currentFrame < sprite->frameCount) ? sprite->currentFrame : 0;
+	const SGE_SpriteSheetFrame *frame = &sprite->sheet->frames[index];
+	float scaleX = (float)sprite->w / frame->sourceW;
+	float scaleY = (float)sprite->h / frame->sourceH;
+	
+	/* Flipping mirrors where the trimmed frame sits in the untrimmed one */
+	int offsetX = frame->offsetX;
+	int offsetY = frame->offsetY;
+	if(sprite->flip & SDL_FLIP_HORIZONTAL)
+	{
+		offsetX = frame->sourceW - frame->offsetX - frame->rect.w;
+	}
+	if(sprite->flip & SDL_FLIP_VERTICAL)
+	{
+		offsetY = frame->sourceH - frame->offsetY - frame->rect.h;
+	}
+	
+	sprite->texture->clipRect = frame->rect;
+	sprite->texture->x = sprite->x + (int)(offsetX * scaleX);
+	sprite->texture->y = sprite->y + (int)(offsetY * scaleY);
+	sprite->texture->w = (int)(frame->rect.w * scaleX);
+	sprite->texture->h = (int)(frame->rect.h * scaleY);
+}
+
+void SGE_UpdateAnimatedSpriteFrame(SGE_AnimatedSprite *sprite)
 {
 	if(!sprite->paused)
 	{
-		if(SDL_GetTicks() > sprite->lastDrawTime + 1000/sprite->fps)
+		unsigned int frameTime = 1000/sprite->fps;
+		if(sprite->useFrameDurations && sprite->currentFrame >= 0 && sprite->currentFrame < sprite->frameCount && sprite->sheet->frames[sprite->currentFrame].duration > 0)
+		{
+			frameTime = sprite->sheet->frames[sprite->currentFrame].duration;
+		}
+		
+		if(SDL_GetTicks() > sprite->lastDrawTime + frameTime)
 		{
 			sprite->currentFrame += sprite->increment;
 			sprite->lastDrawTime = SDL_GetTicks();
 		}
 	
-		sprite->texture->clipRect.x = sprite->currentFrame * sprite->texture->clipRect.w;
 		if(sprite->currentFrame < 0)
 		{
-			sprite->texture->clipRect.x = sprite->texture->original_w - sprite->texture->clipRect.w;
 			sprite->currentFrame = sprite->frameCount - 1;
 		}
 		if(sprite->currentFrame > sprite->frameCount - 1)
 		{
-			sprite->texture->clipRect.x = 0;
 			sprite->currentFrame = 0;
 		}
+		if(sprite->sheet == NULL)
+		{
+			sprite->texture->clipRect.x = sprite->currentFrame * sprite->texture->clipRect.w;
+		}
 	}
 	
-	sprite->texture->x = sprite->x;
-	sprite->texture->y = sprite->y;
-	sprite->texture->w = sprite->w;
-	sprite->texture->h = sprite->h;
+	if(sprite->sheet != NULL)
+	{
+		SGE_UpdateAnimatedSpriteSheetFrame(sprite);
+	}
+	else
+	{
+		sprite->texture->x = sprite->x;
+		sprite->texture->y = sprite->y;
+		sprite->texture->w = sprite->w;
+		sprite->texture->h = sprite->h;
+	}
 	sprite->texture->rotation = sprite->rotation;
 	sprite->texture->flip = sprite->flip;
+}
+
+void SGE_RenderAnimatedSprite(SGE_AnimatedSprite *sprite)
+{
+	SGE_UpdateAnimatedSpriteFrame(sprite);
 	SGE_RenderTexture(sprite->texture);
 }
 
@@ -89,6 +190,7 @@ void SGE_RestartAnimatedSprite(SGE_AnimatedSprite *sprite, int frame)
 
 void SGE_SetAnimatedSpriteFPS(SGE_AnimatedSprite *sprite, int fps)
 {
+	sprite->useFrameDurations = false;
 	if(fps == 0)
 	{
 		sprite->paused = true;
@@ -112,30 +214,12 @@ void SGE_SetAnimatedSpriteFPS(SGE_AnimatedSprite *sprite, int fps)
 /*
  * Give this function the no of frames and the path to the folder containing seperate images
  * with names starting from 1.png, 2.png, ... [nFrames].png
- * It will save atlas.png in the same folder.
+ * It will save atlas.png and atlas.sgesheet in the same folder, load the sprite from atlas.sgesheet.
 */
 void SGE_CreateSpriteSheet(const char *folderPath, int nFrames)
 {
-	char path[100];
-	sprintf(path, folderPath);
-	strcat(path, "/1.png");
-	
-	SDL_Surface *frame = IMG_Load(path);
-	SDL_Surface *atlasSurface = SDL_CreateRGBSurface(0, nFrames * frame->w, frame->h, 32, 0, 0, 0, 0);
-	SDL_Rect dest = {0, 0, frame->w, frame->h};
-	
-	int i = 0;
-	for(i = 0; i < nFrames; i++)
-	{
-		sprintf(path, "%s/%d.png", folderPath, i + 1);
-		frame = IMG_Load(path);
-		dest.x = i * 51;
-		SDL_BlitSurface(frame, NULL, atlasSurface, &dest);
-		SDL_FreeSurface(frame);
-	}
-	
-	sprintf(path, folderPath);
-	strcat(path, "/atlas.png");
-	IMG_SavePNG(atlasSurface, path);
-	SDL_FreeSurface(atlasSurface);
+	char *outputPath = (char*)malloc(strlen(folderPath) + 8);
+	sprintf(outputPath, "%s/atlas", folderPath);
+	SGE_BuildSpriteSheet(folderPath, nFrames, outputPath, 0, 0);
+	free(outputPath);
 }
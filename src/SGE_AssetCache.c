@@ -0,0 +1,499 @@
+#include "SGE_AssetCache.h"
+#include "SGE_Logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SGE_ASSET_CACHE_MIN_BUCKETS 64
+
+typedef struct SGE_CachedAsset
+{
+	SGE_AssetType type;
+	/* Normalized path and font size, the key the asset is found by */
+	char *path;
+	int size;
+	Uint32 hash;
+
+	void *asset;
+	int refCount;
+	bool isRetained;
+
+	/* Next asset in the same bucket of the path and the pointer table */
+	struct SGE_CachedAsset *nextByPath;
+	struct SGE_CachedAsset *nextByAsset;
+} SGE_CachedAsset;
+
+/* Both tables hold the same assets and always have the same number of buckets, a power of 2 */
+static SGE_CachedAsset **pathBuckets = NULL;
+static SGE_CachedAsset **assetBuckets = NULL;
+static int bucketCount = 0;
+static int assetCount = 0;
+
+static bool retainAcrossStates = true;
+static bool isSwitchingStates = false;
+
+static const char *assetTypeNames[] = {"texture", "font", "sfx", "music", "sprite sheet"};
+
+/* FNV-1a hash of the asset's key */
+static Uint32 SGE_HashAssetKey(SGE_AssetType type, const char *path, int size)
+{
+	Uint32 hash = 2166136261u;
+	const unsigned char *c = (const unsigned char *)path;
+
+	hash = (hash ^ (Uint32)type) * 16777619u;
+	hash = (hash ^ (Uint32)size) * 16777619u;
+	while(*c != '\0')
+	{
+		hash = (hash ^ *c) * 16777619u;
+		c++;
+	}
+	return hash;
+}
+
+static Uint32 SGE_HashAssetPointer(const void *asset)
+{
+	uintptr_t value = (uintptr_t)asset;
+	value ^= value >> 16;
+	value *= 0x45d9f3bu;
+	value ^= value >> 16;
+	return (Uint32)value;
+}
+
+/*
+ * Writes a path with '\' turned into '/' and without empty, "." and "dir/.." parts.
+ * Leading ".." parts of relative paths are kept. "out" has to be at least as long as "path".
+ */
+static void SGE_NormalizeAssetPath(const char *path, char *out)
+{
+	const char *c = path;
+	int length = 0;
+	int rootLength = 0;
+
+	if(*c == '/' || *c == '\\')
+	{
+		out[length++] = '/';
+		rootLength = 1;
+	}
+
+	while(*c != '\0')
+	{
+		const char *start = NULL;
+		int partLength = 0;
+
+		while(*c == '/' || *c == '\\')
+		{
+			c++;
+		}
+		start = c;
+		while(*c != '\0' && *c != '/' && *c != '\\')
+		{
+			c++;
+		}
+		partLength = c - start;
+
+		if(partLength == 0 || (partLength == 1 && start[0] == '.'))
+		{
+			continue;
+		}
+
+		if(partLength == 2 && start[0] == '.' && start[1] == '.')
+		{
+			/* Step out of the last part, unless there is none or it is a ".." itself */
+			int lastStart = length;
+			while(lastStart > rootLength && out[lastStart - 1] != '/')
+			{
+				lastStart--;
+			}
+			if(length > rootLength && !(length - lastStart == 2 && out[lastStart] == '.' && out[lastStart + 1] == '.'))
+			{
+				length = (lastStart > rootLength) ? lastStart - 1 : rootLength;
+				continue;
+			}
+			if(rootLength > 0)
+			{
+				/* Nothing above the root */
+				continue;
+			}
+		}
+
+		if(length > rootLength)
+		{
+			out[length++] = '/';
+		}
+		memcpy(out + length, start, partLength);
+		length += partLength;
+	}
+
+	if(length == 0)
+	{
+		out[length++] = '.';
+	}
+	out[length] = '\0';
+}
+
+static void SGE_ResizeAssetTables(int newBucketCount)
+{
+	SGE_CachedAsset **newPathBuckets = (SGE_CachedAsset **)calloc(newBucketCount, sizeof(SGE_CachedAsset *));
+	SGE_CachedAsset **newAssetBuckets = (SGE_CachedAsset **)calloc(newBucketCount, sizeof(SGE_CachedAsset *));
+	int i = 0;
+
+	for(i = 0; i < bucketCount; i++)
+	{
+		SGE_CachedAsset *entry = pathBuckets[i];
+		while(entry != NULL)
+		{
+			SGE_CachedAsset *next = entry->nextByPath;
+			Uint32 index = entry->hash & (newBucketCount - 1);
+			entry->nextByPath = newPathBuckets[index];
+			newPathBuckets[index] = entry;
+
+			index = SGE_HashAssetPointer(entry->asset) & (newBucketCount - 1);
+			entry->nextByAsset = newAssetBuckets[index];
+			newAssetBuckets[index] = entry;
+			entry = next;
+		}
+	}
+
+	free(pathBuckets);
+	free(assetBuckets);
+	pathBuckets = newPathBuckets;
+	assetBuckets = newAssetBuckets;
+	bucketCount = newBucketCount;
+}
+
+static SGE_CachedAsset *SGE_FindAssetByPath(SGE_AssetType type, const char *path, int size, Uint32 hash)
+{
+	SGE_CachedAsset *entry = NULL;
+
+	if(bucketCount == 0)
+	{
+		return NULL;
+	}
+
+	entry = pathBuckets[hash & (bucketCount - 1)];
+	while(entry != NULL)
+	{
+		if(entry->hash == hash && entry->type == type && entry->size == size && strcmp(entry->path, path) == 0)
+		{
+			return entry;
+		}
+		entry = entry->nextByPath;
+	}
+	return NULL;
+}
+
+static SGE_CachedAsset *SGE_FindAsset(const void *asset)
+{
+	SGE_CachedAsset *entry = NULL;
+
+	if(bucketCount == 0 || asset == NULL)
+	{
+		return NULL;
+	}
+
+	entry = assetBuckets[SGE_HashAssetPointer(asset) & (bucketCount - 1)];
+	while(entry != NULL && entry->asset != asset)
+	{
+		entry = entry->nextByAsset;
+	}
+	return entry;
+}
+
+static void SGE_FreeCachedAsset(SGE_CachedAsset *entry)
+{
+	SGE_CachedAsset **link = &pathBuckets[entry->hash & (bucketCount - 1)];
+	while(*link != entry)
+	{
+		link = &(*link)->nextByPath;
+	}
+	*link = entry->nextByPath;
+
+	link = &assetBuckets[SGE_HashAssetPointer(entry->asset) & (bucketCount - 1)];
+	while(*link != entry)
+	{
+		link = &(*link)->nextByAsset;
+	}
+	*link = entry->nextByAsset;
+	assetCount--;
+
+	switch(entry->type)
+	{
+		case SGE_ASSET_TEXTURE:
+			SGE_FreeTexture((SGE_Texture *)entry->asset);
+			break;
+		case SGE_ASSET_FONT:
+			TTF_CloseFont((TTF_Font *)entry->asset);
+			break;
+		case SGE_ASSET_SFX:
+			SGE_FreeSfx((SGE_Sfx *)entry->asset);
+			break;
+		case SGE_ASSET_MUSIC:
+			SGE_FreeMusic((SGE_Music *)entry->asset);
+			break;
+		case SGE_ASSET_SPRITE_SHEET:
+			SGE_FreeSpriteSheet((SGE_SpriteSheet *)entry->asset);
+			break;
+	}
+
+	free(entry->path);
+	free(entry);
+}
+
+/* Frees all unreferenced assets, leaving out retained ones unless "includeRetained" is set */
+static int SGE_FreeUnreferencedAssets(bool includeRetained)
+{
+	int freedCount = 0;
+	int i = 0;
+
+	for(i = 0; i < bucketCount; i++)
+	{
+		SGE_CachedAsset *entry = pathBuckets[i];
+		while(entry != NULL)
+		{
+			SGE_CachedAsset *next = entry->nextByPath;
+			if(entry->refCount == 0 && (includeRetained || !entry->isRetained))
+			{
+				SGE_FreeCachedAsset(entry);
+				freedCount++;
+			}
+			entry = next;
+		}
+	}
+	return freedCount;
+}
+
+/* Finds an asset or loads and adds it to the cache, returns it with a new reference */
+static void *SGE_AcquireAsset(SGE_AssetType type, const char *path, int size)
+{
+	SGE_CachedAsset *entry = NULL;
+	char *normalizedPath = NULL;
+	Uint32 hash = 0;
+	void *asset = NULL;
+
+	if(path == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to acquire %s from NULL path!", assetTypeNames[type]);
+		return NULL;
+	}
+
+	normalizedPath = (char *)malloc(strlen(path) + 2);
+	SGE_NormalizeAssetPath(path, normalizedPath);
+	hash = SGE_HashAssetKey(type, normalizedPath, size);
+
+	entry = SGE_FindAssetByPath(type, normalizedPath, size, hash);
+	if(entry != NULL)
+	{
+		free(normalizedPath);
+		entry->refCount++;
+		return entry->asset;
+	}
+
+	switch(type)
+	{
+		case SGE_ASSET_TEXTURE:
+			asset = SGE_LoadTexture(normalizedPath);
+			break;
+		case SGE_ASSET_FONT:
+			asset = TTF_OpenFont(normalizedPath, size);
+			if(asset == NULL)
+			{
+				SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load font: %s TTF_Error: %s", normalizedPath, TTF_GetError());
+			}
+			break;
+		case SGE_ASSET_SFX:
+			asset = SGE_LoadSfx(normalizedPath);
+			break;
+		case SGE_ASSET_MUSIC:
+			asset = SGE_LoadMusic(normalizedPath);
+			break;
+		case SGE_ASSET_SPRITE_SHEET:
+			asset = SGE_LoadSpriteSheet(normalizedPath);
+			break;
+	}
+
+	if(asset == NULL)
+	{
+		free(normalizedPath);
+		return NULL;
+	}
+
+	if(assetCount >= bucketCount - bucketCount / 4)
+	{
+		SGE_ResizeAssetTables((bucketCount == 0) ? SGE_ASSET_CACHE_MIN_BUCKETS : bucketCount * 2);
+	}
+
+	entry = (SGE_CachedAsset *)malloc(sizeof(SGE_CachedAsset));
+	entry->type = type;
+	entry->path = normalizedPath;
+	entry->size = size;
+	entry->hash = hash;
+	entry->asset = asset;
+	entry->refCount = 1;
+	entry->isRetained = false;
+
+	entry->nextByPath = pathBuckets[hash & (bucketCount - 1)];
+	pathBuckets[hash & (bucketCount - 1)] = entry;
+	entry->nextByAsset = assetBuckets[SGE_HashAssetPointer(asset) & (bucketCount - 1)];
+	assetBuckets[SGE_HashAssetPointer(asset) & (bucketCount - 1)] = entry;
+	assetCount++;
+
+	return asset;
+}
+
+SGE_Texture *SGE_AcquireTexture(const char *path)
+{
+	return (SGE_Texture *)SGE_AcquireAsset(SGE_ASSET_TEXTURE, path, 0);
+}
+
+TTF_Font *SGE_AcquireFont(const char *path, int size)
+{
+	return (TTF_Font *)SGE_AcquireAsset(SGE_ASSET_FONT, path, size);
+}
+
+SGE_Sfx *SGE_AcquireSfx(const char *path)
+{
+	return (SGE_Sfx *)SGE_AcquireAsset(SGE_ASSET_SFX, path, 0);
+}
+
+SGE_Music *SGE_AcquireMusic(const char *path)
+{
+	return (SGE_Music *)SGE_AcquireAsset(SGE_ASSET_MUSIC, path, 0);
+}
+
+SGE_SpriteSheet *SGE_AcquireSpriteSheet(const char *path)
+{
+	return (SGE_SpriteSheet *)SGE_AcquireAsset(SGE_ASSET_SPRITE_SHEET, path, 0);
+}
+
+void SGE_ReleaseAsset(const void *asset)
+{
+	SGE_CachedAsset *entry = SGE_FindAsset(asset);
+	if(entry == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to release an asset that is not cached!");
+		return;
+	}
+	if(entry->refCount == 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to release %s %s more often than it was acquired!", assetTypeNames[entry->type], entry->path);
+		return;
+	}
+
+	entry->refCount--;
+	if(entry->refCount == 0 && !entry->isRetained && !(isSwitchingStates && retainAcrossStates))
+	{
+		SGE_FreeCachedAsset(entry);
+	}
+}
+
+bool SGE_IsCachedAsset(const void *asset)
+{
+	return SGE_FindAsset(asset) != NULL;
+}
+
+void SGE_SetAssetRetained(const void *asset, bool isRetained)
+{
+	SGE_CachedAsset *entry = SGE_FindAsset(asset);
+	if(entry == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to retain an asset that is not cached!");
+		return;
+	}
+
+	entry->isRetained = isRetained;
+	if(!isRetained && entry->refCount == 0 && !isSwitchingStates)
+	{
+		SGE_FreeCachedAsset(entry);
+	}
+}
+
+void SGE_SetAssetRetainAcrossStates(bool retain)
+{
+	retainAcrossStates = retain;
+}
+
+void SGE_PurgeAssets()
+{
+	int freedCount = SGE_FreeUnreferencedAssets(true);
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Purged %d unreferenced assets, %d left in the cache.", freedCount, assetCount);
+}
+
+int SGE_GetCachedAssetCount()
+{
+	return assetCount;
+}
+
+void SGE_PrintAssetList()
+{
+	int i = 0;
+
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "%d cached assets:", assetCount);
+	for(i = 0; i < bucketCount; i++)
+	{
+		SGE_CachedAsset *entry = pathBuckets[i];
+		while(entry != NULL)
+		{
+			if(entry->type == SGE_ASSET_FONT)
+			{
+				SGE_LogPrintLine(SGE_LOG_DEBUG, "%3d refs %s%-12s %s (%d pt)", entry->refCount, entry->isRetained ? "*" : " ", assetTypeNames[entry->type], entry->path, entry->size);
+			}
+			else
+			{
+				SGE_LogPrintLine(SGE_LOG_DEBUG, "%3d refs %s%-12s %s", entry->refCount, entry->isRetained ? "*" : " ", assetTypeNames[entry->type], entry->path);
+			}
+			entry = entry->nextByPath;
+		}
+	}
+}
+
+void SGE_AssetCacheBeginStateSwitch()
+{
+	isSwitchingStates = true;
+}
+
+void SGE_AssetCacheEndStateSwitch()
+{
+	int freedCount = 0;
+
+	isSwitchingStates = false;
+	freedCount = SGE_FreeUnreferencedAssets(false);
+	if(freedCount > 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_DEBUG, "Freed %d assets no longer used after switching states.", freedCount);
+	}
+}
+
+void SGE_AssetCacheQuit()
+{
+	int leakedCount = 0;
+	int i = 0;
+
+	for(i = 0; i < bucketCount; i++)
+	{
+		SGE_CachedAsset *entry = pathBuckets[i];
+		while(entry != NULL)
+		{
+			SGE_CachedAsset *next = entry->nextByPath;
+			if(entry->refCount > 0)
+			{
+				SGE_LogPrintLine(SGE_LOG_DEBUG, "%s %s still has %d references.", assetTypeNames[entry->type], entry->path, entry->refCount);
+				leakedCount++;
+			}
+			SGE_FreeCachedAsset(entry);
+			entry = next;
+		}
+	}
+	if(leakedCount > 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Freed %d assets that were never released.", leakedCount);
+	}
+
+	free(pathBuckets);
+	free(assetBuckets);
+	pathBuckets = NULL;
+	assetBuckets = NULL;
+	bucketCount = 0;
+	assetCount = 0;
+	isSwitchingStates = false;
+}
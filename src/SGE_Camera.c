@@ -0,0 +1,145 @@
+#include "SGE_Camera.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+
+#include <stdlib.h>
+
+/* Camera used for rendering, NULL for screen space */
+static SGE_Camera *currentCamera = NULL;
+
+SGE_Camera *SGE_CreateCamera()
+{
+	SGE_EngineData *engine = SGE_GetEngineData();
+	SGE_Camera *camera = (SGE_Camera*)malloc(sizeof(SGE_Camera));
+	camera->x = engine->screenWidth / 2.0f;
+	camera->y = engine->screenHeight / 2.0f;
+	camera->zoom = 1.0f;
+	camera->rotation = 0;
+	camera->viewport.x = 0;
+	camera->viewport.y = 0;
+	camera->viewport.w = engine->screenWidth;
+	camera->viewport.h = engine->screenHeight;
+	camera->culledCount = 0;
+	SGE_UpdateCamera(camera);
+	return camera;
+}
+
+void SGE_FreeCamera(SGE_Camera *camera)
+{
+	if(camera == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL camera!");
+		return;
+	}
+	if(currentCamera == camera)
+	{
+		currentCamera = NULL;
+	}
+	free(camera);
+}
+
+void SGE_SetCamera(SGE_Camera *camera)
+{
+	currentCamera = camera;
+	if(camera != NULL)
+	{
+		SGE_UpdateCamera(camera);
+	}
+}
+
+SGE_Camera *SGE_GetCamera()
+{
+	return currentCamera;
+}
+
+void SGE_UpdateCamera(SGE_Camera *camera)
+{
+	if(camera->zoom <= 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Camera zoom has to be more than 0, using 1!");
+		camera->zoom = 1.0f;
+	}
+
+	double radians = camera->rotation * M_PI / 180.0;
+	camera->cosRotation = (float)SDL_cos(radians);
+	camera->sinRotation = (float)SDL_sin(radians);
+
+	/* The visible area is the bounding box of the viewport's corners in the world */
+	float cornersX[4] = {0, 1, 1, 0};
+	float cornersY[4] = {0, 0, 1, 1};
+	float minX = 0, minY = 0, maxX = 0, maxY = 0;
+	int i = 0;
+	for(i = 0; i < 4; i++)
+	{
+		float worldX = 0;
+		float worldY = 0;
+		SGE_CameraScreenToWorld(camera, camera->viewport.x + cornersX[i] * camera->viewport.w, camera->viewport.y + cornersY[i] * camera->viewport.h, &worldX, &worldY);
+		if(i == 0 || worldX < minX) minX = worldX;
+		if(i == 0 || worldY < minY) minY = worldY;
+		if(i == 0 || worldX > maxX) maxX = worldX;
+		if(i == 0 || worldY > maxY) maxY = worldY;
+	}
+	camera->visibleArea.x = minX;
+	camera->visibleArea.y = minY;
+	camera->visibleArea.w = maxX - minX;
+	camera->visibleArea.h = maxY - minY;
+}
+
+void SGE_CameraWorldToScreen(const SGE_Camera *camera, float worldX, float worldY, float *screenX, float *screenY)
+{
+	float dx = worldX - camera->x;
+	float dy = worldY - camera->y;
+	*screenX = camera->viewport.x + camera->viewport.w / 2.0f + (dx * camera->cosRotation + dy * camera->sinRotation) * camera->zoom;
+	*screenY = camera->viewport.y + camera->viewport.h / 2.0f + (dy * camera->cosRotation - dx * camera->sinRotation) * camera->zoom;
+}
+
+void SGE_CameraScreenToWorld(const SGE_Camera *camera, float screenX, float screenY, float *worldX, float *worldY)
+{
+	float dx = (screenX - camera->viewport.x - camera->viewport.w / 2.0f) / camera->zoom;
+	float dy = (screenY - camera->viewport.y - camera->viewport.h / 2.0f) / camera->zoom;
+	*worldX = camera->x + dx * camera->cosRotation - dy * camera->sinRotation;
+	*worldY = camera->y + dx * camera->sinRotation + dy * camera->cosRotation;
+}
+
+bool SGE_CameraIsVisible(const SGE_Camera *camera, const SDL_FRect *rect, double rotation)
+{
+	float minX = rect->x;
+	float minY = rect->y;
+	float maxX = rect->x + rect->w;
+	float maxY = rect->y + rect->h;
+
+	/* A rotated rect stays inside the circle around it's center, test the square around that circle */
+	if(rotation != 0)
+	{
+		float centerX = rect->x + rect->w / 2.0f;
+		float centerY = rect->y + rect->h / 2.0f;
+		float radius = SDL_sqrtf(rect->w * rect->w + rect->h * rect->h) / 2.0f;
+		minX = centerX - radius;
+		minY = centerY - radius;
+		maxX = centerX + radius;
+		maxY = centerY + radius;
+	}
+
+	const SDL_FRect *view = &camera->visibleArea;
+	return maxX >= view->x && minX <= view->x + view->w && maxY >= view->y && minY <= view->y + view->h;
+}
+
+bool SGE_CameraApply(SGE_Camera *camera, SDL_FRect *rect, double *rotation)
+{
+	if(!SGE_CameraIsVisible(camera, rect, *rotation))
+	{
+		camera->culledCount++;
+		return false;
+	}
+
+	/* Rects rotate around their center, so only the center has to be moved */
+	float centerX = 0;
+	float centerY = 0;
+	SGE_CameraWorldToScreen(camera, rect->x + rect->w / 2.0f, rect->y + rect->h / 2.0f, &centerX, &centerY);
+	rect->w *= camera->zoom;
+	rect->h *= camera->zoom;
+	rect->x = centerX - rect->w / 2.0f;
+	rect->y = centerY - rect->h / 2.0f;
+	*rotation -= camera->rotation;
+	return true;
+}
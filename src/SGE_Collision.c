@@ -0,0 +1,331 @@
+#include "SGE_Collision.h"
+#include "SGE_Logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SGE_COLLISION_SSE2
+	#include <emmintrin.h>
+#endif
+
+/* AVX2 is compiled for that function only, so it is only used when the CPU reports it */
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && defined(_M_X64))
+	#define SGE_COLLISION_AVX2
+	#include <immintrin.h>
+	#if defined(__GNUC__)
+		#define SGE_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#define SGE_TARGET_AVX2
+	#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define SGE_COLLISION_NEON
+	#include <arm_neon.h>
+#endif
+
+/* Rects tested per kernel call, the hit mask of a chunk fits on the stack */
+#define SGE_COLLISION_CHUNK 1024
+
+typedef struct
+{
+	float left, top, right, bottom;
+} SGE_CollisionQuery;
+
+/* Sets bit i of "mask" for every overlapping rect i, "mask" is cleared by the caller */
+typedef void (*SGE_CollisionKernel)(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *mask);
+
+static SGE_CollisionKernel collisionKernel = NULL;
+static const char *collisionKernelName = "Scalar";
+
+/* Branch free so compilers without intrinsics can still vectorize it */
+static void SGE_CollideRectsScalarRange(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int start, int count, Uint32 *mask)
+{
+	int i = 0;
+	for(i = start; i < count; i++)
+	{
+		Uint32 hit = (query->left < x[i] + w[i]) & (x[i] < query->right) & (query->top < y[i] + h[i]) & (y[i] < query->bottom);
+		mask[i >> 5] |= hit << (i & 31);
+	}
+}
+
+static void SGE_CollideRectsScalar(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *mask)
+{
+	SGE_CollideRectsScalarRange(query, x, y, w, h, 0, count, mask);
+}
+
+#ifdef SGE_COLLISION_SSE2
+static void SGE_CollideRectsSSE2(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *mask)
+{
+	__m128 left = _mm_set1_ps(query->left);
+	__m128 top = _mm_set1_ps(query->top);
+	__m128 right = _mm_set1_ps(query->right);
+	__m128 bottom = _mm_set1_ps(query->bottom);
+
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		__m128 rectX = _mm_loadu_ps(x + i);
+		__m128 rectY = _mm_loadu_ps(y + i);
+		__m128 rectRight = _mm_add_ps(rectX, _mm_loadu_ps(w + i));
+		__m128 rectBottom = _mm_add_ps(rectY, _mm_loadu_ps(h + i));
+
+		__m128 hit = _mm_and_ps(_mm_cmplt_ps(left, rectRight), _mm_cmplt_ps(rectX, right));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmplt_ps(top, rectBottom), _mm_cmplt_ps(rectY, bottom)));
+		mask[i >> 5] |= (Uint32)_mm_movemask_ps(hit) << (i & 31);
+	}
+	SGE_CollideRectsScalarRange(query, x, y, w, h, i, count, mask);
+}
+#endif
+
+#ifdef SGE_COLLISION_AVX2
+SGE_TARGET_AVX2 static void SGE_CollideRectsAVX2(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *mask)
+{
+	__m256 left = _mm256_set1_ps(query->left);
+	__m256 top = _mm256_set1_ps(query->top);
+	__m256 right = _mm256_set1_ps(query->right);
+	__m256 bottom = _mm256_set1_ps(query->bottom);
+
+	int i = 0;
+	for(i = 0; i + 8 <= count; i += 8)
+	{
+		__m256 rectX = _mm256_loadu_ps(x + i);
+		__m256 rectY = _mm256_loadu_ps(y + i);
+		__m256 rectRight = _mm256_add_ps(rectX, _mm256_loadu_ps(w + i));
+		__m256 rectBottom = _mm256_add_ps(rectY, _mm256_loadu_ps(h + i));
+
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(left, rectRight, _CMP_LT_OQ), _mm256_cmp_ps(rectX, right, _CMP_LT_OQ));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(top, rectBottom, _CMP_LT_OQ), _mm256_cmp_ps(rectY, bottom, _CMP_LT_OQ)));
+		mask[i >> 5] |= (Uint32)_mm256_movemask_ps(hit) << (i & 31);
+	}
+	SGE_CollideRectsScalarRange(query, x, y, w, h, i, count, mask);
+}
+#endif
+
+#ifdef SGE_COLLISION_NEON
+static void SGE_CollideRectsNEON(const SGE_CollisionQuery *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *mask)
+{
+	float32x4_t left = vdupq_n_f32(query->left);
+	float32x4_t top = vdupq_n_f32(query->top);
+	float32x4_t right = vdupq_n_f32(query->right);
+	float32x4_t bottom = vdupq_n_f32(query->bottom);
+	const uint32_t laneBits[4] = {1, 2, 4, 8};
+	uint32x4_t lanes = vld1q_u32(laneBits);
+
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		float32x4_t rectX = vld1q_f32(x + i);
+		float32x4_t rectY = vld1q_f32(y + i);
+		float32x4_t rectRight = vaddq_f32(rectX, vld1q_f32(w + i));
+		float32x4_t rectBottom = vaddq_f32(rectY, vld1q_f32(h + i));
+
+		uint32x4_t hit = vandq_u32(vcltq_f32(left, rectRight), vcltq_f32(rectX, right));
+		hit = vandq_u32(hit, vandq_u32(vcltq_f32(top, rectBottom), vcltq_f32(rectY, bottom)));
+
+		/* No movemask on NEON, add up one bit per lane instead */
+		uint32x4_t bits = vandq_u32(hit, lanes);
+		uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+		sum = vpadd_u32(sum, sum);
+		mask[i >> 5] |= vget_lane_u32(sum, 0) << (i & 31);
+	}
+	SGE_CollideRectsScalarRange(query, x, y, w, h, i, count, mask);
+}
+#endif
+
+/* Picks the fastest kernel the CPU supports */
+static void SGE_SelectCollisionKernel()
+{
+	collisionKernel = SGE_CollideRectsScalar;
+	collisionKernelName = "Scalar";
+
+#ifdef SGE_COLLISION_SSE2
+	if(SDL_HasSSE2())
+	{
+		collisionKernel = SGE_CollideRectsSSE2;
+		collisionKernelName = "SSE2";
+	}
+#endif
+
+#if defined(SGE_COLLISION_AVX2) && SDL_VERSION_ATLEAST(2, 0, 4)
+	if(SDL_HasAVX2())
+	{
+		collisionKernel = SGE_CollideRectsAVX2;
+		collisionKernelName = "AVX2";
+	}
+#endif
+
+#if defined(SGE_COLLISION_NEON) && SDL_VERSION_ATLEAST(2, 0, 6)
+	if(SDL_HasNEON())
+	{
+		collisionKernel = SGE_CollideRectsNEON;
+		collisionKernelName = "NEON";
+	}
+#endif
+
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Using %s rect collision kernel.", collisionKernelName);
+}
+
+const char *SGE_GetCollisionKernelName()
+{
+	if(collisionKernel == NULL)
+	{
+		SGE_SelectCollisionKernel();
+	}
+	return collisionKernelName;
+}
+
+static int SGE_LowestBitIndex(Uint32 bits)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz(bits);
+#else
+	int index = 0;
+	while((bits & 1) == 0)
+	{
+		bits >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+int SGE_CollideRectBatch(const SDL_FRect *query, const float *x, const float *y, const float *w, const float *h, int count, Uint32 *hitMask, int *hitIndices)
+{
+	if(query == NULL || count <= 0)
+	{
+		return 0;
+	}
+
+	if(collisionKernel == NULL)
+	{
+		SGE_SelectCollisionKernel();
+	}
+
+	SGE_CollisionQuery bounds;
+	bounds.left = query->x;
+	bounds.top = query->y;
+	bounds.right = query->x + query->w;
+	bounds.bottom = query->y + query->h;
+
+	Uint32 chunkMask[SGE_COLLISION_CHUNK / 32];
+	int hits = 0;
+	int start = 0;
+	for(start = 0; start < count; start += SGE_COLLISION_CHUNK)
+	{
+		int chunkCount = SDL_min(SGE_COLLISION_CHUNK, count - start);
+		int words = (chunkCount + 31) / 32;
+		Uint32 *mask = (hitMask != NULL) ? hitMask + start / 32 : chunkMask;
+		memset(mask, 0, words * sizeof(Uint32));
+
+		collisionKernel(&bounds, x + start, y + start, w + start, h + start, chunkCount, mask);
+
+		int word = 0;
+		for(word = 0; word < words; word++)
+		{
+			Uint32 bits = mask[word];
+			while(bits != 0)
+			{
+				if(hitIndices != NULL)
+				{
+					hitIndices[hits] = start + word * 32 + SGE_LowestBitIndex(bits);
+				}
+				hits++;
+				bits &= bits - 1;
+			}
+		}
+	}
+	return hits;
+}
+
+int SGE_CollideRectArray(const SDL_FRect *query, const SGE_RectArray *array, Uint32 *hitMask, int *hitIndices)
+{
+	return SGE_CollideRectBatch(query, array->x, array->y, array->w, array->h, array->count, hitMask, hitIndices);
+}
+
+SGE_RectArray *SGE_CreateRectArray(int capacity)
+{
+	SGE_RectArray *array = (SGE_RectArray*)malloc(sizeof(SGE_RectArray));
+	array->x = NULL;
+	array->y = NULL;
+	array->w = NULL;
+	array->h = NULL;
+	array->count = 0;
+	array->capacity = 0;
+
+	if(capacity > 0)
+	{
+		array->x = (float*)malloc(capacity * sizeof(float));
+		array->y = (float*)malloc(capacity * sizeof(float));
+		array->w = (float*)malloc(capacity * sizeof(float));
+		array->h = (float*)malloc(capacity * sizeof(float));
+		array->capacity = capacity;
+	}
+	return array;
+}
+
+void SGE_FreeRectArray(SGE_RectArray *array)
+{
+	if(array == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL rect array!");
+		return;
+	}
+
+	free(array->x);
+	free(array->y);
+	free(array->w);
+	free(array->h);
+	free(array);
+}
+
+void SGE_RectArrayClear(SGE_RectArray *array)
+{
+	array->count = 0;
+}
+
+/* Grows one field array, keeping the old one on failure */
+static bool SGE_GrowRectArrayField(float **field, int capacity)
+{
+	float *grown = (float*)realloc(*field, capacity * sizeof(float));
+	if(grown == NULL)
+	{
+		return false;
+	}
+	*field = grown;
+	return true;
+}
+
+int SGE_RectArrayAdd(SGE_RectArray *array, const SDL_FRect *rect)
+{
+	if(array->count == array->capacity)
+	{
+		int capacity = (array->capacity > 0) ? array->capacity * 2 : 64;
+		if(!SGE_GrowRectArrayField(&array->x, capacity) || !SGE_GrowRectArrayField(&array->y, capacity) || !SGE_GrowRectArrayField(&array->w, capacity) || !SGE_GrowRectArrayField(&array->h, capacity))
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow rect array!");
+			return -1;
+		}
+		array->capacity = capacity;
+	}
+
+	int index = array->count;
+	array->count++;
+	SGE_RectArraySet(array, index, rect);
+	return index;
+}
+
+void SGE_RectArraySet(SGE_RectArray *array, int index, const SDL_FRect *rect)
+{
+	if(index < 0 || index >= array->count)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Rect array index %d out of range!", index);
+		return;
+	}
+
+	array->x[index] = rect->x;
+	array->y[index] = rect->y;
+	array->w[index] = rect->w;
+	array->h[index] = rect->h;
+}
@@ -0,0 +1,384 @@
+#include "SGE_CollisionWorld.h"
+#include "SGE_Logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+SGE_CollisionWorld *SGE_CreateCollisionWorld()
+{
+	SGE_CollisionWorld *world = (SGE_CollisionWorld*)malloc(sizeof(SGE_CollisionWorld));
+	world->bodies = NULL;
+	world->bodyCount = 0;
+	world->bodyCapacity = 0;
+	world->firstFree = -1;
+	world->count = 0;
+	world->order = NULL;
+	world->orderCapacity = 0;
+	world->sorted = SGE_CreateRectArray(0);
+	world->hits = NULL;
+	world->hitCapacity = 0;
+	world->contacts = NULL;
+	world->contactCount = 0;
+	world->contactCapacity = 0;
+	world->newContacts = NULL;
+	world->newContactCount = 0;
+	world->newContactCapacity = 0;
+	world->onContact = NULL;
+	world->userData = NULL;
+	world->isUpdating = false;
+	world->pendingRemoveCount = 0;
+	world->lastPairTests = 0;
+	return world;
+}
+
+void SGE_FreeCollisionWorld(SGE_CollisionWorld *world)
+{
+	if(world == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL collision world!");
+		return;
+	}
+
+	free(world->bodies);
+	free(world->order);
+	SGE_FreeRectArray(world->sorted);
+	free(world->hits);
+	free(world->contacts);
+	free(world->newContacts);
+	free(world);
+}
+
+void SGE_CollisionWorldSetCallback(SGE_CollisionWorld *world, SGE_ContactCallback callback, void *userData)
+{
+	world->onContact = callback;
+	world->userData = userData;
+}
+
+/* Makes room for "needed" items in an array, keeping the old one on failure */
+static bool SGE_ReserveCollisionArray(void **array, int *capacity, int needed, size_t itemSize)
+{
+	if(needed <= *capacity)
+	{
+		return true;
+	}
+
+	int grown = (*capacity > 0) ? *capacity : 64;
+	while(grown < needed)
+	{
+		grown *= 2;
+	}
+
+	void *items = realloc(*array, grown * itemSize);
+	if(items == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow collision world!");
+		return false;
+	}
+	*array = items;
+	*capacity = grown;
+	return true;
+}
+
+static bool SGE_IsCollisionBodyValid(SGE_CollisionWorld *world, int body)
+{
+	if(body < 0 || body >= world->bodyCount || !world->bodies[body].isUsed)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Invalid collision body %d!", body);
+		return false;
+	}
+	return true;
+}
+
+int SGE_CollisionWorldAdd(SGE_CollisionWorld *world, const SDL_FRect *rect, void *data)
+{
+	if(!SGE_ReserveCollisionArray((void**)&world->order, &world->orderCapacity, world->count + 1, sizeof(int)))
+	{
+		return -1;
+	}
+
+	int body = world->firstFree;
+	if(body != -1)
+	{
+		world->firstFree = world->bodies[body].nextFree;
+	}
+	else
+	{
+		if(!SGE_ReserveCollisionArray((void**)&world->bodies, &world->bodyCapacity, world->bodyCount + 1, sizeof(SGE_CollisionBody)))
+		{
+			return -1;
+		}
+		body = world->bodyCount;
+		world->bodyCount++;
+	}
+
+	world->bodies[body].rect = *rect;
+	world->bodies[body].data = data;
+	world->bodies[body].isUsed = true;
+	world->bodies[body].isRemovePending = false;
+	world->bodies[body].nextFree = -1;
+
+	/* Sorted into place by the next update */
+	world->order[world->count] = body;
+	world->count++;
+	return body;
+}
+
+void SGE_CollisionWorldMove(SGE_CollisionWorld *world, int body, const SDL_FRect *rect)
+{
+	if(!SGE_IsCollisionBodyValid(world, body))
+	{
+		return;
+	}
+	world->bodies[body].rect = *rect;
+}
+
+void *SGE_CollisionWorldGetData(SGE_CollisionWorld *world, int body)
+{
+	if(!SGE_IsCollisionBodyValid(world, body))
+	{
+		return NULL;
+	}
+	return world->bodies[body].data;
+}
+
+const SDL_FRect *SGE_CollisionWorldGetRect(SGE_CollisionWorld *world, int body)
+{
+	if(!SGE_IsCollisionBodyValid(world, body))
+	{
+		return NULL;
+	}
+	return &world->bodies[body].rect;
+}
+
+int SGE_CollisionWorldGetContactCount(SGE_CollisionWorld *world)
+{
+	return world->contactCount;
+}
+
+/* Pairs are stored with the lower handle in the high half, so sorted pairs group by their first body */
+static Uint64 SGE_ContactKey(int bodyA, int bodyB)
+{
+	if(bodyA > bodyB)
+	{
+		int temp = bodyA;
+		bodyA = bodyB;
+		bodyB = temp;
+	}
+	return ((Uint64)bodyA << 32) | (Uint64)(Uint32)bodyB;
+}
+
+static void SGE_ReportContact(SGE_CollisionWorld *world, SGE_ContactEvent event, Uint64 key)
+{
+	if(world->onContact == NULL)
+	{
+		return;
+	}
+
+	int bodyA = (int)(key >> 32);
+	int bodyB = (int)(key & 0xFFFFFFFF);
+	world->onContact(event, bodyA, world->bodies[bodyA].data, bodyB, world->bodies[bodyB].data, world->userData);
+}
+
+/* Ends a body's contacts and frees it, removals from inside the callback are left pending */
+static void SGE_DetachCollisionBody(SGE_CollisionWorld *world, int body)
+{
+	int i = 0;
+	int kept = 0;
+
+	world->isUpdating = true;
+	for(i = 0; i < world->contactCount; i++)
+	{
+		Uint64 key = world->contacts[i];
+		if((int)(key >> 32) == body || (int)(key & 0xFFFFFFFF) == body)
+		{
+			SGE_ReportContact(world, SGE_CONTACT_END, key);
+		}
+		else
+		{
+			world->contacts[kept] = key;
+			kept++;
+		}
+	}
+	world->contactCount = kept;
+	world->isUpdating = false;
+
+	for(i = 0; i < world->count; i++)
+	{
+		if(world->order[i] == body)
+		{
+			memmove(&world->order[i], &world->order[i + 1], (world->count - i - 1) * sizeof(int));
+			break;
+		}
+	}
+	world->count--;
+
+	world->bodies[body].isUsed = false;
+	world->bodies[body].data = NULL;
+	world->bodies[body].nextFree = world->firstFree;
+	world->firstFree = body;
+}
+
+/* Frees the bodies removed from inside the contact callback, their end contacts may remove more */
+static void SGE_ProcessPendingRemoves(SGE_CollisionWorld *world)
+{
+	int i = 0;
+	while(world->pendingRemoveCount > 0)
+	{
+		for(i = 0; i < world->bodyCount; i++)
+		{
+			if(world->bodies[i].isUsed && world->bodies[i].isRemovePending)
+			{
+				world->bodies[i].isRemovePending = false;
+				world->pendingRemoveCount--;
+				SGE_DetachCollisionBody(world, i);
+			}
+		}
+	}
+}
+
+void SGE_CollisionWorldRemove(SGE_CollisionWorld *world, int body)
+{
+	if(!SGE_IsCollisionBodyValid(world, body) || world->bodies[body].isRemovePending)
+	{
+		return;
+	}
+
+	world->bodies[body].isRemovePending = true;
+	world->pendingRemoveCount++;
+	if(!world->isUpdating)
+	{
+		SGE_ProcessPendingRemoves(world);
+	}
+}
+
+static int SGE_CompareContacts(const void *a, const void *b)
+{
+	Uint64 keyA = *(const Uint64*)a;
+	Uint64 keyB = *(const Uint64*)b;
+	return (keyA > keyB) - (keyA < keyB);
+}
+
+/* Sorts the bodies by left edge, they barely move between updates so this is close to one pass */
+static void SGE_SortCollisionBodies(SGE_CollisionWorld *world)
+{
+	int i = 0;
+	for(i = 1; i < world->count; i++)
+	{
+		int body = world->order[i];
+		float x = world->bodies[body].rect.x;
+		int j = i - 1;
+		while(j >= 0 && world->bodies[world->order[j]].rect.x > x)
+		{
+			world->order[j + 1] = world->order[j];
+			j--;
+		}
+		world->order[j + 1] = body;
+	}
+
+	SGE_RectArrayClear(world->sorted);
+	for(i = 0; i < world->count; i++)
+	{
+		SGE_RectArrayAdd(world->sorted, &world->bodies[world->order[i]].rect);
+	}
+}
+
+/* Finds the overlapping pairs into newContacts */
+static void SGE_SweepCollisionBodies(SGE_CollisionWorld *world)
+{
+	SGE_RectArray *sorted = world->sorted;
+	int count = sorted->count;
+	int i = 0;
+	int k = 0;
+
+	world->newContactCount = 0;
+	world->lastPairTests = 0;
+	if(!SGE_ReserveCollisionArray((void**)&world->hits, &world->hitCapacity, count, sizeof(int)))
+	{
+		return;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		/* Only bodies starting before this one ends can overlap it */
+		float right = sorted->x[i] + sorted->w[i];
+		int end = i + 1;
+		while(end < count && sorted->x[end] < right)
+		{
+			end++;
+		}
+
+		int candidates = end - i - 1;
+		if(candidates <= 0)
+		{
+			continue;
+		}
+
+		SDL_FRect rect;
+		rect.x = sorted->x[i];
+		rect.y = sorted->y[i];
+		rect.w = sorted->w[i];
+		rect.h = sorted->h[i];
+		int hitCount = SGE_CollideRectBatch(&rect, sorted->x + i + 1, sorted->y + i + 1, sorted->w + i + 1, sorted->h + i + 1, candidates, NULL, world->hits);
+		world->lastPairTests += candidates;
+
+		if(!SGE_ReserveCollisionArray((void**)&world->newContacts, &world->newContactCapacity, world->newContactCount + hitCount, sizeof(Uint64)))
+		{
+			return;
+		}
+		for(k = 0; k < hitCount; k++)
+		{
+			world->newContacts[world->newContactCount] = SGE_ContactKey(world->order[i], world->order[i + 1 + world->hits[k]]);
+			world->newContactCount++;
+		}
+	}
+
+	qsort(world->newContacts, world->newContactCount, sizeof(Uint64), SGE_CompareContacts);
+}
+
+void SGE_CollisionWorldUpdate(SGE_CollisionWorld *world)
+{
+	if(world->isUpdating)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Collision world can't be updated from inside it's contact callback!");
+		return;
+	}
+
+	SGE_SortCollisionBodies(world);
+	SGE_SweepCollisionBodies(world);
+
+	/* Both pair lists are sorted, walk them together to find the pairs that started, stayed and ended */
+	int oldIndex = 0;
+	int newIndex = 0;
+	world->isUpdating = true;
+	while(oldIndex < world->contactCount || newIndex < world->newContactCount)
+	{
+		if(newIndex == world->newContactCount || (oldIndex < world->contactCount && world->contacts[oldIndex] < world->newContacts[newIndex]))
+		{
+			SGE_ReportContact(world, SGE_CONTACT_END, world->contacts[oldIndex]);
+			oldIndex++;
+		}
+		else if(oldIndex == world->contactCount || world->newContacts[newIndex] < world->contacts[oldIndex])
+		{
+			SGE_ReportContact(world, SGE_CONTACT_BEGIN, world->newContacts[newIndex]);
+			newIndex++;
+		}
+		else
+		{
+			SGE_ReportContact(world, SGE_CONTACT_STAY, world->newContacts[newIndex]);
+			oldIndex++;
+			newIndex++;
+		}
+	}
+	world->isUpdating = false;
+
+	Uint64 *contacts = world->contacts;
+	int contactCapacity = world->contactCapacity;
+	world->contacts = world->newContacts;
+	world->contactCount = world->newContactCount;
+	world->contactCapacity = world->newContactCapacity;
+	world->newContacts = contacts;
+	world->newContactCapacity = contactCapacity;
+	world->newContactCount = 0;
+
+	SGE_ProcessPendingRemoves(world);
+}
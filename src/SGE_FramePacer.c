@@ -0,0 +1,157 @@
+#include "SGE_FramePacer.h"
+#include "SGE_Logger.h"
+
+#include <SDL2/SDL.h>
+
+/* Performance counter ticks per second */
+static Uint64 frequency = 0;
+
+/* Length of one frame in performance counter ticks, 0 when pacing is off */
+static Uint64 framePeriod = 0;
+
+/* Absolute time in performance counter ticks at which the current frame should end */
+static Uint64 deadline = 0;
+
+/* Time spent yielding before a deadline instead of sleeping */
+static double spinMargin = 1.0;
+
+/* Running estimate of how much longer SDL_Delay() sleeps than requested */
+static double sleepOvershoot = 1.0;
+
+/* Pacing error of the last frame and the largest one since it was last queried */
+static double lastError = 0;
+static double maxError = 0;
+
+static double SGE_FramePacerTicksToMS(Sint64 ticks)
+{
+	return (double)ticks * 1000.0 / frequency;
+}
+
+void SGE_FramePacerSetTargetFPS(int fps)
+{
+	if(frequency == 0)
+	{
+		frequency = SDL_GetPerformanceFrequency();
+	}
+
+	if(fps <= 0)
+	{
+		framePeriod = 0;
+	}
+	else
+	{
+		framePeriod = frequency / fps;
+	}
+	SGE_FramePacerReset();
+}
+
+bool SGE_FramePacerIsEnabled()
+{
+	return framePeriod != 0;
+}
+
+void SGE_FramePacerSetSpinMargin(double milliseconds)
+{
+	if(milliseconds < 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Frame pacer spin margin can't be negative!");
+		return;
+	}
+	spinMargin = milliseconds;
+}
+
+void SGE_FramePacerReset()
+{
+	deadline = 0;
+	lastError = 0;
+	maxError = 0;
+}
+
+void SGE_FramePacerWait()
+{
+	if(framePeriod == 0)
+	{
+		return;
+	}
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(deadline == 0)
+	{
+		deadline = now + framePeriod;
+	}
+
+	if(now < deadline)
+	{
+		double periodTime = SGE_FramePacerTicksToMS(framePeriod);
+
+		/* Coarse sleep, leaving enough time before the deadline to absorb the usual oversleep */
+		double sleepTime = SGE_FramePacerTicksToMS(deadline - now) - spinMargin - sleepOvershoot;
+		if(sleepTime >= 1.0)
+		{
+			Uint32 requested = (Uint32)sleepTime;
+			Uint64 sleepStart = now;
+			SDL_Delay(requested);
+			now = SDL_GetPerformanceCounter();
+
+			/*
+			 * Raise the estimate quickly on a long sleep, lower it slowly otherwise.
+			 * Sleeps overshooting by more than a frame are hitches like a suspend or a debugger break and are ignored.
+			 */
+			double overshoot = SGE_FramePacerTicksToMS(now - sleepStart) - requested;
+			if(overshoot <= periodTime)
+			{
+				if(overshoot > sleepOvershoot)
+				{
+					sleepOvershoot = overshoot;
+				}
+				else
+				{
+					sleepOvershoot = sleepOvershoot * 0.95 + overshoot * 0.05;
+				}
+			}
+		}
+		else
+		{
+			/* Without a sleep there is nothing to measure, let the estimate decay so sleeping is tried again */
+			sleepOvershoot *= 0.95;
+		}
+		
+		/* An estimate near the frame length would leave no time to sleep at all */
+		if(sleepOvershoot > periodTime * 0.25)
+		{
+			sleepOvershoot = periodTime * 0.25;
+		}
+
+		/* Yield the rest of the time away */
+		while(now < deadline)
+		{
+			SDL_Delay(0);
+			now = SDL_GetPerformanceCounter();
+		}
+	}
+
+	lastError = SGE_FramePacerTicksToMS((Sint64)(now - deadline));
+	if(SDL_fabs(lastError) > maxError)
+	{
+		maxError = SDL_fabs(lastError);
+	}
+
+	/* Keep the deadlines evenly spaced, unless a whole frame was missed, then restart from now */
+	deadline += framePeriod;
+	if(deadline <= now)
+	{
+		deadline = now + framePeriod;
+	}
+}
+
+double SGE_FramePacerGetLastError()
+{
+	return lastError;
+}
+
+double SGE_FramePacerGetMaxError()
+{
+	double error = maxError;
+	maxError = 0;
+	return error;
+}
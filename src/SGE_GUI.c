@@ -1,6 +1,8 @@
 #include "SGE.h"
 #include "SGE_GUI.h"
 #include "SGE_Logger.h"
+#include "SGE_Profiler.h"
+#include "SGE_Camera.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -50,6 +52,10 @@ static char panelsListStr[200];
 static SGE_TextLabel *panelListLabel;
 static SGE_TextLabel *stateListLabel;
 
+/* Screen position of the panel cache being drawn, clip rects are moved by it */
+static bool isDrawingPanelCache = false;
+static SDL_Point panelCacheOrigin;
+
 /* Frame rate counter */
 static int frameCounter;
 static int countedFPS;
@@ -63,6 +69,8 @@ static char fpsStr[10];
 static SGE_TextLabel *fpsLabel;
 static char vsyncStr[10];
 static SGE_TextLabel *vsyncLabel;
+static char profilerStr[64];
+static SGE_TextLabel *profilerLabel;
 
 /* Generalization of GUI control lists */
 static void SGE_GUI_ControlList_HandleEvents(SGE_GUI_ControlList *controls);
@@ -78,15 +86,18 @@ static void onShowFrameInfoToggle(void *data)
 		SGE_TextLabelSetText(deltaLabel, " ");
 		SGE_TextLabelSetText(fpsLabel, " ");
 		SGE_TextLabelSetText(vsyncLabel, " ");
+		SGE_TextLabelSetText(profilerLabel, " ");
 		deltaLabel->showBG = false;
 		fpsLabel->showBG = false;
 		vsyncLabel->showBG = false;
+		profilerLabel->showBG = false;
 	}
 	else
 	{
 		deltaLabel->showBG = true;
 		fpsLabel->showBG = true;
 		vsyncLabel->showBG = true;
+		profilerLabel->showBG = true;
 	}
 }
 
@@ -142,6 +153,11 @@ static void SGE_GUI_DebugState_Init()
 	SGE_TextLabelSetMode(vsyncLabel, SGE_TEXT_MODE_SHADED);
 	SGE_TextLabelSetBGColor(vsyncLabel, SGE_COLOR_BLACK);
 
+	profilerLabel = SGE_CreateTextLabel(" ", 0, 0, SGE_COLOR_WHITE, NULL);
+	SGE_TextLabelSetPositionNextTo(profilerLabel, vsyncLabel->boundBox, SGE_CONTROL_DIRECTION_UP, 0, 0);
+	SGE_TextLabelSetMode(profilerLabel, SGE_TEXT_MODE_SHADED);
+	SGE_TextLabelSetBGColor(profilerLabel, SGE_COLOR_BLACK);
+
 	currentStateControls = tempCurrentStateControls;
 }
 
@@ -154,7 +170,7 @@ static void SGE_GUI_DebugState_Update()
 	/* Update frame info labels */
 	if(showFrameInfo)
 	{
-		sprintf(deltaStr, "dt: %.3f s", engine->delta);
+		sprintf(deltaStr, "dt: %.3f s", engine->frameDelta);
 		SGE_TextLabelSetText(deltaLabel, deltaStr);
 
 		/* Calculate the framerate */
@@ -164,6 +180,16 @@ static void SGE_GUI_DebugState_Update()
 			countedFPS = frameCounter;
 			frameCounter = 0;
 			lastFPSCountTime = SDL_GetTicks();
+
+			/* Show the most expensive frame phase, only once a second to avoid rendering new text every frame */
+			if(SGE_ProfilerIsEnabled())
+			{
+				SGE_ProfilerStats stats;
+				SGE_ProfilerPhase slowest = SGE_ProfilerGetSlowestPhase();
+				SGE_ProfilerGetPhaseStats(slowest, &stats);
+				snprintf(profilerStr, sizeof(profilerStr), "%s: %.2f ms (p99 %.2f ms)", SGE_ProfilerGetPhaseName(slowest), stats.avg, stats.p99);
+				SGE_TextLabelSetText(profilerLabel, profilerStr);
+			}
 		}
 		sprintf(fpsStr, "fps: %d", countedFPS);
 		SGE_TextLabelSetText(fpsLabel, fpsStr);
@@ -398,7 +424,8 @@ void SGE_GUI_Quit()
 	SGE_printf(SGE_LOG_DEBUG, "\n");
 }
 
-void SGE_GUI_HandleEvents()
+/* Handles the event in engine->event */
+static void SGE_GUI_HandleEvent()
 {
 	if(engine->event.type == SDL_KEYDOWN)
 	{
@@ -432,6 +459,31 @@ void SGE_GUI_HandleEvents()
 	}
 }
 
+/* Handles all events gathered in the current frame */
+void SGE_GUI_HandleEvents()
+{
+	int i = 0;
+	for(i = 0; i < engine->frameEventCount; i++)
+	{
+		/* Skip the event types no GUI control responds to, instead of walking all controls for them */
+		switch(engine->frameEvents[i].type)
+		{
+			case SDL_KEYDOWN:
+			case SDL_TEXTINPUT:
+			case SDL_MOUSEMOTION:
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+			break;
+			
+			default:
+			continue;
+		}
+		
+		engine->event = engine->frameEvents[i];
+		SGE_GUI_HandleEvent();
+	}
+}
+
 void SGE_GUI_Update()
 {
 	SGE_GUI_ControlList_Update(currentStateControls);
@@ -987,28 +1039,28 @@ void SGE_ButtonRender(SGE_Button *button)
 	int i = 0;
 	
 	/* Draw filled button background */
-	SDL_SetRenderDrawColor(engine->renderer, button->currentColor.r, button->currentColor.g, button->currentColor.b, button->alpha);
-	SDL_RenderFillRect(engine->renderer, &button->background);
+	SGE_SetDrawColorRGBA(button->currentColor.r, button->currentColor.g, button->currentColor.b, button->alpha);
+	SGE_DrawFillRect(&button->background);
 	
 	/* Draw button border */
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, button->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, button->alpha);
 	if(SGE_isMouseOver(&button->boundBox))
 	{
 		if(button->parentPanel != NULL)
 		{
 			if(SGE_isMouseOver(&button->parentPanel->background) && !SGE_isMouseOver(&button->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&button->parentPanel->verticalScrollbarBG))
-				SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, button->alpha);
+				SGE_SetDrawColorRGBA(225, 225, 225, button->alpha);
 			
 			for(i = button->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, button->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, button->alpha);
 			}
 		}
 		else
-			SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, button->alpha);
+			SGE_SetDrawColorRGBA(225, 225, 225, button->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &button->background);
+	SGE_DrawRect(&button->background);
 	
 	/* Draw button text image */
 	SGE_SetTextureAlpha(button->textImg, button->alpha);
@@ -1016,8 +1068,8 @@ void SGE_ButtonRender(SGE_Button *button)
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, button->alpha);
-		SDL_RenderDrawRect(engine->renderer, &button->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, button->alpha);
+		SGE_DrawRect(&button->boundBox);
 	}
 }
 
@@ -1227,40 +1279,40 @@ void SGE_CheckBoxRender(SGE_CheckBox *checkBox)
 	int i = 0;
 	
 	/* Draw white checkbox filled background */
-	SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, checkBox->alpha);
-	SDL_RenderFillRect(engine->renderer, &checkBox->bg);
+	SGE_SetDrawColorRGBA(255, 255, 255, checkBox->alpha);
+	SGE_DrawFillRect(&checkBox->bg);
 	
 	/* Draw gray checkbox border */
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, checkBox->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, checkBox->alpha);
 	if(SGE_isMouseOver(&checkBox->boundBox))
 	{
 		if(checkBox->parentPanel != NULL)
 		{
 			if(SGE_isMouseOver(&checkBox->parentPanel->background) && !SGE_isMouseOver(&checkBox->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&checkBox->parentPanel->verticalScrollbarBG))
-				SDL_SetRenderDrawColor(engine->renderer, 150, 150, 150, checkBox->alpha);
+				SGE_SetDrawColorRGBA(150, 150, 150, checkBox->alpha);
 			
 			for(i = checkBox->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, checkBox->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, checkBox->alpha);
 			}
 		}
 		else
-			SDL_SetRenderDrawColor(engine->renderer, 150, 150, 150, checkBox->alpha);
+			SGE_SetDrawColorRGBA(150, 150, 150, checkBox->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &checkBox->bg);
+	SGE_DrawRect(&checkBox->bg);
 	
 	/* Draw the check inside the background */
 	if(checkBox->isChecked == true)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, checkBox->checkColor.r, checkBox->checkColor.g, checkBox->checkColor.b, checkBox->alpha);
-		SDL_RenderFillRect(engine->renderer, &checkBox->check);
+		SGE_SetDrawColorRGBA(checkBox->checkColor.r, checkBox->checkColor.g, checkBox->checkColor.b, checkBox->alpha);
+		SGE_DrawFillRect(&checkBox->check);
 	}
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, checkBox->alpha);
-		SDL_RenderDrawRect(engine->renderer, &checkBox->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, checkBox->alpha);
+		SGE_DrawRect(&checkBox->boundBox);
 	}
 }
 
@@ -1400,16 +1452,16 @@ void SGE_TextLabelRender(SGE_TextLabel *label)
 	
 	if(label->showBG)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, label->bgColor.r, label->bgColor.g, label->bgColor.b, label->bgColor.a);
-		SDL_RenderFillRect(engine->renderer, &label->boundBox);
+		SGE_SetDrawColorRGBA(label->bgColor.r, label->bgColor.g, label->bgColor.b, label->bgColor.a);
+		SGE_DrawFillRect(&label->boundBox);
 	}
 	
 	SGE_RenderTexture(label->textImg);
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, label->alpha);
-		SDL_RenderDrawRect(engine->renderer, &label->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, label->alpha);
+		SGE_DrawRect(&label->boundBox);
 	}
 }
 
@@ -1721,37 +1773,37 @@ void SGE_SliderRender(SGE_Slider *slider)
 {
 	int i = 0;
 	
-	SDL_SetRenderDrawColor(engine->renderer, slider->barColor.r, slider->barColor.g, slider->barColor.b, slider->alpha);
-	SDL_RenderFillRect(engine->renderer, &slider->bar);
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, slider->alpha);
-	SDL_RenderDrawRect(engine->renderer, &slider->bar);
+	SGE_SetDrawColorRGBA(slider->barColor.r, slider->barColor.g, slider->barColor.b, slider->alpha);
+	SGE_DrawFillRect(&slider->bar);
+	SGE_SetDrawColorRGBA(0, 0, 0, slider->alpha);
+	SGE_DrawRect(&slider->bar);
 	
-	SDL_SetRenderDrawColor(engine->renderer, slider->sliderColor.r, slider->sliderColor.g, slider->sliderColor.b, slider->alpha);
-	SDL_RenderFillRect(engine->renderer, &slider->slider);
+	SGE_SetDrawColorRGBA(slider->sliderColor.r, slider->sliderColor.g, slider->sliderColor.b, slider->alpha);
+	SGE_DrawFillRect(&slider->slider);
 	
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, slider->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, slider->alpha);
 	if(SGE_isMouseOver(&slider->slider) || slider->state == SGE_CONTROL_STATE_CLICKED)
 	{
 		if(slider->parentPanel != NULL)
 		{
 			if(SGE_isMouseOver(&slider->parentPanel->background) && !SGE_isMouseOver(&slider->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&slider->parentPanel->verticalScrollbarBG))
-				SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, slider->alpha);
+				SGE_SetDrawColorRGBA(225, 225, 225, slider->alpha);
 			
 			for(i = slider->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, slider->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, slider->alpha);
 			}
 		}
 		else
-			SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, slider->alpha);
+			SGE_SetDrawColorRGBA(225, 225, 225, slider->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &slider->slider);
+	SGE_DrawRect(&slider->slider);
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, slider->alpha);
-		SDL_RenderDrawRect(engine->renderer, &slider->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, slider->alpha);
+		SGE_DrawRect(&slider->boundBox);
 	}
 }
 
@@ -2060,47 +2112,47 @@ void SGE_TextInputBoxRender(SGE_TextInputBox *textInputBox)
 			return;
 	}
 	
-	SDL_SetRenderDrawColor(engine->renderer, 150, 150, 150, textInputBox->alpha);
-	SDL_RenderFillRect(engine->renderer, &textInputBox->inputBox);
+	SGE_SetDrawColorRGBA(150, 150, 150, textInputBox->alpha);
+	SGE_DrawFillRect(&textInputBox->inputBox);
 	
 	if(textInputBox->isEnabled)
 	{
 		if(textInputBox->showCursor)
 		{
-			SDL_SetRenderDrawColor(engine->renderer, 150, 0, 0, textInputBox->alpha);
-			SDL_RenderFillRect(engine->renderer, &textInputBox->cursor);
-			SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, textInputBox->alpha);
-			SDL_RenderDrawRect(engine->renderer, &textInputBox->cursor);
+			SGE_SetDrawColorRGBA(150, 0, 0, textInputBox->alpha);
+			SGE_DrawFillRect(&textInputBox->cursor);
+			SGE_SetDrawColorRGBA(255, 255, 255, textInputBox->alpha);
+			SGE_DrawRect(&textInputBox->cursor);
 		}
 	}
 	
 	SGE_RenderTexture(textInputBox->textImg);
 	
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, textInputBox->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, textInputBox->alpha);
 	if(SGE_isMouseOver(&textInputBox->inputBox))
 	{
 		if(textInputBox->parentPanel != NULL)
 		{
 			if(SGE_isMouseOver(&textInputBox->parentPanel->background) && !SGE_isMouseOver(&textInputBox->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&textInputBox->parentPanel->verticalScrollbarBG))
-				SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, textInputBox->alpha);
+				SGE_SetDrawColorRGBA(255, 255, 255, textInputBox->alpha);
 			
 			int i = 0;
 			for(i = textInputBox->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, textInputBox->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, textInputBox->alpha);
 			}
 		}
 		else
-			SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, textInputBox->alpha);
+			SGE_SetDrawColorRGBA(255, 255, 255, textInputBox->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &textInputBox->inputBox);
+	SGE_DrawRect(&textInputBox->inputBox);
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, textInputBox->alpha);
-		SDL_RenderDrawRect(engine->renderer, &textInputBox->textImg->destRect);
-		SDL_RenderDrawRect(engine->renderer, &textInputBox->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, textInputBox->alpha);
+		SGE_DrawRect(&textInputBox->textImg->destRect);
+		SGE_DrawRect(&textInputBox->boundBox);
 	}
 }
 
@@ -2343,34 +2395,34 @@ void SGE_ListBoxUpdate(SGE_ListBox *listBox)
 
 void SGE_ListBoxRender(SGE_ListBox *listBox)
 {
-	SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, listBox->alpha);
-	SDL_RenderFillRect(engine->renderer, &listBox->selectionBox);
+	SGE_SetDrawColorRGBA(255, 255, 255, listBox->alpha);
+	SGE_DrawFillRect(&listBox->selectionBox);
 	SGE_RenderTexture(listBox->selectionImg);
 	
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, listBox->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, listBox->alpha);
 	if(SGE_isMouseOver(&listBox->selectionBox))
 	{
 		if(listBox->parentPanel != NULL)
 		{
 			if(SGE_isMouseOver(&listBox->parentPanel->background) && !SGE_isMouseOver(&listBox->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&listBox->parentPanel->verticalScrollbarBG))
-				SDL_SetRenderDrawColor(engine->renderer, 150, 150, 150, listBox->alpha);
+				SGE_SetDrawColorRGBA(150, 150, 150, listBox->alpha);
 			
 			int i = 0;
 			for(i = listBox->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, listBox->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, listBox->alpha);
 			}
 		}
 		else
-			SDL_SetRenderDrawColor(engine->renderer, 150, 150, 150, listBox->alpha);
+			SGE_SetDrawColorRGBA(150, 150, 150, listBox->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &listBox->selectionBox);
+	SGE_DrawRect(&listBox->selectionBox);
 	
 	if(showControlBounds)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, listBox->alpha);
-		SDL_RenderDrawRect(engine->renderer, &listBox->boundBox);
+		SGE_SetDrawColorRGBA(controlBoundsColor.r, controlBoundsColor.g, controlBoundsColor.b, listBox->alpha);
+		SGE_DrawRect(&listBox->boundBox);
 	}
 	
 	if(listBox->isOpen)
@@ -2378,30 +2430,30 @@ void SGE_ListBoxRender(SGE_ListBox *listBox)
 		int i = 0;
 		for(i = 0; i < listBox->optionCount; i++)
 		{
-			SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, listBox->alpha);
+			SGE_SetDrawColorRGBA(255, 255, 255, listBox->alpha);
 			if(SGE_isMouseOver(&listBox->optionBoxes[i]))
 			{
 				if(listBox->parentPanel != NULL)
 				{
 					if(SGE_isMouseOver(&listBox->parentPanel->background) && !SGE_isMouseOver(&listBox->parentPanel->horizontalScrollbarBG) && !SGE_isMouseOver(&listBox->parentPanel->verticalScrollbarBG))
-						SDL_SetRenderDrawColor(engine->renderer, 50, 50, 150, listBox->alpha);
+						SGE_SetDrawColorRGBA(50, 50, 150, listBox->alpha);
 					
 					int i = 0;
 					for(i = listBox->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 					{
 						if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-							SDL_SetRenderDrawColor(engine->renderer, 255, 255, listBox->alpha, listBox->alpha);
+							SGE_SetDrawColorRGBA(255, 255, listBox->alpha, listBox->alpha);
 					}
 				}
 				else
-					SDL_SetRenderDrawColor(engine->renderer, 50, 50, 150, listBox->alpha);
+					SGE_SetDrawColorRGBA(50, 50, 150, listBox->alpha);
 			}
 			else
-				SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, listBox->alpha);
-			SDL_RenderFillRect(engine->renderer, &listBox->optionBoxes[i]);
+				SGE_SetDrawColorRGBA(255, 255, 255, listBox->alpha);
+			SGE_DrawFillRect(&listBox->optionBoxes[i]);
 			
-			SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, listBox->alpha);
-			SDL_RenderDrawRect(engine->renderer, &listBox->optionBoxes[i]);
+			SGE_SetDrawColorRGBA(0, 0, 0, listBox->alpha);
+			SGE_DrawRect(&listBox->optionBoxes[i]);
 			SGE_RenderTexture(listBox->optionImages[i]);
 		}
 	}
@@ -2546,26 +2598,26 @@ void SGE_MinimizeButtonRender(SGE_MinimizeButton *minButton)
 {
 	int i = 0;
 	
-	SDL_SetRenderDrawColor(engine->renderer, minButton->currentColor.r, minButton->currentColor.g, minButton->currentColor.b, minButton->parentPanel->alpha);
-	SDL_RenderFillRect(engine->renderer, &minButton->boundBox);
+	SGE_SetDrawColorRGBA(minButton->currentColor.r, minButton->currentColor.g, minButton->currentColor.b, minButton->parentPanel->alpha);
+	SGE_DrawFillRect(&minButton->boundBox);
 	
 	/* Draw button image */
 	SGE_SetTextureAlpha(minButton->buttonImg, minButton->parentPanel->alpha);
 	SGE_RenderTexture(minButton->buttonImg);
 	
 	/* Draw button border */
-	SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, minButton->parentPanel->alpha);
+	SGE_SetDrawColorRGBA(0, 0, 0, minButton->parentPanel->alpha);
 	if(SGE_isMouseOver(&minButton->boundBox))
 	{
-		SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, minButton->parentPanel->alpha);
+		SGE_SetDrawColorRGBA(225, 225, 225, minButton->parentPanel->alpha);
 		
 		for(i = minButton->parentPanel->index + 1; i < currentStateControls->panelCount; i++)
 		{
 			if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-				SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, minButton->parentPanel->alpha);
+				SGE_SetDrawColorRGBA(0, 0, 0, minButton->parentPanel->alpha);
 		}
 	}
-	SDL_RenderDrawRect(engine->renderer, &minButton->boundBox);
+	SGE_DrawRect(&minButton->boundBox);
 }
 
 SGE_WindowPanel *SGE_CreateWindowPanel(const char *title, int x, int y, int w, int h) 
@@ -2722,6 +2774,16 @@ SGE_WindowPanel *SGE_CreateWindowPanel(const char *title, int x, int y, int w, i
 	panel->textInputBoxCount = 0;
 	panel->listBoxCount = 0;
 	
+	panel->isCached = false;
+	panel->cacheTexture = NULL;
+	panel->cacheRect.x = 0;
+	panel->cacheRect.y = 0;
+	panel->cacheRect.w = 0;
+	panel->cacheRect.h = 0;
+	panel->cacheSignature = 0;
+	panel->isCacheValid = false;
+	panel->cacheRedrawCount = 0;
+	
 	return panel;
 }
 
@@ -2731,6 +2793,10 @@ void SGE_DestroyWindowPanel(SGE_WindowPanel *panel)
 	{
 		SGE_DestroyMinimizeButton(panel->minimizeButton);
 		SGE_FreeTexture(panel->titleTextImg);
+		if(panel->cacheTexture != NULL)
+		{
+			SGE_FreeTexture(panel->cacheTexture);
+		}
 		free(panel);
 	}
 }
@@ -3021,29 +3087,44 @@ void SGE_WindowPanelUpdate(SGE_WindowPanel *panel)
 	}
 }
 
-void SGE_WindowPanelRender(SGE_WindowPanel *panel)
+/* Sets the clip rect for a panel's controls, moved into the panel's cache while drawing it */
+static void SGE_GUI_SetClipRect(const SDL_Rect *rect)
+{
+	if(rect != NULL && isDrawingPanelCache)
+	{
+		SDL_Rect cacheRect = *rect;
+		cacheRect.x -= panelCacheOrigin.x;
+		cacheRect.y -= panelCacheOrigin.y;
+		SGE_SetClipRect(&cacheRect);
+		return;
+	}
+	SGE_SetClipRect(rect);
+}
+
+/* Draws a panel and it's controls */
+static void SGE_WindowPanelDraw(SGE_WindowPanel *panel)
 {
 	int i = 0;
 	
 	/* Draw a rect that acts as a border and title bar */
-	SDL_SetRenderDrawBlendMode(engine->renderer, SDL_BLENDMODE_BLEND);
-	SDL_SetRenderDrawColor(engine->renderer, panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
-	SDL_RenderFillRect(engine->renderer, &panel->border);
+	SGE_SetDrawBlendMode(SDL_BLENDMODE_BLEND);
+	SGE_SetDrawColorRGBA(panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
+	SGE_DrawFillRect(&panel->border);
 	
 	/* Draw a white or black border around the panel */
 	if(panel->isActive)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, panel->alpha);
+		SGE_SetDrawColorRGBA(255, 255, 255, panel->alpha);
 	}
 	else
 	{
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
 	}
-	SDL_RenderDrawRect(engine->renderer, &panel->border);
+	SGE_DrawRect(&panel->border);
 	
 	/* Draw the actual background of the panel */
-	SDL_SetRenderDrawColor(engine->renderer, panel->backgroundColor.r, panel->backgroundColor.g, panel->backgroundColor.b, panel->alpha);
-	SDL_RenderFillRect(engine->renderer, &panel->background);
+	SGE_SetDrawColorRGBA(panel->backgroundColor.r, panel->backgroundColor.g, panel->backgroundColor.b, panel->alpha);
+	SGE_DrawFillRect(&panel->background);
 	
 	/* Draw the panel title text */
 	SGE_SetTextureAlpha(panel->titleTextImg, panel->alpha);
@@ -3055,7 +3136,7 @@ void SGE_WindowPanelRender(SGE_WindowPanel *panel)
 	}
 	
 	/* Draw all the child controls */
-	SDL_RenderSetClipRect(engine->renderer, &panel->background);
+	SGE_GUI_SetClipRect(&panel->background);
 	
 	for(i = 0; i < panel->buttonCount; i++)
 	{
@@ -3087,82 +3168,567 @@ void SGE_WindowPanelRender(SGE_WindowPanel *panel)
 		SGE_ListBoxRender(panel->listBoxes[i]);
 	}
 	
-	SDL_RenderSetClipRect(engine->renderer, NULL);
-	SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, 0);
-	SDL_RenderDrawPoint(engine->renderer, 0, 0);
+	SGE_GUI_SetClipRect(NULL);
 	
 	/* Draw Horizontal Scrollbar */
 	if(panel->horizontalScrollbarEnabled)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, panel->alpha);
-		SDL_RenderFillRect(engine->renderer, &panel->horizontalScrollbarBG);
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->horizontalScrollbarBG);
+		SGE_SetDrawColorRGBA(255, 255, 255, panel->alpha);
+		SGE_DrawFillRect(&panel->horizontalScrollbarBG);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
+		SGE_DrawRect(&panel->horizontalScrollbarBG);
 		
-		SDL_SetRenderDrawColor(engine->renderer, panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
-		SDL_RenderFillRect(engine->renderer, &panel->horizontalScrollbar);
+		SGE_SetDrawColorRGBA(panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
+		SGE_DrawFillRect(&panel->horizontalScrollbar);
 		
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
 		if(SGE_isMouseOver(&panel->horizontalScrollbar))
 		{
-			SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, panel->alpha);
+			SGE_SetDrawColorRGBA(225, 225, 225, panel->alpha);
 			
 			for(i = panel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
 			}
 		}
-		SDL_RenderDrawRect(engine->renderer, &panel->horizontalScrollbar);
+		SGE_DrawRect(&panel->horizontalScrollbar);
 	}
 	
 	/* Draw Vertical Scrollbar */
 	if(panel->verticalScrollbarEnabled)
 	{
-		SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, panel->alpha);
-		SDL_RenderFillRect(engine->renderer, &panel->verticalScrollbarBG);
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->verticalScrollbarBG);
+		SGE_SetDrawColorRGBA(255, 255, 255, panel->alpha);
+		SGE_DrawFillRect(&panel->verticalScrollbarBG);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
+		SGE_DrawRect(&panel->verticalScrollbarBG);
 		
-		SDL_SetRenderDrawColor(engine->renderer, panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
-		SDL_RenderFillRect(engine->renderer, &panel->verticalScrollbar);
+		SGE_SetDrawColorRGBA(panel->borderColor.r, panel->borderColor.g, panel->borderColor.b, panel->alpha);
+		SGE_DrawFillRect(&panel->verticalScrollbar);
 		
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
 		if(SGE_isMouseOver(&panel->verticalScrollbar))
 		{
-			SDL_SetRenderDrawColor(engine->renderer, 225, 225, 225, panel->alpha);
+			SGE_SetDrawColorRGBA(225, 225, 225, panel->alpha);
 			
 			for(i = panel->index + 1; i < currentStateControls->panelCount; i++)
 			{
 				if(SGE_isMouseOver(&currentStateControls->panels[i]->border))
-					SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
+					SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
 			}
 		}
-		SDL_RenderDrawRect(engine->renderer, &panel->verticalScrollbar);
+		SGE_DrawRect(&panel->verticalScrollbar);
 	}
 	
 	if(showControlBounds)
 	{
 		/* Draw Resize Control Bars */
-		SDL_SetRenderDrawColor(engine->renderer, 255, 0, 255, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->resizeBar_horizontal);
-		SDL_SetRenderDrawColor(engine->renderer, 0, 255, 0, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->resizeBar_vertical);
+		SGE_SetDrawColorRGBA(255, 0, 255, panel->alpha);
+		SGE_DrawRect(&panel->resizeBar_horizontal);
+		SGE_SetDrawColorRGBA(0, 255, 0, panel->alpha);
+		SGE_DrawRect(&panel->resizeBar_vertical);
 		
 		/* Draw the panel center point */
 		SDL_Rect centerRect = {panel->bgGlobalCenter.x - 2, panel->bgGlobalCenter.y - 2, 4, 4};
-		SDL_SetRenderDrawColor(engine->renderer, 255, 255, 255, panel->alpha);
-		SDL_RenderFillRect(engine->renderer, &centerRect);
-		SDL_SetRenderDrawColor(engine->renderer, 0, 0, 0, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &centerRect);
+		SGE_SetDrawColorRGBA(255, 255, 255, panel->alpha);
+		SGE_DrawFillRect(&centerRect);
+		SGE_SetDrawColorRGBA(0, 0, 0, panel->alpha);
+		SGE_DrawRect(&centerRect);
 		
 		/* Draw panel MCR */
-		SDL_SetRenderDrawColor(engine->renderer, 0, 255, 0, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->masterControlRect);
+		SGE_SetDrawColorRGBA(0, 255, 0, panel->alpha);
+		SGE_DrawRect(&panel->masterControlRect);
 		
 		/* Draw panel boundbox */
-		SDL_SetRenderDrawColor(engine->renderer, 255, 0, 255, panel->alpha);
-		SDL_RenderDrawRect(engine->renderer, &panel->boundBox);
+		SGE_SetDrawColorRGBA(255, 0, 255, panel->alpha);
+		SGE_DrawRect(&panel->boundBox);
+	}
+}
+
+/* FNV-1a hash of some bytes, used to notice changes to anything a cached panel draws */
+static Uint32 SGE_GUI_Hash(Uint32 hash, const void *data, size_t size)
+{
+	const Uint8 *bytes = (const Uint8*)data;
+	size_t i = 0;
+	for(i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+#define SGE_GUI_HASH_VALUE(hash, value) SGE_GUI_Hash((hash), &(value), sizeof(value))
+
+static Uint32 SGE_GUI_HashString(Uint32 hash, const char *str)
+{
+	if(str == NULL)
+	{
+		return hash;
+	}
+	return SGE_GUI_Hash(hash, str, strlen(str));
+}
+
+static Uint32 SGE_GUI_HashTexture(Uint32 hash, SGE_Texture *texture)
+{
+	if(texture == NULL)
+	{
+		return hash;
+	}
+	hash = SGE_GUI_HASH_VALUE(hash, texture->texture);
+	hash = SGE_GUI_HASH_VALUE(hash, texture->x);
+	hash = SGE_GUI_HASH_VALUE(hash, texture->y);
+	hash = SGE_GUI_HASH_VALUE(hash, texture->w);
+	hash = SGE_GUI_HASH_VALUE(hash, texture->h);
+	hash = SGE_GUI_HASH_VALUE(hash, texture->colorMod);
+	return hash;
+}
+
+/* Area of the screen a panel draws into */
+static SDL_Rect SGE_WindowPanelGetCacheRect(SGE_WindowPanel *panel)
+{
+	SDL_Rect area = panel->border;
+	if(panel->horizontalScrollbarEnabled)
+	{
+		SDL_UnionRect(&area, &panel->horizontalScrollbarBG, &area);
+	}
+	if(panel->verticalScrollbarEnabled)
+	{
+		SDL_UnionRect(&area, &panel->verticalScrollbarBG, &area);
+	}
+	return area;
+}
+
+/* Hashes of everything that changes how each control looks */
+static Uint32 SGE_GUI_HashButton(Uint32 hash, SGE_Button *button)
+{
+	hash = SGE_GUI_HASH_VALUE(hash, button->background);
+	hash = SGE_GUI_HASH_VALUE(hash, button->currentColor);
+	hash = SGE_GUI_HASH_VALUE(hash, button->alpha);
+	return SGE_GUI_HashTexture(hash, button->textImg);
+}
+
+static Uint32 SGE_GUI_HashCheckBox(Uint32 hash, SGE_CheckBox *checkBox)
+{
+	hash = SGE_GUI_HASH_VALUE(hash, checkBox->bg);
+	hash = SGE_GUI_HASH_VALUE(hash, checkBox->check);
+	hash = SGE_GUI_HASH_VALUE(hash, checkBox->checkColor);
+	hash = SGE_GUI_HASH_VALUE(hash, checkBox->isChecked);
+	return SGE_GUI_HASH_VALUE(hash, checkBox->alpha);
+}
+
+/*
+ * Labels in panels are placed while they are drawn, so only their own position is hashed,
+ * along with everything their text image is rendered and drawn with.
+ */
+static Uint32 SGE_GUI_HashTextLabel(Uint32 hash, SGE_TextLabel *label)
+{
+	hash = SGE_GUI_HASH_VALUE(hash, label->isVisible);
+	hash = SGE_GUI_HASH_VALUE(hash, label->x);
+	hash = SGE_GUI_HASH_VALUE(hash, label->y);
+	hash = SGE_GUI_HASH_VALUE(hash, label->showBG);
+	hash = SGE_GUI_HASH_VALUE(hash, label->bgColor);
+	hash = SGE_GUI_HASH_VALUE(hash, label->fgColor);
+	hash = SGE_GUI_HASH_VALUE(hash, label->mode);
+	hash = SGE_GUI_HASH_VALUE(hash, label->font);
+	hash = SGE_GUI_HashString(hash, label->text);
+	hash = SGE_GUI_HASH_VALUE(hash, label->textImg->texture);
+	hash = SGE_GUI_HASH_VALUE(hash, label->textImg->w);
+	hash = SGE_GUI_HASH_VALUE(hash, label->textImg->h);
+	hash = SGE_GUI_HASH_VALUE(hash, label->textImg->colorMod);
+	return SGE_GUI_HASH_VALUE(hash, label->textImg->blendMode);
+}
+
+static Uint32 SGE_GUI_HashSlider(Uint32 hash, SGE_Slider *slider)
+{
+	hash = SGE_GUI_HASH_VALUE(hash, slider->bar);
+	hash = SGE_GUI_HASH_VALUE(hash, slider->barColor);
+	hash = SGE_GUI_HASH_VALUE(hash, slider->slider);
+	hash = SGE_GUI_HASH_VALUE(hash, slider->sliderColor);
+	hash = SGE_GUI_HASH_VALUE(hash, slider->state);
+	return SGE_GUI_HASH_VALUE(hash, slider->alpha);
+}
+
+static Uint32 SGE_GUI_HashTextInputBox(Uint32 hash, SGE_TextInputBox *textInputBox)
+{
+	hash = SGE_GUI_HASH_VALUE(hash, textInputBox->inputBox);
+	hash = SGE_GUI_HASH_VALUE(hash, textInputBox->cursor);
+	hash = SGE_GUI_HASH_VALUE(hash, textInputBox->isEnabled);
+	hash = SGE_GUI_HASH_VALUE(hash, textInputBox->showCursor);
+	hash = SGE_GUI_HASH_VALUE(hash, textInputBox->alpha);
+	hash = SGE_GUI_HashString(hash, textInputBox->text);
+	return SGE_GUI_HashTexture(hash, textInputBox->textImg);
+}
+
+static Uint32 SGE_GUI_HashListBox(Uint32 hash, SGE_ListBox *listBox)
+{
+	int i = 0;
+	hash = SGE_GUI_HASH_VALUE(hash, listBox->selectionBox);
+	hash = SGE_GUI_HASH_VALUE(hash, listBox->selection);
+	hash = SGE_GUI_HASH_VALUE(hash, listBox->isOpen);
+	hash = SGE_GUI_HASH_VALUE(hash, listBox->alpha);
+	hash = SGE_GUI_HashTexture(hash, listBox->selectionImg);
+	for(i = 0; i < listBox->optionCount; i++)
+	{
+		hash = SGE_GUI_HASH_VALUE(hash, listBox->optionBoxes[i]);
+		hash = SGE_GUI_HashTexture(hash, listBox->optionImages[i]);
+	}
+	return hash;
+}
+
+/* Hashes everything that changes how a panel looks */
+static Uint32 SGE_WindowPanelGetSignature(SGE_WindowPanel *panel, const SDL_Rect *area)
+{
+	Uint32 hash = 2166136261u;
+	int i = 0;
+	
+	hash = SGE_GUI_HASH_VALUE(hash, panel->alpha);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->border);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->background);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->backgroundColor);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->borderColor);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->isActive);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->isMinimizable);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->isMinimized);
+	hash = SGE_GUI_HashTexture(hash, panel->titleTextImg);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->minimizeButton->boundBox);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->minimizeButton->currentColor);
+	hash = SGE_GUI_HashTexture(hash, panel->minimizeButton->buttonImg);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->horizontalScrollbarEnabled);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->horizontalScrollbar);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->horizontalScrollbarBG);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->verticalScrollbarEnabled);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->verticalScrollbar);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->verticalScrollbarBG);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->x_scroll_offset);
+	hash = SGE_GUI_HASH_VALUE(hash, panel->y_scroll_offset);
+	
+	/* Hover highlights depend on the mouse and on the panels above this one */
+	SDL_Point mouse = {engine->mouse_x, engine->mouse_y};
+	if(SDL_PointInRect(&mouse, area))
+	{
+		hash = SGE_GUI_HASH_VALUE(hash, mouse);
+	}
+	for(i = panel->index + 1; i < currentStateControls->panelCount; i++)
+	{
+		hash = SGE_GUI_HASH_VALUE(hash, currentStateControls->panels[i]->border);
+	}
+	
+	for(i = 0; i < panel->buttonCount; i++)
+	{
+		hash = SGE_GUI_HashButton(hash, panel->buttons[i]);
+	}
+	for(i = 0; i < panel->checkBoxCount; i++)
+	{
+		hash = SGE_GUI_HashCheckBox(hash, panel->checkBoxes[i]);
+	}
+	for(i = 0; i < panel->textLabelCount; i++)
+	{
+		hash = SGE_GUI_HashTextLabel(hash, panel->textLabels[i]);
+	}
+	for(i = 0; i < panel->sliderCount; i++)
+	{
+		hash = SGE_GUI_HashSlider(hash, panel->sliders[i]);
+	}
+	for(i = 0; i < panel->textInputBoxCount; i++)
+	{
+		hash = SGE_GUI_HashTextInputBox(hash, panel->textInputBoxes[i]);
+	}
+	for(i = 0; i < panel->listBoxCount; i++)
+	{
+		hash = SGE_GUI_HashListBox(hash, panel->listBoxes[i]);
+	}
+	
+	return hash;
+}
+
+/* Draws a panel into it's cache texture, with the cache's top left corner at the panel's */
+static bool SGE_WindowPanelDrawCache(SGE_WindowPanel *panel, const SDL_Rect *area)
+{
+	SDL_Texture *previousTarget = engine->renderTarget;
+	SGE_SetRenderTarget(panel->cacheTexture->texture);
+	if(engine->renderTarget != panel->cacheTexture->texture)
+	{
+		return false;
+	}
+	
+	if(!SGE_SetPremultipliedDrawing(true))
+	{
+		SGE_SetRenderTarget(previousTarget);
+		return false;
+	}
+	
+	SGE_SetClipRect(NULL);
+	SGE_ClearScreenRGBA(0, 0, 0, 0);
+	
+	/* A camera moves everything the panel draws into the cache */
+	SGE_Camera cacheCamera;
+	cacheCamera.x = area->x + area->w / 2.0f;
+	cacheCamera.y = area->y + area->h / 2.0f;
+	cacheCamera.zoom = 1.0f;
+	cacheCamera.rotation = 0;
+	cacheCamera.viewport.x = 0;
+	cacheCamera.viewport.y = 0;
+	cacheCamera.viewport.w = area->w;
+	cacheCamera.viewport.h = area->h;
+	cacheCamera.culledCount = 0;
+	
+	SGE_Camera *previousCamera = SGE_GetCamera();
+	SGE_SetCamera(&cacheCamera);
+	isDrawingPanelCache = true;
+	panelCacheOrigin.x = area->x;
+	panelCacheOrigin.y = area->y;
+	
+	SGE_WindowPanelDraw(panel);
+	
+	isDrawingPanelCache = false;
+	SGE_SetPremultipliedDrawing(false);
+	SGE_SetCamera(previousCamera);
+	SGE_SetRenderTarget(previousTarget);
+	return true;
+}
+
+/* Shows a panel from it's cache, drawing it again first if it changed. Returns false if it can't be cached */
+static bool SGE_WindowPanelRenderCached(SGE_WindowPanel *panel)
+{
+	SDL_Rect area = SGE_WindowPanelGetCacheRect(panel);
+	if(area.w <= 0 || area.h <= 0)
+	{
+		return false;
+	}
+	
+	SDL_BlendMode compositeMode = SGE_GetPremultipliedBlendMode();
+	if(compositeMode == SDL_BLENDMODE_INVALID || !SDL_RenderTargetSupported(engine->renderer))
+	{
+		SGE_GUI_LogPrintLine(SGE_LOG_WARNING, "Renderer can't cache panel %s, drawing it directly.", panel->titleStr);
+		panel->isCached = false;
+		return false;
+	}
+	
+	/* The cache grows to fit the panel, and is kept when the panel gets smaller */
+	if(panel->cacheTexture != NULL && (panel->cacheTexture->original_w < area.w || panel->cacheTexture->original_h < area.h))
+	{
+		SGE_FreeTexture(panel->cacheTexture);
+		panel->cacheTexture = NULL;
+	}
+	if(panel->cacheTexture == NULL)
+	{
+		panel->cacheTexture = SGE_CreateTargetTexture(area.w, area.h);
+		if(panel->cacheTexture == NULL || SDL_SetTextureBlendMode(panel->cacheTexture->texture, compositeMode) != 0)
+		{
+			SGE_GUI_LogPrintLine(SGE_LOG_WARNING, "Renderer can't cache panel %s, drawing it directly.", panel->titleStr);
+			panel->isCached = false;
+			return false;
+		}
+		/* Set on the SDL_Texture above to find out if the renderer supports it */
+		panel->cacheTexture->blendMode = compositeMode;
+		panel->isCacheValid = false;
+	}
+	
+	/* Targets come back empty after the renderer lost them */
+	if(panel->cacheTexture->isStale)
+	{
+		if(!SGE_RestoreTexture(panel->cacheTexture))
+		{
+			panel->isCached = false;
+			return false;
+		}
+		panel->isCacheValid = false;
+	}
+	
+	Uint32 signature = SGE_WindowPanelGetSignature(panel, &area);
+	if(!panel->isCacheValid || signature != panel->cacheSignature || !SDL_RectEquals(&area, &panel->cacheRect))
+	{
+		if(!SGE_WindowPanelDrawCache(panel, &area))
+		{
+			panel->isCached = false;
+			return false;
+		}
+		panel->cacheSignature = signature;
+		panel->cacheRect = area;
+		panel->isCacheValid = true;
+		panel->cacheRedrawCount++;
+	}
+	
+	/* A clean panel is a single textured quad */
+	panel->cacheTexture->x = area.x;
+	panel->cacheTexture->y = area.y;
+	panel->cacheTexture->w = area.w;
+	panel->cacheTexture->h = area.h;
+	panel->cacheTexture->clipRect.x = 0;
+	panel->cacheTexture->clipRect.y = 0;
+	panel->cacheTexture->clipRect.w = area.w;
+	panel->cacheTexture->clipRect.h = area.h;
+	SGE_RenderTexture(panel->cacheTexture);
+	return true;
+}
+
+void SGE_WindowPanelRender(SGE_WindowPanel *panel)
+{
+	/* Control bounds follow the mouse, so they are always drawn directly */
+	if(panel->isCached && !showControlBounds && SGE_WindowPanelRenderCached(panel))
+	{
+		return;
+	}
+	SGE_WindowPanelDraw(panel);
+}
+
+void SGE_WindowPanelSetCached(SGE_WindowPanel *panel, bool cached)
+{
+	panel->isCached = cached;
+	panel->isCacheValid = false;
+	if(!cached && panel->cacheTexture != NULL)
+	{
+		SGE_FreeTexture(panel->cacheTexture);
+		panel->cacheTexture = NULL;
+	}
+}
+
+void SGE_WindowPanelInvalidateCache(SGE_WindowPanel *panel)
+{
+	panel->isCacheValid = false;
+}
+
+/* Screen area and hash of a panel or parentless control, compared between frames in dirty rect mode */
+typedef struct
+{
+	SDL_Rect area;
+	Uint32 signature;
+} SGE_GUI_DirtyRecord;
+
+#define SGE_GUI_MAX_DIRTY_RECORDS (2 * (STATE_MAX_PANELS + STATE_MAX_BUTTONS + STATE_MAX_CHECKBOXES + STATE_MAX_LABELS + STATE_MAX_SLIDERS + STATE_MAX_TEXT_INPUT_BOXES + STATE_MAX_LISTBOXES))
+
+static SGE_GUI_DirtyRecord dirtyRecordBuffers[2][SGE_GUI_MAX_DIRTY_RECORDS];
+static SGE_GUI_DirtyRecord *dirtyRecords = dirtyRecordBuffers[0];
+static SGE_GUI_DirtyRecord *lastDirtyRecords = dirtyRecordBuffers[1];
+static int dirtyRecordCount = 0;
+static int lastDirtyRecordCount = 0;
+static bool lastShowControlBounds = false;
+
+/* Records a control, the mouse is part of it's hash while it is over the control because of hover highlights */
+static void SGE_GUI_AddDirtyRecord(const SDL_Rect *area, Uint32 signature)
+{
+	SDL_Point mouse = {engine->mouse_x, engine->mouse_y};
+	if(SDL_PointInRect(&mouse, area))
+	{
+		signature = SGE_GUI_HASH_VALUE(signature, mouse);
+	}
+	dirtyRecords[dirtyRecordCount].area = *area;
+	dirtyRecords[dirtyRecordCount].signature = signature;
+	dirtyRecordCount++;
+}
+
+static void SGE_GUI_AddControlListDirtyRecords(SGE_GUI_ControlList *controls)
+{
+	int i = 0;
+	int j = 0;
+	SDL_Rect area;
+	
+	for(i = 0; i < controls->panelCount; i++)
+	{
+		SGE_WindowPanel *panel = controls->panels[i];
+		area = SGE_WindowPanelGetCacheRect(panel);
+		SGE_GUI_AddDirtyRecord(&area, panel->isVisible ? SGE_WindowPanelGetSignature(panel, &area) : 0);
+	}
+	
+	for(i = 0; i < controls->buttonCount; i++)
+	{
+		SGE_Button *button = controls->buttons[i];
+		SDL_UnionRect(&button->boundBox, &button->background, &area);
+		SGE_GUI_AddDirtyRecord(&area, SGE_GUI_HashButton(2166136261u, button));
+	}
+	
+	for(i = 0; i < controls->checkBoxCount; i++)
+	{
+		SGE_CheckBox *checkBox = controls->checkBoxes[i];
+		SDL_UnionRect(&checkBox->boundBox, &checkBox->bg, &area);
+		SGE_GUI_AddDirtyRecord(&area, SGE_GUI_HashCheckBox(2166136261u, checkBox));
+	}
+	
+	for(i = 0; i < controls->labelCount; i++)
+	{
+		SGE_TextLabel *label = controls->labels[i];
+		SGE_GUI_AddDirtyRecord(&label->boundBox, SGE_GUI_HashTextLabel(2166136261u, label));
+	}
+	
+	for(i = 0; i < controls->sliderCount; i++)
+	{
+		SGE_Slider *slider = controls->sliders[i];
+		SDL_UnionRect(&slider->boundBox, &slider->bar, &area);
+		SDL_UnionRect(&area, &slider->slider, &area);
+		SGE_GUI_AddDirtyRecord(&area, SGE_GUI_HashSlider(2166136261u, slider));
+	}
+	
+	for(i = 0; i < controls->textInputBoxCount; i++)
+	{
+		SGE_TextInputBox *textInputBox = controls->textInputBoxes[i];
+		SDL_UnionRect(&textInputBox->boundBox, &textInputBox->inputBox, &area);
+		SGE_GUI_AddDirtyRecord(&area, SGE_GUI_HashTextInputBox(2166136261u, textInputBox));
+	}
+	
+	for(i = 0; i < controls->listBoxCount; i++)
+	{
+		SGE_ListBox *listBox = controls->listBoxes[i];
+		SDL_UnionRect(&listBox->boundBox, &listBox->selectionBox, &area);
+		if(listBox->isOpen)
+		{
+			for(j = 0; j < listBox->optionCount; j++)
+			{
+				SDL_UnionRect(&area, &listBox->optionBoxes[j], &area);
+			}
+		}
+		SGE_GUI_AddDirtyRecord(&area, SGE_GUI_HashListBox(2166136261u, listBox));
+	}
+}
+
+/* Compares every panel and parentless control with the last call, changed ones are dirty where they were and where they are */
+void SGE_GUI_AddDirtyRects()
+{
+	int i = 0;
+	
+	SGE_GUI_DirtyRecord *records = lastDirtyRecords;
+	lastDirtyRecords = dirtyRecords;
+	lastDirtyRecordCount = dirtyRecordCount;
+	dirtyRecords = records;
+	dirtyRecordCount = 0;
+	
+	SGE_GUI_AddControlListDirtyRecords(currentStateControls);
+	if(showDebugState)
+	{
+		SGE_GUI_ControlList *tempCurrentStateControls = currentStateControls;
+		currentStateControls = &debugStateControls;
+		SGE_GUI_AddControlListDirtyRecords(&debugStateControls);
+		currentStateControls = tempCurrentStateControls;
+	}
+	
+	/* Bound boxes are drawn over everything, redraw it all while they are shown */
+	if(showControlBounds || showControlBounds != lastShowControlBounds)
+	{
+		lastShowControlBounds = showControlBounds;
+		SGE_InvalidateScreen();
+		return;
+	}
+	
+	if(dirtyRecordCount != lastDirtyRecordCount)
+	{
+		for(i = 0; i < lastDirtyRecordCount; i++)
+		{
+			SGE_AddDirtyRect(&lastDirtyRecords[i].area);
+		}
+		for(i = 0; i < dirtyRecordCount; i++)
+		{
+			SGE_AddDirtyRect(&dirtyRecords[i].area);
+		}
+		return;
+	}
+	
+	for(i = 0; i < dirtyRecordCount; i++)
+	{
+		if(dirtyRecords[i].signature != lastDirtyRecords[i].signature || !SDL_RectEquals(&dirtyRecords[i].area, &lastDirtyRecords[i].area))
+		{
+			SGE_AddDirtyRect(&lastDirtyRecords[i].area);
+			SGE_AddDirtyRect(&dirtyRecords[i].area);
+		}
 	}
 }
 
@@ -2,6 +2,7 @@
 #include "SGE_GameState.h"
 #include "SGE_Logger.h"
 #include "SGE_GUI.h"
+#include "SGE_AssetCache.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -112,6 +113,11 @@ void SGE_SetStateFunctions(SGE_GameState *state, const char *name, bool (*init)(
 	state->render = (render == NULL) ? SGE_FallbackRender : render;
 }
 
+bool SGE_StateHandlesEvents(SGE_GameState *state)
+{
+	return state->handleEvents != SGE_FallbackHandleEvents;
+}
+
 void SGE_SwitchToState(const char *nextStateName, bool quitCurrent)
 {
 	SGE_GameState *nextState = SGE_GetState(nextStateName);
@@ -131,6 +137,8 @@ void SGE_SwitchStates()
 		return;
 	}
 
+	/* Assets released by the old state stay cached until the next state acquired what it needs */
+	SGE_AssetCacheBeginStateSwitch();
 	if(switchQuitCurrent)
 	{
 		SGE_QuitState(SGE_GetCurrentState());
@@ -138,11 +146,13 @@ void SGE_SwitchStates()
 	
 	SGE_SetStateFunctions(SGE_GetCurrentState(), nextSwitchState->name, nextSwitchState->init, nextSwitchState->quit, nextSwitchState->handleEvents, nextSwitchState->update, nextSwitchState->render);
 	SGE_GUI_UpdateCurrentState(nextSwitchState->name);
+	SGE_InvalidateScreen();
 
 	if(!SGE_StateIsLoaded(SGE_GetCurrentState()->name))
 	{
 		SGE_InitState(SGE_GetCurrentState());
 	}
+	SGE_AssetCacheEndStateSwitch();
 
 	nextSwitchState = NULL;
 }
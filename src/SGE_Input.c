@@ -0,0 +1,173 @@
+#include "SGE_Input.h"
+#include "SGE.h"
+
+#include <string.h>
+
+static SGE_InputState input;
+
+#define SGE_INPUT_BIT_SET(bits, index)   ((bits)[(index) >> 5] |= (1u << ((index) & 31)))
+#define SGE_INPUT_BIT_CLEAR(bits, index) ((bits)[(index) >> 5] &= ~(1u << ((index) & 31)))
+#define SGE_INPUT_BIT_TEST(bits, index)  (((bits)[(index) >> 5] >> ((index) & 31)) & 1u)
+
+/* Returns a key's bit, false for scancodes outside the bitsets */
+static bool SGE_InputTestKey(const Uint32 *bits, SDL_Scancode scancode)
+{
+	if((unsigned int)scancode >= SDL_NUM_SCANCODES)
+	{
+		return false;
+	}
+	return SGE_INPUT_BIT_TEST(bits, scancode);
+}
+
+void SGE_InputUpdate()
+{
+	SGE_EngineData *engine = SGE_GetEngineData();
+	int i = 0;
+	
+	memcpy(input.prevKeys, input.keys, sizeof(input.keys));
+	input.prevMouseButtons = input.mouseButtons;
+	
+	/* Only start new edges once the last ones had a chance to be seen by update() */
+	if(engine->lastUpdateCount > 0)
+	{
+		SGE_InputClearEdges();
+	}
+	
+	for(i = 0; i < engine->frameEventCount; i++)
+	{
+		SDL_Event *event = &engine->frameEvents[i];
+		switch(event->type)
+		{
+			case SDL_WINDOWEVENT:
+			/* Keys released while another window has focus never send a key up */
+			if(event->window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+			{
+				SGE_InputReset();
+			}
+			break;
+			
+			case SDL_KEYDOWN:
+			if(!event->key.repeat && (unsigned int)event->key.keysym.scancode < SDL_NUM_SCANCODES)
+			{
+				SGE_INPUT_BIT_SET(input.keys, event->key.keysym.scancode);
+				SGE_INPUT_BIT_SET(input.pressedKeys, event->key.keysym.scancode);
+			}
+			break;
+			
+			case SDL_KEYUP:
+			if((unsigned int)event->key.keysym.scancode < SDL_NUM_SCANCODES)
+			{
+				SGE_INPUT_BIT_CLEAR(input.keys, event->key.keysym.scancode);
+				SGE_INPUT_BIT_SET(input.releasedKeys, event->key.keysym.scancode);
+			}
+			break;
+			
+			case SDL_MOUSEBUTTONDOWN:
+			input.mouseButtons |= SDL_BUTTON(event->button.button);
+			input.pressedMouseButtons |= SDL_BUTTON(event->button.button);
+			break;
+			
+			case SDL_MOUSEBUTTONUP:
+			input.mouseButtons &= ~SDL_BUTTON(event->button.button);
+			input.releasedMouseButtons |= SDL_BUTTON(event->button.button);
+			break;
+			
+			case SDL_MOUSEMOTION:
+			input.mouseDeltaX += event->motion.xrel;
+			input.mouseDeltaY += event->motion.yrel;
+			break;
+			
+			case SDL_MOUSEWHEEL:
+			if(event->wheel.direction == SDL_MOUSEWHEEL_FLIPPED)
+			{
+				input.wheelX -= event->wheel.x;
+				input.wheelY -= event->wheel.y;
+			}
+			else
+			{
+				input.wheelX += event->wheel.x;
+				input.wheelY += event->wheel.y;
+			}
+			break;
+		}
+	}
+	
+	input.mouseX = engine->mouse_x;
+	input.mouseY = engine->mouse_y;
+}
+
+void SGE_InputClearEdges()
+{
+	memset(input.pressedKeys, 0, sizeof(input.pressedKeys));
+	memset(input.releasedKeys, 0, sizeof(input.releasedKeys));
+	input.pressedMouseButtons = 0;
+	input.releasedMouseButtons = 0;
+	input.mouseDeltaX = 0;
+	input.mouseDeltaY = 0;
+	input.wheelX = 0;
+	input.wheelY = 0;
+}
+
+void SGE_InputReset()
+{
+	memset(&input, 0, sizeof(input));
+}
+
+const SGE_InputState *SGE_GetInput()
+{
+	return &input;
+}
+
+bool SGE_InputKeyDown(SDL_Scancode scancode)
+{
+	return SGE_InputTestKey(input.keys, scancode);
+}
+
+bool SGE_InputKeyWasPressed(SDL_Scancode scancode)
+{
+	return SGE_InputTestKey(input.pressedKeys, scancode);
+}
+
+bool SGE_InputKeyWasReleased(SDL_Scancode scancode)
+{
+	return SGE_InputTestKey(input.releasedKeys, scancode);
+}
+
+bool SGE_InputMouseDown(int button)
+{
+	return (input.mouseButtons & SDL_BUTTON(button)) != 0;
+}
+
+bool SGE_InputMouseWasPressed(int button)
+{
+	return (input.pressedMouseButtons & SDL_BUTTON(button)) != 0;
+}
+
+bool SGE_InputMouseWasReleased(int button)
+{
+	return (input.releasedMouseButtons & SDL_BUTTON(button)) != 0;
+}
+
+void SGE_InputGetMouseDelta(int *dx, int *dy)
+{
+	if(dx != NULL)
+	{
+		*dx = input.mouseDeltaX;
+	}
+	if(dy != NULL)
+	{
+		*dy = input.mouseDeltaY;
+	}
+}
+
+void SGE_InputGetWheel(int *x, int *y)
+{
+	if(x != NULL)
+	{
+		*x = input.wheelX;
+	}
+	if(y != NULL)
+	{
+		*y = input.wheelY;
+	}
+}
@@ -0,0 +1,698 @@
+#include "SGE_ParticleSystem.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+#include "SGE_PrimitiveBatch.h"
+#include "SGE_Camera.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SGE_PARTICLE_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define SGE_PARTICLE_NEON
+	#include <arm_neon.h>
+#endif
+
+/* Values shared by every particle of an emitter during one update */
+typedef struct
+{
+	float delta;
+	float gravityX, gravityY;
+	float damping;
+} SGE_ParticleStep;
+
+/* Applies gravity and drag to the velocities, then moves and ages the particles */
+typedef void (*SGE_ParticleIntegrateKernel)(const SGE_ParticleStep *step, float *x, float *y, float *vx, float *vy, float *age, int count);
+
+/* Sets bit i of "deadMask" for every particle i that outlived it's lifetime, "deadMask" is cleared by the caller */
+typedef void (*SGE_ParticleKillKernel)(const float *age, const float *lifetime, int count, Uint32 *deadMask);
+
+static SGE_ParticleIntegrateKernel integrateKernel = NULL;
+static SGE_ParticleKillKernel killKernel = NULL;
+static const char *particleKernelName = "Scalar";
+
+static void SGE_IntegrateParticlesScalarRange(const SGE_ParticleStep *step, float *x, float *y, float *vx, float *vy, float *age, int start, int count)
+{
+	int i = 0;
+	for(i = start; i < count; i++)
+	{
+		vx[i] = (vx[i] + step->gravityX * step->delta) * step->damping;
+		vy[i] = (vy[i] + step->gravityY * step->delta) * step->damping;
+		x[i] += vx[i] * step->delta;
+		y[i] += vy[i] * step->delta;
+		age[i] += step->delta;
+	}
+}
+
+static void SGE_IntegrateParticlesScalar(const SGE_ParticleStep *step, float *x, float *y, float *vx, float *vy, float *age, int count)
+{
+	SGE_IntegrateParticlesScalarRange(step, x, y, vx, vy, age, 0, count);
+}
+
+/* Branch free so compilers without intrinsics can still vectorize it */
+static void SGE_KillParticlesScalarRange(const float *age, const float *lifetime, int start, int count, Uint32 *deadMask)
+{
+	int i = 0;
+	for(i = start; i < count; i++)
+	{
+		Uint32 dead = (age[i] >= lifetime[i]);
+		deadMask[i >> 5] |= dead << (i & 31);
+	}
+}
+
+static void SGE_KillParticlesScalar(const float *age, const float *lifetime, int count, Uint32 *deadMask)
+{
+	SGE_KillParticlesScalarRange(age, lifetime, 0, count, deadMask);
+}
+
+#ifdef SGE_PARTICLE_SSE2
+static void SGE_IntegrateParticlesSSE2(const SGE_ParticleStep *step, float *x, float *y, float *vx, float *vy, float *age, int count)
+{
+	__m128 delta = _mm_set1_ps(step->delta);
+	__m128 pullX = _mm_set1_ps(step->gravityX * step->delta);
+	__m128 pullY = _mm_set1_ps(step->gravityY * step->delta);
+	__m128 damping = _mm_set1_ps(step->damping);
+
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		__m128 velX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), pullX), damping);
+		__m128 velY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), pullY), damping);
+		_mm_storeu_ps(vx + i, velX);
+		_mm_storeu_ps(vy + i, velY);
+		_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velX, delta)));
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velY, delta)));
+		_mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), delta));
+	}
+	SGE_IntegrateParticlesScalarRange(step, x, y, vx, vy, age, i, count);
+}
+
+static void SGE_KillParticlesSSE2(const float *age, const float *lifetime, int count, Uint32 *deadMask)
+{
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		__m128 dead = _mm_cmpge_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(lifetime + i));
+		deadMask[i >> 5] |= (Uint32)_mm_movemask_ps(dead) << (i & 31);
+	}
+	SGE_KillParticlesScalarRange(age, lifetime, i, count, deadMask);
+}
+#endif
+
+#ifdef SGE_PARTICLE_NEON
+static void SGE_IntegrateParticlesNEON(const SGE_ParticleStep *step, float *x, float *y, float *vx, float *vy, float *age, int count)
+{
+	float32x4_t delta = vdupq_n_f32(step->delta);
+	float32x4_t pullX = vdupq_n_f32(step->gravityX * step->delta);
+	float32x4_t pullY = vdupq_n_f32(step->gravityY * step->delta);
+	float32x4_t damping = vdupq_n_f32(step->damping);
+
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		float32x4_t velX = vmulq_f32(vaddq_f32(vld1q_f32(vx + i), pullX), damping);
+		float32x4_t velY = vmulq_f32(vaddq_f32(vld1q_f32(vy + i), pullY), damping);
+		vst1q_f32(vx + i, velX);
+		vst1q_f32(vy + i, velY);
+		vst1q_f32(x + i, vmlaq_f32(vld1q_f32(x + i), velX, delta));
+		vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), velY, delta));
+		vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), delta));
+	}
+	SGE_IntegrateParticlesScalarRange(step, x, y, vx, vy, age, i, count);
+}
+
+static void SGE_KillParticlesNEON(const float *age, const float *lifetime, int count, Uint32 *deadMask)
+{
+	const uint32_t laneBits[4] = {1, 2, 4, 8};
+	uint32x4_t lanes = vld1q_u32(laneBits);
+
+	int i = 0;
+	for(i = 0; i + 4 <= count; i += 4)
+	{
+		uint32x4_t dead = vcgeq_f32(vld1q_f32(age + i), vld1q_f32(lifetime + i));
+
+		/* No movemask on NEON, add up one bit per lane instead */
+		uint32x4_t bits = vandq_u32(dead, lanes);
+		uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+		sum = vpadd_u32(sum, sum);
+		deadMask[i >> 5] |= vget_lane_u32(sum, 0) << (i & 31);
+	}
+	SGE_KillParticlesScalarRange(age, lifetime, i, count, deadMask);
+}
+#endif
+
+/* Picks the fastest kernels the CPU supports */
+static void SGE_SelectParticleKernels()
+{
+	integrateKernel = SGE_IntegrateParticlesScalar;
+	killKernel = SGE_KillParticlesScalar;
+	particleKernelName = "Scalar";
+
+#ifdef SGE_PARTICLE_SSE2
+	if(SDL_HasSSE2())
+	{
+		integrateKernel = SGE_IntegrateParticlesSSE2;
+		killKernel = SGE_KillParticlesSSE2;
+		particleKernelName = "SSE2";
+	}
+#endif
+
+#if defined(SGE_PARTICLE_NEON) && SDL_VERSION_ATLEAST(2, 0, 6)
+	if(SDL_HasNEON())
+	{
+		integrateKernel = SGE_IntegrateParticlesNEON;
+		killKernel = SGE_KillParticlesNEON;
+		particleKernelName = "NEON";
+	}
+#endif
+
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Using %s particle kernels.", particleKernelName);
+}
+
+const char *SGE_GetParticleKernelName()
+{
+	if(integrateKernel == NULL)
+	{
+		SGE_SelectParticleKernels();
+	}
+	return particleKernelName;
+}
+
+SGE_ParticleSystem *SGE_CreateParticleSystem()
+{
+	SGE_ParticleSystem *system = (SGE_ParticleSystem*)malloc(sizeof(SGE_ParticleSystem));
+	if(system == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for particle system!");
+		return NULL;
+	}
+	system->emitters = NULL;
+	system->emitterCount = 0;
+	system->emitterCapacity = 0;
+	system->randomState = SDL_GetTicks() | 1;
+	system->liveCount = 0;
+	system->lastDrawCalls = 0;
+	return system;
+}
+
+static void SGE_FreeParticleEmitter(SGE_ParticleEmitter *emitter)
+{
+	free(emitter->posX);
+	free(emitter->posY);
+	free(emitter->velX);
+	free(emitter->velY);
+	free(emitter->age);
+	free(emitter->lifetime);
+	free(emitter->colors);
+	free(emitter->deadMask);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	free(emitter->vertices);
+	free(emitter->indices);
+#endif
+	free(emitter);
+}
+
+void SGE_FreeParticleSystem(SGE_ParticleSystem *system)
+{
+	if(system == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL particle system!");
+		return;
+	}
+
+	int i = 0;
+	for(i = 0; i < system->emitterCount; i++)
+	{
+		SGE_FreeParticleEmitter(system->emitters[i]);
+	}
+	free(system->emitters);
+	free(system);
+}
+
+SGE_ParticleEmitter *SGE_ParticleSystemAddEmitter(SGE_ParticleSystem *system, int maxParticles)
+{
+	if(maxParticles <= 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Particle emitter needs room for at least one particle!");
+		return NULL;
+	}
+
+	if(system->emitterCount == system->emitterCapacity)
+	{
+		int capacity = (system->emitterCapacity > 0) ? system->emitterCapacity * 2 : 4;
+		SGE_ParticleEmitter **emitters = (SGE_ParticleEmitter**)realloc(system->emitters, capacity * sizeof(SGE_ParticleEmitter*));
+		if(emitters == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow particle system!");
+			return NULL;
+		}
+		system->emitters = emitters;
+		system->emitterCapacity = capacity;
+	}
+
+	SGE_ParticleEmitter *emitter = (SGE_ParticleEmitter*)calloc(1, sizeof(SGE_ParticleEmitter));
+	if(emitter == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for particle emitter!");
+		return NULL;
+	}
+
+	/* The pool never grows, so all the buffers are allocated once */
+	emitter->posX = (float*)malloc(maxParticles * sizeof(float));
+	emitter->posY = (float*)malloc(maxParticles * sizeof(float));
+	emitter->velX = (float*)malloc(maxParticles * sizeof(float));
+	emitter->velY = (float*)malloc(maxParticles * sizeof(float));
+	emitter->age = (float*)malloc(maxParticles * sizeof(float));
+	emitter->lifetime = (float*)malloc(maxParticles * sizeof(float));
+	emitter->colors = (SDL_Color*)malloc(maxParticles * sizeof(SDL_Color));
+	emitter->deadMask = (Uint32*)malloc(((maxParticles + 31) / 32) * sizeof(Uint32));
+	bool isAllocated = emitter->posX != NULL && emitter->posY != NULL && emitter->velX != NULL && emitter->velY != NULL && emitter->age != NULL && emitter->lifetime != NULL && emitter->colors != NULL && emitter->deadMask != NULL;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	emitter->vertices = (SDL_Vertex*)malloc(maxParticles * 4 * sizeof(SDL_Vertex));
+	emitter->indices = (int*)malloc(maxParticles * 6 * sizeof(int));
+	isAllocated = isAllocated && emitter->vertices != NULL && emitter->indices != NULL;
+#endif
+	if(!isAllocated)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for %d particles!", maxParticles);
+		SGE_FreeParticleEmitter(emitter);
+		return NULL;
+	}
+	emitter->capacity = maxParticles;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	/* The index pattern is the same for every quad, so it only has to be written once */
+	int i = 0;
+	for(i = 0; i < maxParticles; i++)
+	{
+		emitter->indices[i * 6 + 0] = i * 4 + 0;
+		emitter->indices[i * 6 + 1] = i * 4 + 1;
+		emitter->indices[i * 6 + 2] = i * 4 + 2;
+		emitter->indices[i * 6 + 3] = i * 4 + 0;
+		emitter->indices[i * 6 + 4] = i * 4 + 2;
+		emitter->indices[i * 6 + 5] = i * 4 + 3;
+	}
+#endif
+
+	emitter->rate = 100;
+	emitter->isEmitting = true;
+	emitter->minLifetime = 1;
+	emitter->maxLifetime = 2;
+	emitter->minSpeed = 50;
+	emitter->maxSpeed = 100;
+	emitter->direction = -90;
+	emitter->spread = 30;
+	emitter->startSize = 4;
+	emitter->endSize = 4;
+	emitter->startColor.r = emitter->startColor.g = emitter->startColor.b = emitter->startColor.a = 255;
+	emitter->endColor = emitter->startColor;
+	emitter->endColor.a = 0;
+	emitter->blendMode = SDL_BLENDMODE_BLEND;
+
+	system->emitters[system->emitterCount] = emitter;
+	system->emitterCount++;
+	return emitter;
+}
+
+void SGE_ParticleSystemRemoveEmitter(SGE_ParticleSystem *system, SGE_ParticleEmitter *emitter)
+{
+	int i = 0;
+	for(i = 0; i < system->emitterCount; i++)
+	{
+		if(system->emitters[i] == emitter)
+		{
+			memmove(&system->emitters[i], &system->emitters[i + 1], (system->emitterCount - i - 1) * sizeof(SGE_ParticleEmitter*));
+			system->emitterCount--;
+			SGE_FreeParticleEmitter(emitter);
+			return;
+		}
+	}
+	SGE_LogPrintLine(SGE_LOG_WARNING, "Particle emitter is not part of the particle system!");
+}
+
+void SGE_ParticleEmitterClear(SGE_ParticleEmitter *emitter)
+{
+	emitter->count = 0;
+	emitter->spawnAccumulator = 0;
+}
+
+/* xorshift32, returns a value in [0, 1) */
+static float SGE_ParticleRandom(SGE_ParticleSystem *system)
+{
+	Uint32 state = system->randomState;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	system->randomState = state;
+	return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+
+static Uint8 SGE_JitterColorChannel(SGE_ParticleSystem *system, Uint8 value, Uint8 jitter)
+{
+	int jittered = value + (int)((SGE_ParticleRandom(system) * 2.0f - 1.0f) * jitter);
+	return (Uint8)SDL_max(0, SDL_min(255, jittered));
+}
+
+void SGE_ParticleEmitterBurst(SGE_ParticleSystem *system, SGE_ParticleEmitter *emitter, int count)
+{
+	count = SDL_min(count, emitter->capacity - emitter->count);
+	if(count <= 0)
+	{
+		return;
+	}
+
+	int i = 0;
+	for(i = emitter->count; i < emitter->count + count; i++)
+	{
+		float angle = (emitter->direction + emitter->spread * (SGE_ParticleRandom(system) - 0.5f)) * (float)M_PI / 180.0f;
+		float speed = emitter->minSpeed + (emitter->maxSpeed - emitter->minSpeed) * SGE_ParticleRandom(system);
+
+		emitter->posX[i] = emitter->x + emitter->w * SGE_ParticleRandom(system);
+		emitter->posY[i] = emitter->y + emitter->h * SGE_ParticleRandom(system);
+		emitter->velX[i] = SDL_cosf(angle) * speed;
+		emitter->velY[i] = SDL_sinf(angle) * speed;
+		emitter->age[i] = 0;
+		emitter->lifetime[i] = emitter->minLifetime + (emitter->maxLifetime - emitter->minLifetime) * SGE_ParticleRandom(system);
+
+		emitter->colors[i] = emitter->startColor;
+		if(emitter->colorJitter > 0)
+		{
+			emitter->colors[i].r = SGE_JitterColorChannel(system, emitter->startColor.r, emitter->colorJitter);
+			emitter->colors[i].g = SGE_JitterColorChannel(system, emitter->startColor.g, emitter->colorJitter);
+			emitter->colors[i].b = SGE_JitterColorChannel(system, emitter->startColor.b, emitter->colorJitter);
+		}
+	}
+	emitter->count += count;
+}
+
+/* Copies "count" particles from "from" to "to", the ranges may overlap */
+static void SGE_MoveParticles(SGE_ParticleEmitter *emitter, int to, int from, int count)
+{
+	memmove(&emitter->posX[to], &emitter->posX[from], count * sizeof(float));
+	memmove(&emitter->posY[to], &emitter->posY[from], count * sizeof(float));
+	memmove(&emitter->velX[to], &emitter->velX[from], count * sizeof(float));
+	memmove(&emitter->velY[to], &emitter->velY[from], count * sizeof(float));
+	memmove(&emitter->age[to], &emitter->age[from], count * sizeof(float));
+	memmove(&emitter->lifetime[to], &emitter->lifetime[from], count * sizeof(float));
+	memmove(&emitter->colors[to], &emitter->colors[from], count * sizeof(SDL_Color));
+}
+
+/*
+ * Packs the live particles together, keeping their order so overlapping particles don't pop.
+ * Runs of live particles are moved at once, and nothing is moved until the first dead particle.
+ */
+static void SGE_CompactParticles(SGE_ParticleEmitter *emitter)
+{
+	int wordCount = (emitter->count + 31) / 32;
+	int write = 0;
+	int word = 0;
+
+	for(word = 0; word < wordCount; word++)
+	{
+		int base = word * 32;
+		int end = SDL_min(base + 32, emitter->count);
+		Uint32 dead = emitter->deadMask[word];
+		if(dead == 0 && write == base)
+		{
+			write = end;
+			continue;
+		}
+
+		int i = base;
+		while(i < end)
+		{
+			if(dead & (1u << (i & 31)))
+			{
+				i++;
+				continue;
+			}
+
+			int runStart = i;
+			while(i < end && !(dead & (1u << (i & 31))))
+			{
+				i++;
+			}
+			if(write != runStart)
+			{
+				SGE_MoveParticles(emitter, write, runStart, i - runStart);
+			}
+			write += i - runStart;
+		}
+	}
+	emitter->count = write;
+}
+
+void SGE_ParticleSystemUpdate(SGE_ParticleSystem *system, float delta)
+{
+	if(integrateKernel == NULL)
+	{
+		SGE_SelectParticleKernels();
+	}
+
+	int i = 0;
+	system->liveCount = 0;
+	for(i = 0; i < system->emitterCount; i++)
+	{
+		SGE_ParticleEmitter *emitter = system->emitters[i];
+
+		if(emitter->count > 0)
+		{
+			SGE_ParticleStep step;
+			step.delta = delta;
+			step.gravityX = emitter->gravityX;
+			step.gravityY = emitter->gravityY;
+			step.damping = SDL_max(0.0f, 1.0f - emitter->drag * delta);
+			integrateKernel(&step, emitter->posX, emitter->posY, emitter->velX, emitter->velY, emitter->age, emitter->count);
+
+			memset(emitter->deadMask, 0, ((emitter->count + 31) / 32) * sizeof(Uint32));
+			killKernel(emitter->age, emitter->lifetime, emitter->count, emitter->deadMask);
+			SGE_CompactParticles(emitter);
+		}
+
+		if(emitter->isEmitting && emitter->rate > 0)
+		{
+			emitter->spawnAccumulator += emitter->rate * delta;
+			int spawnCount = (int)emitter->spawnAccumulator;
+			emitter->spawnAccumulator -= spawnCount;
+			SGE_ParticleEmitterBurst(system, emitter, spawnCount);
+		}
+
+		system->liveCount += emitter->count;
+	}
+}
+
+/* Maps world positions to the screen, screen = origin + x * axisX + y * axisY */
+typedef struct
+{
+	float originX, originY;
+	float axisXx, axisXy;
+	float axisYx, axisYy;
+} SGE_ParticleTransform;
+
+static void SGE_GetParticleTransform(SGE_ParticleTransform *transform)
+{
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera == NULL)
+	{
+		transform->originX = 0;
+		transform->originY = 0;
+		transform->axisXx = 1;
+		transform->axisXy = 0;
+		transform->axisYx = 0;
+		transform->axisYy = 1;
+		return;
+	}
+
+	/* The camera's mapping is affine, so three points are enough to describe it */
+	float rightX = 0, rightY = 0, downX = 0, downY = 0;
+	SGE_CameraWorldToScreen(camera, 0, 0, &transform->originX, &transform->originY);
+	SGE_CameraWorldToScreen(camera, 1, 0, &rightX, &rightY);
+	SGE_CameraWorldToScreen(camera, 0, 1, &downX, &downY);
+	transform->axisXx = rightX - transform->originX;
+	transform->axisXy = rightY - transform->originY;
+	transform->axisYx = downX - transform->originX;
+	transform->axisYy = downY - transform->originY;
+}
+
+/* Returns how far through it's life a particle is, from 0 to 1 */
+static float SGE_GetParticleProgress(const SGE_ParticleEmitter *emitter, int i)
+{
+	if(emitter->lifetime[i] <= 0)
+	{
+		return 1.0f;
+	}
+	return SDL_min(1.0f, emitter->age[i] / emitter->lifetime[i]);
+}
+
+static SDL_Color SGE_GetParticleColor(const SGE_ParticleEmitter *emitter, int i, float progress)
+{
+	SDL_Color start = emitter->colors[i];
+	SDL_Color end = emitter->endColor;
+	SDL_Color color;
+	color.r = (Uint8)(start.r + (end.r - start.r) * progress);
+	color.g = (Uint8)(start.g + (end.g - start.g) * progress);
+	color.b = (Uint8)(start.b + (end.b - start.b) * progress);
+	color.a = (Uint8)(start.a + (end.a - start.a) * progress);
+	return color;
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/* Writes a quad per particle, facing the screen and turned with the camera */
+static void SGE_BuildParticleGeometry(SGE_ParticleEmitter *emitter, const SGE_ParticleTransform *transform, float u0, float v0, float u1, float v1)
+{
+	int i = 0;
+	for(i = 0; i < emitter->count; i++)
+	{
+		float progress = SGE_GetParticleProgress(emitter, i);
+		float half = (emitter->startSize + (emitter->endSize - emitter->startSize) * progress) * 0.5f;
+		SDL_Color color = SGE_GetParticleColor(emitter, i, progress);
+
+		float centerX = transform->originX + emitter->posX[i] * transform->axisXx + emitter->posY[i] * transform->axisYx;
+		float centerY = transform->originY + emitter->posX[i] * transform->axisXy + emitter->posY[i] * transform->axisYy;
+		float rightX = transform->axisXx * half;
+		float rightY = transform->axisXy * half;
+		float downX = transform->axisYx * half;
+		float downY = transform->axisYy * half;
+
+		SDL_Vertex *quad = &emitter->vertices[i * 4];
+		quad[0].position.x = centerX - rightX - downX;
+		quad[0].position.y = centerY - rightY - downY;
+		quad[0].tex_coord.x = u0;
+		quad[0].tex_coord.y = v0;
+		quad[1].position.x = centerX + rightX - downX;
+		quad[1].position.y = centerY + rightY - downY;
+		quad[1].tex_coord.x = u1;
+		quad[1].tex_coord.y = v0;
+		quad[2].position.x = centerX + rightX + downX;
+		quad[2].position.y = centerY + rightY + downY;
+		quad[2].tex_coord.x = u1;
+		quad[2].tex_coord.y = v1;
+		quad[3].position.x = centerX - rightX + downX;
+		quad[3].position.y = centerY - rightY + downY;
+		quad[3].tex_coord.x = u0;
+		quad[3].tex_coord.y = v1;
+		quad[0].color = quad[1].color = quad[2].color = quad[3].color = color;
+	}
+}
+#else
+/* No geometry support, draw each particle on it's own, without the camera's rotation */
+static void SGE_DrawParticlesSeparately(SGE_ParticleEmitter *emitter, const SGE_ParticleTransform *transform, SDL_Texture *texture, const SDL_Rect *clip)
+{
+	SDL_Renderer *renderer = SGE_GetEngineData()->renderer;
+	float scale = SDL_sqrtf(transform->axisXx * transform->axisXx + transform->axisXy * transform->axisXy);
+
+	int i = 0;
+	for(i = 0; i < emitter->count; i++)
+	{
+		float progress = SGE_GetParticleProgress(emitter, i);
+		float size = (emitter->startSize + (emitter->endSize - emitter->startSize) * progress) * scale;
+		SDL_Color color = SGE_GetParticleColor(emitter, i, progress);
+
+		float centerX = transform->originX + emitter->posX[i] * transform->axisXx + emitter->posY[i] * transform->axisYx;
+		float centerY = transform->originY + emitter->posX[i] * transform->axisXy + emitter->posY[i] * transform->axisYy;
+		SDL_Rect dest = {(int)(centerX - size * 0.5f), (int)(centerY - size * 0.5f), (int)size, (int)size};
+
+		if(texture != NULL)
+		{
+			SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+			SDL_SetTextureAlphaMod(texture, color.a);
+			SDL_RenderCopy(renderer, texture, clip, &dest);
+		}
+		else
+		{
+			SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+			SDL_RenderFillRect(renderer, &dest);
+		}
+	}
+}
+#endif
+
+void SGE_ParticleSystemRender(SGE_ParticleSystem *system)
+{
+	SGE_EngineData *engineData = SGE_GetEngineData();
+	SDL_BlendMode drawBlendMode = engineData->drawBlendMode;
+	bool isDrawBlendModeChanged = false;
+	int i = 0;
+
+	system->lastDrawCalls = 0;
+
+	/* Draw queued primitives first to keep the drawing order */
+	if(SGE_PrimitiveBatchGetCount() > 0)
+	{
+		SGE_PrimitiveBatchFlush();
+	}
+
+	SGE_ParticleTransform transform;
+	SGE_GetParticleTransform(&transform);
+
+	for(i = 0; i < system->emitterCount; i++)
+	{
+		SGE_ParticleEmitter *emitter = system->emitters[i];
+		if(emitter->count == 0)
+		{
+			continue;
+		}
+
+		/* Regions are drawn from their parent's SDL_Texture */
+		SDL_Texture *texture = NULL;
+		SDL_Rect clip = {0, 0, 0, 0};
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		float u0 = 0, v0 = 0, u1 = 1, v1 = 1;
+#endif
+		if(emitter->texture != NULL)
+		{
+			if(emitter->texture->isStale)
+			{
+				SGE_RestoreTexture(emitter->texture);
+			}
+			if(emitter->texture->texture == NULL)
+			{
+				continue;
+			}
+
+			texture = emitter->texture->texture;
+			clip = emitter->texture->clipRect;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+			SGE_Texture *owner = (emitter->texture->parent != NULL) ? emitter->texture->parent : emitter->texture;
+			u0 = (float)clip.x / owner->original_w;
+			v0 = (float)clip.y / owner->original_h;
+			u1 = (float)(clip.x + clip.w) / owner->original_w;
+			v1 = (float)(clip.y + clip.h) / owner->original_h;
+#endif
+			SDL_SetTextureBlendMode(texture, SGE_MapDrawBlendMode(emitter->blendMode));
+		}
+		else
+		{
+			/* Untextured geometry is blended with the draw blend mode */
+			SGE_SetDrawBlendMode(emitter->blendMode);
+			isDrawBlendModeChanged = true;
+		}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		SGE_BuildParticleGeometry(emitter, &transform, u0, v0, u1, v1);
+		SDL_RenderGeometry(engineData->renderer, texture, emitter->vertices, emitter->count * 4, emitter->indices, emitter->count * 6);
+		system->lastDrawCalls++;
+#else
+		SGE_DrawParticlesSeparately(emitter, &transform, texture, &clip);
+		system->lastDrawCalls += emitter->count;
+#endif
+
+		if(texture != NULL)
+		{
+			SGE_RestoreTextureMods(emitter->texture);
+		}
+	}
+
+	if(isDrawBlendModeChanged)
+	{
+		SGE_SetDrawBlendMode(drawBlendMode);
+	}
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+	/* The draw color was changed behind the shadowed state */
+	SGE_InvalidateRenderState();
+#endif
+}
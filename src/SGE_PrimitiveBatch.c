@@ -0,0 +1,392 @@
+#include "SGE_PrimitiveBatch.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef enum
+{
+	SGE_PRIMITIVE_FILL_RECT,
+	SGE_PRIMITIVE_RECT,
+	SGE_PRIMITIVE_LINE,
+	SGE_PRIMITIVE_FILL_QUAD
+} SGE_PrimitiveType;
+
+typedef struct
+{
+	SGE_PrimitiveType type;
+	/* The rect, or the line's end points as x, y and w, h */
+	SDL_Rect rect;
+	/* Corners of a quad */
+	SDL_FPoint corners[4];
+	SDL_Color color;
+} SGE_Primitive;
+
+static SGE_Primitive *primitives = NULL;
+static int primitiveCount = 0;
+static int primitiveCapacity = 0;
+
+/* Number of quads the queued primitives turn into */
+static int quadCount = 0;
+
+static int lastDrawCalls = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static SDL_Vertex *vertices = NULL;
+static int *indices = NULL;
+static int quadCapacity = 0;
+#else
+static SDL_Rect *groupRects = NULL;
+#endif
+
+static SGE_Primitive *SGE_PrimitiveBatchAdd(SGE_PrimitiveType type, int x, int y, int w, int h, SDL_Color color, int quads)
+{
+	if(primitiveCount == primitiveCapacity)
+	{
+		int capacity = (primitiveCapacity == 0) ? 256 : primitiveCapacity * 2;
+		SGE_Primitive *grown = (SGE_Primitive*)realloc(primitives, capacity * sizeof(SGE_Primitive));
+		if(grown == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow primitive batch to %d primitives!", capacity);
+			return NULL;
+		}
+		primitives = grown;
+		primitiveCapacity = capacity;
+	}
+
+	SGE_Primitive *primitive = &primitives[primitiveCount];
+	primitive->type = type;
+	primitive->rect.x = x;
+	primitive->rect.y = y;
+	primitive->rect.w = w;
+	primitive->rect.h = h;
+	primitive->color = color;
+	primitiveCount++;
+	quadCount += quads;
+	return primitive;
+}
+
+void SGE_PrimitiveBatchFillRect(const SDL_Rect *rect, SDL_Color color)
+{
+	if(rect->w <= 0 || rect->h <= 0)
+	{
+		return;
+	}
+	SGE_PrimitiveBatchAdd(SGE_PRIMITIVE_FILL_RECT, rect->x, rect->y, rect->w, rect->h, color, 1);
+}
+
+void SGE_PrimitiveBatchRect(const SDL_Rect *rect, SDL_Color color)
+{
+	if(rect->w <= 0 || rect->h <= 0)
+	{
+		return;
+	}
+	SGE_PrimitiveBatchAdd(SGE_PRIMITIVE_RECT, rect->x, rect->y, rect->w, rect->h, color, 4);
+}
+
+void SGE_PrimitiveBatchLine(int x1, int y1, int x2, int y2, SDL_Color color)
+{
+	SGE_PrimitiveBatchAdd(SGE_PRIMITIVE_LINE, x1, y1, x2, y2, color, 1);
+}
+
+void SGE_PrimitiveBatchFillQuad(const SDL_FPoint corners[4], SDL_Color color)
+{
+	SGE_Primitive *primitive = SGE_PrimitiveBatchAdd(SGE_PRIMITIVE_FILL_QUAD, 0, 0, 0, 0, color, 1);
+	if(primitive != NULL)
+	{
+		memcpy(primitive->corners, corners, sizeof(primitive->corners));
+	}
+}
+
+int SGE_PrimitiveBatchGetCount()
+{
+	return primitiveCount;
+}
+
+int SGE_PrimitiveBatchGetLastDrawCalls()
+{
+	return lastDrawCalls;
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/* Grows the vertex and index buffers to hold at least "capacity" quads */
+static bool SGE_PrimitiveBatchReserve(int capacity)
+{
+	if(capacity <= quadCapacity)
+	{
+		return true;
+	}
+
+	int newCapacity = (quadCapacity == 0) ? 256 : quadCapacity;
+	while(newCapacity < capacity)
+	{
+		newCapacity *= 2;
+	}
+
+	SDL_Vertex *grownVertices = (SDL_Vertex*)realloc(vertices, newCapacity * 4 * sizeof(SDL_Vertex));
+	if(grownVertices == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow primitive batch to %d quads!", newCapacity);
+		return false;
+	}
+	vertices = grownVertices;
+
+	int *grownIndices = (int*)realloc(indices, newCapacity * 6 * sizeof(int));
+	if(grownIndices == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow primitive batch to %d quads!", newCapacity);
+		return false;
+	}
+	indices = grownIndices;
+
+	int i = 0;
+	for(i = quadCapacity; i < newCapacity; i++)
+	{
+		indices[i * 6 + 0] = i * 4 + 0;
+		indices[i * 6 + 1] = i * 4 + 1;
+		indices[i * 6 + 2] = i * 4 + 2;
+		indices[i * 6 + 3] = i * 4 + 2;
+		indices[i * 6 + 4] = i * 4 + 3;
+		indices[i * 6 + 5] = i * 4 + 0;
+	}
+	quadCapacity = newCapacity;
+	return true;
+}
+
+/* Writes a quad from four corners given in clockwise order */
+static SDL_Vertex *SGE_PrimitiveBatchQuad(SDL_Vertex *v, float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, SDL_Color color)
+{
+	v[0].position.x = x0; v[0].position.y = y0;
+	v[1].position.x = x1; v[1].position.y = y1;
+	v[2].position.x = x2; v[2].position.y = y2;
+	v[3].position.x = x3; v[3].position.y = y3;
+
+	int i = 0;
+	for(i = 0; i < 4; i++)
+	{
+		v[i].color = color;
+		v[i].tex_coord.x = 0;
+		v[i].tex_coord.y = 0;
+	}
+	return v + 4;
+}
+
+/* Writes an axis aligned quad covering the pixels of a rect */
+static SDL_Vertex *SGE_PrimitiveBatchRectQuad(SDL_Vertex *v, float x, float y, float w, float h, SDL_Color color)
+{
+	return SGE_PrimitiveBatchQuad(v, x, y, x + w, y, x + w, y + h, x, y + h, color);
+}
+
+void SGE_PrimitiveBatchFlush()
+{
+	lastDrawCalls = 0;
+	if(primitiveCount == 0)
+	{
+		return;
+	}
+
+	if(!SGE_PrimitiveBatchReserve(quadCount))
+	{
+		primitiveCount = 0;
+		quadCount = 0;
+		return;
+	}
+
+	SDL_Vertex *v = vertices;
+	int i = 0;
+	for(i = 0; i < primitiveCount; i++)
+	{
+		SGE_Primitive *p = &primitives[i];
+		SDL_Rect *r = &p->rect;
+		if(p->type == SGE_PRIMITIVE_FILL_RECT)
+		{
+			v = SGE_PrimitiveBatchRectQuad(v, r->x, r->y, r->w, r->h, p->color);
+		}
+		else if(p->type == SGE_PRIMITIVE_RECT)
+		{
+			/* Top and bottom edges span the whole width, the sides fill the space between them */
+			v = SGE_PrimitiveBatchRectQuad(v, r->x, r->y, r->w, 1, p->color);
+			v = SGE_PrimitiveBatchRectQuad(v, r->x, r->y + r->h - 1, r->w, (r->h > 1) ? 1 : 0, p->color);
+			v = SGE_PrimitiveBatchRectQuad(v, r->x, r->y + 1, 1, (r->h > 2) ? r->h - 2 : 0, p->color);
+			v = SGE_PrimitiveBatchRectQuad(v, r->x + r->w - 1, r->y + 1, (r->w > 1) ? 1 : 0, (r->h > 2) ? r->h - 2 : 0, p->color);
+		}
+		else if(p->type == SGE_PRIMITIVE_FILL_QUAD)
+		{
+			v = SGE_PrimitiveBatchQuad(v, p->corners[0].x, p->corners[0].y, p->corners[1].x, p->corners[1].y, p->corners[2].x, p->corners[2].y, p->corners[3].x, p->corners[3].y, p->color);
+		}
+		else
+		{
+			/* A one pixel wide quad through the pixel centers, extended by half a pixel to cover the end points */
+			float x1 = r->x + 0.5f;
+			float y1 = r->y + 0.5f;
+			float x2 = r->w + 0.5f;
+			float y2 = r->h + 0.5f;
+			float dx = x2 - x1;
+			float dy = y2 - y1;
+			float length = SDL_sqrtf(dx * dx + dy * dy);
+			if(length == 0)
+			{
+				dx = 0.5f;
+				dy = 0;
+			}
+			else
+			{
+				dx = dx / length * 0.5f;
+				dy = dy / length * 0.5f;
+			}
+			v = SGE_PrimitiveBatchQuad(v,
+				x1 - dx + dy, y1 - dy - dx,
+				x2 + dx + dy, y2 + dy - dx,
+				x2 + dx - dy, y2 + dy + dx,
+				x1 - dx - dy, y1 - dy + dx,
+				p->color);
+		}
+	}
+
+	SDL_RenderGeometry(SGE_GetEngineData()->renderer, NULL, vertices, quadCount * 4, indices, quadCount * 6);
+	lastDrawCalls = 1;
+
+	primitiveCount = 0;
+	quadCount = 0;
+}
+#else
+/* Fills a convex quad one row at a time, there is no geometry to draw it with */
+static int SGE_PrimitiveBatchFillQuadRows(SDL_Renderer *renderer, const SDL_FPoint *corners)
+{
+	float minY = corners[0].y;
+	float maxY = corners[0].y;
+	int i = 0;
+	for(i = 1; i < 4; i++)
+	{
+		if(corners[i].y < minY) minY = corners[i].y;
+		if(corners[i].y > maxY) maxY = corners[i].y;
+	}
+
+	int drawCalls = 0;
+	int y = 0;
+	for(y = (int)SDL_ceilf(minY - 0.5f); y + 0.5f <= maxY; y++)
+	{
+		/* Intersect the row through the pixel centers with every edge */
+		float rowY = y + 0.5f;
+		float left = 0;
+		float right = 0;
+		bool found = false;
+		for(i = 0; i < 4; i++)
+		{
+			const SDL_FPoint *a = &corners[i];
+			const SDL_FPoint *b = &corners[(i + 1) % 4];
+			if((rowY < a->y && rowY < b->y) || (rowY > a->y && rowY > b->y) || a->y == b->y)
+			{
+				continue;
+			}
+			float x = a->x + (rowY - a->y) * (b->x - a->x) / (b->y - a->y);
+			if(!found || x < left) left = x;
+			if(!found || x > right) right = x;
+			found = true;
+		}
+		if(found && right - left >= 0.5f)
+		{
+			SDL_RenderDrawLine(renderer, (int)SDL_ceilf(left - 0.5f), y, (int)SDL_ceilf(right - 0.5f) - 1, y);
+			drawCalls++;
+		}
+	}
+	return drawCalls;
+}
+
+void SGE_PrimitiveBatchFlush()
+{
+	SDL_Renderer *renderer = SGE_GetEngineData()->renderer;
+	lastDrawCalls = 0;
+	if(primitiveCount == 0)
+	{
+		return;
+	}
+
+	SDL_Rect *grown = (SDL_Rect*)realloc(groupRects, primitiveCapacity * sizeof(SDL_Rect));
+	if(grown == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate primitive batch rects!");
+		primitiveCount = 0;
+		quadCount = 0;
+		return;
+	}
+	groupRects = grown;
+
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+	/* Draw runs of primitives with the same type and color together */
+	int start = 0;
+	while(start < primitiveCount)
+	{
+		SGE_Primitive *first = &primitives[start];
+		int end = start;
+		while(end < primitiveCount)
+		{
+			SGE_Primitive *next = &primitives[end];
+			if(next->type != first->type || next->color.r != first->color.r || next->color.g != first->color.g || next->color.b != first->color.b || next->color.a != first->color.a)
+			{
+				break;
+			}
+			groupRects[end - start] = next->rect;
+			end++;
+		}
+
+		SDL_SetRenderDrawColor(renderer, first->color.r, first->color.g, first->color.b, first->color.a);
+		if(first->type == SGE_PRIMITIVE_FILL_RECT)
+		{
+			SDL_RenderFillRects(renderer, groupRects, end - start);
+			lastDrawCalls++;
+		}
+		else if(first->type == SGE_PRIMITIVE_RECT)
+		{
+			SDL_RenderDrawRects(renderer, groupRects, end - start);
+			lastDrawCalls++;
+		}
+		else if(first->type == SGE_PRIMITIVE_LINE)
+		{
+			int i = 0;
+			for(i = 0; i < end - start; i++)
+			{
+				SDL_RenderDrawLine(renderer, groupRects[i].x, groupRects[i].y, groupRects[i].w, groupRects[i].h);
+				lastDrawCalls++;
+			}
+		}
+		else
+		{
+			int i = 0;
+			for(i = start; i < end; i++)
+			{
+				lastDrawCalls += SGE_PrimitiveBatchFillQuadRows(renderer, primitives[i].corners);
+			}
+		}
+		start = end;
+	}
+
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	primitiveCount = 0;
+	quadCount = 0;
+}
+#endif
+
+void SGE_PrimitiveBatchQuit()
+{
+	free(primitives);
+	primitives = NULL;
+	primitiveCount = 0;
+	primitiveCapacity = 0;
+	quadCount = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	free(vertices);
+	free(indices);
+	vertices = NULL;
+	indices = NULL;
+	quadCapacity = 0;
+#else
+	free(groupRects);
+	groupRects = NULL;
+#endif
+}
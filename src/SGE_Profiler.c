@@ -0,0 +1,197 @@
+#include "SGE_Profiler.h"
+#include "SGE_Logger.h"
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool isEnabled = true;
+
+/* Performance counter ticks per second */
+static Uint64 frequency = 0;
+
+/* Start time of each running phase, 0 for phases not running */
+static Uint64 phaseStart[SGE_PROFILER_PHASE_COUNT];
+
+/* Time of each phase summed up over the current frame, in performance counter ticks */
+static Uint64 frameTotals[SGE_PROFILER_PHASE_COUNT];
+
+/* Ring buffer of the per frame phase times, in milliseconds */
+static float history[SGE_PROFILER_PHASE_COUNT][SGE_PROFILER_HISTORY_SIZE];
+static int historyHead = 0;
+static int historyCount = 0;
+
+static const char *phaseNames[SGE_PROFILER_PHASE_COUNT] = {
+	"events",
+	"gui events",
+	"uploads",
+	"gui update",
+	"update",
+	"render",
+	"gui render",
+	"present",
+	"switch",
+	"cap"
+};
+
+void SGE_ProfilerSetEnabled(bool enabled)
+{
+	isEnabled = enabled;
+	memset(frameTotals, 0, sizeof(frameTotals));
+	/* Phases begun before the profiler was enabled would count the time it was disabled */
+	memset(phaseStart, 0, sizeof(phaseStart));
+}
+
+bool SGE_ProfilerIsEnabled()
+{
+	return isEnabled;
+}
+
+void SGE_ProfilerBegin(SGE_ProfilerPhase phase)
+{
+	if(!isEnabled)
+	{
+		return;
+	}
+	phaseStart[phase] = SDL_GetPerformanceCounter();
+}
+
+void SGE_ProfilerEnd(SGE_ProfilerPhase phase)
+{
+	if(!isEnabled)
+	{
+		return;
+	}
+	/* Ends without a matching begin are ignored */
+	if(phaseStart[phase] == 0)
+	{
+		return;
+	}
+	frameTotals[phase] += SDL_GetPerformanceCounter() - phaseStart[phase];
+	phaseStart[phase] = 0;
+}
+
+void SGE_ProfilerEndFrame()
+{
+	if(!isEnabled)
+	{
+		return;
+	}
+
+	if(frequency == 0)
+	{
+		frequency = SDL_GetPerformanceFrequency();
+	}
+
+	int i = 0;
+	for(i = 0; i < SGE_PROFILER_PHASE_COUNT; i++)
+	{
+		history[i][historyHead] = (float)((double)frameTotals[i] * 1000.0 / frequency);
+		frameTotals[i] = 0;
+	}
+
+	historyHead = (historyHead + 1) % SGE_PROFILER_HISTORY_SIZE;
+	if(historyCount < SGE_PROFILER_HISTORY_SIZE)
+	{
+		historyCount++;
+	}
+}
+
+void SGE_ProfilerReset()
+{
+	memset(frameTotals, 0, sizeof(frameTotals));
+	historyHead = 0;
+	historyCount = 0;
+}
+
+static int SGE_ProfilerCompareSamples(const void *a, const void *b)
+{
+	float x = *(const float *)a;
+	float y = *(const float *)b;
+	return (x > y) - (x < y);
+}
+
+void SGE_ProfilerGetPhaseStats(SGE_ProfilerPhase phase, SGE_ProfilerStats *stats)
+{
+	memset(stats, 0, sizeof(SGE_ProfilerStats));
+	stats->sampleCount = historyCount;
+	if(historyCount == 0)
+	{
+		return;
+	}
+
+	/* The history is unordered once it wraps around, so it can be sorted as is */
+	float sorted[SGE_PROFILER_HISTORY_SIZE];
+	memcpy(sorted, history[phase], historyCount * sizeof(float));
+	qsort(sorted, historyCount, sizeof(float), SGE_ProfilerCompareSamples);
+
+	double sum = 0;
+	int i = 0;
+	for(i = 0; i < historyCount; i++)
+	{
+		sum += sorted[i];
+	}
+
+	int p99Index = (historyCount * 99) / 100;
+	if(p99Index >= historyCount)
+	{
+		p99Index = historyCount - 1;
+	}
+
+	stats->min = sorted[0];
+	stats->max = sorted[historyCount - 1];
+	stats->avg = sum / historyCount;
+	stats->p99 = sorted[p99Index];
+	stats->last = history[phase][(historyHead + SGE_PROFILER_HISTORY_SIZE - 1) % SGE_PROFILER_HISTORY_SIZE];
+}
+
+SGE_ProfilerPhase SGE_ProfilerGetSlowestPhase()
+{
+	SGE_ProfilerPhase slowest = SGE_PROFILER_EVENTS;
+	double slowestTotal = -1;
+	int i = 0;
+	int j = 0;
+	for(i = 0; i < SGE_PROFILER_PHASE_COUNT; i++)
+	{
+		/* The frame cap is idle time, not work */
+		if(i == SGE_PROFILER_FRAME_CAP)
+		{
+			continue;
+		}
+
+		double total = 0;
+		for(j = 0; j < historyCount; j++)
+		{
+			total += history[i][j];
+		}
+
+		if(total > slowestTotal)
+		{
+			slowestTotal = total;
+			slowest = i;
+		}
+	}
+	return slowest;
+}
+
+const char *SGE_ProfilerGetPhaseName(SGE_ProfilerPhase phase)
+{
+	if(phase < 0 || phase >= SGE_PROFILER_PHASE_COUNT)
+	{
+		return "unknown";
+	}
+	return phaseNames[phase];
+}
+
+void SGE_ProfilerPrintStats()
+{
+	SGE_ProfilerStats stats;
+	int i = 0;
+
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Profiler stats over %d frames (ms):", historyCount);
+	for(i = 0; i < SGE_PROFILER_PHASE_COUNT; i++)
+	{
+		SGE_ProfilerGetPhaseStats(i, &stats);
+		SGE_LogPrintLine(SGE_LOG_DEBUG, "%-10s min: %.3f avg: %.3f max: %.3f p99: %.3f", phaseNames[i], stats.min, stats.avg, stats.max, stats.p99);
+	}
+}
@@ -0,0 +1,413 @@
+#include "SGE_RenderQueue.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+#include "SGE_PrimitiveBatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Queue drawn by SGE_Run(), created the first time it is asked for */
+static SGE_RenderQueue *frameQueue = NULL;
+
+/*
+ * Builds a sort key from the layer, depth, kind of draw, texture and blend mode, from the highest bits down.
+ * Textures and blend modes only have to group together, so they are hashed down to the bits they get.
+ */
+static SGE_RenderKey SGE_MakeRenderKey(Uint8 layer, Uint16 depth, SGE_RenderCommandType type, const void *texture, SDL_BlendMode blendMode)
+{
+	Uint64 textureBits = ((Uint64)(uintptr_t)texture * 0x9E3779B97F4A7C15ull) >> 36;
+	Uint64 blendBits = ((Uint32)blendMode * 2654435761u) >> 24;
+	return ((Uint64)layer << 56) | ((Uint64)depth << 40) | ((Uint64)type << 36) | (textureBits << 8) | blendBits;
+}
+
+/* Grows all the queue's buffers to hold at least "capacity" draws */
+static bool SGE_RenderQueueReserve(SGE_RenderQueue *queue, int capacity)
+{
+	if(capacity <= queue->capacity)
+	{
+		return true;
+	}
+
+	SGE_RenderCommand *commands = (SGE_RenderCommand*)realloc(queue->commands, capacity * sizeof(SGE_RenderCommand));
+	if(commands != NULL) queue->commands = commands;
+	SGE_RenderKey *keys = (SGE_RenderKey*)realloc(queue->keys, capacity * sizeof(SGE_RenderKey));
+	if(keys != NULL) queue->keys = keys;
+	bool isGrown = commands != NULL && keys != NULL;
+
+	int i = 0;
+	for(i = 0; i < 2; i++)
+	{
+		SGE_RenderKey *sortKeys = (SGE_RenderKey*)realloc(queue->sortKeys[i], capacity * sizeof(SGE_RenderKey));
+		if(sortKeys != NULL) queue->sortKeys[i] = sortKeys;
+		int *sortOrder = (int*)realloc(queue->sortOrder[i], capacity * sizeof(int));
+		if(sortOrder != NULL) queue->sortOrder[i] = sortOrder;
+		isGrown = isGrown && sortKeys != NULL && sortOrder != NULL;
+	}
+
+	if(!isGrown)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow render queue to %d draws!", capacity);
+		return false;
+	}
+	queue->capacity = capacity;
+	return true;
+}
+
+SGE_RenderQueue *SGE_CreateRenderQueue(int capacity)
+{
+	SGE_RenderQueue *queue = (SGE_RenderQueue*)malloc(sizeof(SGE_RenderQueue));
+	queue->commands = NULL;
+	queue->keys = NULL;
+	queue->count = 0;
+	queue->capacity = 0;
+	queue->sortKeys[0] = NULL;
+	queue->sortKeys[1] = NULL;
+	queue->sortOrder[0] = NULL;
+	queue->sortOrder[1] = NULL;
+	queue->lastDrawCalls = 0;
+	queue->lastCommandCount = 0;
+
+	if(capacity < 1)
+	{
+		capacity = 64;
+	}
+	queue->spriteBatch = SGE_CreateSpriteBatch(capacity);
+	if(queue->spriteBatch == NULL || !SGE_RenderQueueReserve(queue, capacity))
+	{
+		SGE_FreeRenderQueue(queue);
+		return NULL;
+	}
+
+	/* Draws are already sorted by the queue, the batch has to keep that order */
+	queue->spriteBatch->sortByTexture = false;
+	return queue;
+}
+
+void SGE_FreeRenderQueue(SGE_RenderQueue *queue)
+{
+	if(queue == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL render queue!");
+		return;
+	}
+	if(queue->spriteBatch != NULL)
+	{
+		SGE_FreeSpriteBatch(queue->spriteBatch);
+	}
+	free(queue->commands);
+	free(queue->keys);
+	free(queue->sortKeys[0]);
+	free(queue->sortKeys[1]);
+	free(queue->sortOrder[0]);
+	free(queue->sortOrder[1]);
+	free(queue);
+}
+
+void SGE_RenderQueueClear(SGE_RenderQueue *queue)
+{
+	queue->count = 0;
+}
+
+static SGE_RenderCommand *SGE_RenderQueueAdd(SGE_RenderQueue *queue, SGE_RenderKey key, SGE_RenderCommandType type)
+{
+	if(queue->count == queue->capacity && !SGE_RenderQueueReserve(queue, queue->capacity * 2))
+	{
+		return NULL;
+	}
+
+	SGE_RenderCommand *command = &queue->commands[queue->count];
+	command->type = type;
+	command->camera = SGE_GetCamera();
+	queue->keys[queue->count] = key;
+	queue->count++;
+	return command;
+}
+
+void SGE_RenderQueueDraw(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_Texture *texture, const SDL_Rect *clip, const SDL_FRect *dest, double rotation, SDL_RendererFlip flip)
+{
+	/* With a camera the quad is moved into screen space now, and dropped when it is out of view */
+	SDL_FRect screenDest = *dest;
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera != NULL && !SGE_CameraApply(camera, &screenDest, &rotation))
+	{
+		return;
+	}
+
+	if(texture->isStale)
+	{
+		SGE_RestoreTexture(texture);
+	}
+	if(texture->texture == NULL)
+	{
+		return;
+	}
+
+	SGE_RenderCommand *command = SGE_RenderQueueAdd(queue, SGE_MakeRenderKey(layer, depth, SGE_RENDER_COMMAND_SPRITE, texture->texture, texture->blendMode), SGE_RENDER_COMMAND_SPRITE);
+	if(command == NULL)
+	{
+		return;
+	}
+
+	/* Regions are drawn from their parent's SDL_Texture */
+	SGE_Texture *owner = (texture->parent != NULL) ? texture->parent : texture;
+
+	SGE_SpriteBatchItem *item = &command->sprite;
+	item->texture = texture->texture;
+	item->textureWidth = owner->original_w;
+	item->textureHeight = owner->original_h;
+	item->blendMode = texture->blendMode;
+	if(clip != NULL)
+	{
+		item->clip = *clip;
+	}
+	else
+	{
+		item->clip.x = texture->regionX;
+		item->clip.y = texture->regionY;
+		item->clip.w = texture->original_w;
+		item->clip.h = texture->original_h;
+	}
+	item->dest = screenDest;
+	item->rotation = rotation;
+	item->flip = flip;
+	item->color = SGE_GetTextureDrawColor(texture);
+}
+
+void SGE_RenderQueueDrawTexture(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_Texture *texture)
+{
+	SDL_FRect dest = {texture->x, texture->y, texture->w, texture->h};
+	SGE_RenderQueueDraw(queue, layer, depth, texture, &texture->clipRect, &dest, texture->rotation, texture->flip);
+}
+
+/* Primitives stay in world space, they are moved by their camera when drawn like SGE_DrawFillRect() does */
+static void SGE_RenderQueueAddPrimitive(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_RenderCommandType type, int x, int y, int w, int h, SDL_Color color)
+{
+	SDL_BlendMode blendMode = SGE_GetEngineData()->drawBlendMode;
+	SGE_RenderCommand *command = SGE_RenderQueueAdd(queue, SGE_MakeRenderKey(layer, depth, type, NULL, blendMode), type);
+	if(command == NULL)
+	{
+		return;
+	}
+	command->rect.x = x;
+	command->rect.y = y;
+	command->rect.w = w;
+	command->rect.h = h;
+	command->color = color;
+	command->blendMode = blendMode;
+}
+
+void SGE_RenderQueueFillRect(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, const SDL_Rect *rect, SDL_Color color)
+{
+	SGE_RenderQueueAddPrimitive(queue, layer, depth, SGE_RENDER_COMMAND_FILL_RECT, rect->x, rect->y, rect->w, rect->h, color);
+}
+
+void SGE_RenderQueueRect(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, const SDL_Rect *rect, SDL_Color color)
+{
+	SGE_RenderQueueAddPrimitive(queue, layer, depth, SGE_RENDER_COMMAND_RECT, rect->x, rect->y, rect->w, rect->h, color);
+}
+
+void SGE_RenderQueueLine(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, int x1, int y1, int x2, int y2, SDL_Color color)
+{
+	SGE_RenderQueueAddPrimitive(queue, layer, depth, SGE_RENDER_COMMAND_LINE, x1, y1, x2, y2, color);
+}
+
+void SGE_RenderQueueCallback(SGE_RenderQueue *queue, Uint8 layer, Uint16 depth, SGE_RenderCallback callback, void *data)
+{
+	SGE_RenderCommand *command = SGE_RenderQueueAdd(queue, SGE_MakeRenderKey(layer, depth, SGE_RENDER_COMMAND_CALLBACK, NULL, SDL_BLENDMODE_NONE), SGE_RENDER_COMMAND_CALLBACK);
+	if(command == NULL)
+	{
+		return;
+	}
+	command->callback = callback;
+	command->data = data;
+}
+
+/*
+ * Sorts the queued draws by key a byte at a time, lowest byte first, returns the command indices in drawing order.
+ * Each pass is stable, so draws with equal keys keep their queued order.
+ */
+static int *SGE_RenderQueueSort(SGE_RenderQueue *queue)
+{
+	int histograms[8][256];
+	int count = queue->count;
+	int pass = 0;
+	int i = 0;
+
+	SGE_RenderKey *keys = queue->sortKeys[0];
+	int *order = queue->sortOrder[0];
+	SGE_RenderKey *nextKeys = queue->sortKeys[1];
+	int *nextOrder = queue->sortOrder[1];
+
+	/* All the byte counts are gathered in a single pass over the keys */
+	memset(histograms, 0, sizeof(histograms));
+	for(i = 0; i < count; i++)
+	{
+		SGE_RenderKey key = queue->keys[i];
+		keys[i] = key;
+		order[i] = i;
+		for(pass = 0; pass < 8; pass++)
+		{
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	for(pass = 0; pass < 8; pass++)
+	{
+		int *histogram = histograms[pass];
+		int shift = pass * 8;
+
+		/* Bytes every key shares, like unused layers or depths, don't need a pass */
+		if(histogram[(keys[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		int offset = 0;
+		for(i = 0; i < 256; i++)
+		{
+			int bucketCount = histogram[i];
+			histogram[i] = offset;
+			offset += bucketCount;
+		}
+
+		for(i = 0; i < count; i++)
+		{
+			int target = histogram[(keys[i] >> shift) & 0xFF]++;
+			nextKeys[target] = keys[i];
+			nextOrder[target] = order[i];
+		}
+
+		SGE_RenderKey *tempKeys = keys;
+		keys = nextKeys;
+		nextKeys = tempKeys;
+		int *tempOrder = order;
+		order = nextOrder;
+		nextOrder = tempOrder;
+	}
+	return order;
+}
+
+static void SGE_RenderQueueFlushPrimitives(SGE_RenderQueue *queue)
+{
+	if(SGE_PrimitiveBatchGetCount() > 0)
+	{
+		SGE_PrimitiveBatchFlush();
+		queue->lastDrawCalls += SGE_PrimitiveBatchGetLastDrawCalls();
+	}
+}
+
+static void SGE_RenderQueueEndSprites(SGE_RenderQueue *queue, bool *isSpriteRunOpen)
+{
+	if(*isSpriteRunOpen)
+	{
+		SGE_RenderQueueFlushPrimitives(queue);
+		SGE_SpriteBatchEnd(queue->spriteBatch);
+		queue->lastDrawCalls += queue->spriteBatch->lastDrawCalls;
+		*isSpriteRunOpen = false;
+	}
+}
+
+void SGE_RenderQueueExecute(SGE_RenderQueue *queue)
+{
+	SGE_EngineData *engine = SGE_GetEngineData();
+	int i = 0;
+
+	queue->lastDrawCalls = 0;
+	queue->lastCommandCount = queue->count;
+	if(queue->count == 0)
+	{
+		return;
+	}
+
+	/* Drawing state that is changed by the queued draws and put back afterwards */
+	SGE_Camera *previousCamera = SGE_GetCamera();
+	bool wasClipEnabled = engine->isClipEnabled;
+	SDL_Rect previousClipRect = engine->clipRect;
+	SDL_BlendMode previousBlendMode = engine->drawBlendMode;
+	SDL_Color previousColor = engine->drawColor;
+
+	/* Anything drawn before the queue stays under it */
+	SGE_PrimitiveBatchFlush();
+
+	int *order = SGE_RenderQueueSort(queue);
+	SGE_Camera *camera = NULL;
+	bool isCameraSet = false;
+	bool isSpriteRunOpen = false;
+	for(i = 0; i < queue->count; i++)
+	{
+		SGE_RenderCommand *command = &queue->commands[order[i]];
+
+		/* Each camera draws only inside it's viewport, like render() does */
+		if(!isCameraSet || command->camera != camera)
+		{
+			SGE_RenderQueueEndSprites(queue, &isSpriteRunOpen);
+			camera = command->camera;
+			SGE_SetCamera(camera);
+			SGE_SetClipRect((camera != NULL) ? &camera->viewport : NULL);
+			isCameraSet = true;
+		}
+
+		if(command->type == SGE_RENDER_COMMAND_SPRITE)
+		{
+			if(!isSpriteRunOpen)
+			{
+				SGE_RenderQueueFlushPrimitives(queue);
+				SGE_SpriteBatchBegin(queue->spriteBatch);
+				isSpriteRunOpen = true;
+			}
+			SGE_SpriteBatchDrawItem(queue->spriteBatch, &command->sprite);
+			continue;
+		}
+
+		SGE_RenderQueueEndSprites(queue, &isSpriteRunOpen);
+		if(command->type == SGE_RENDER_COMMAND_CALLBACK)
+		{
+			SGE_RenderQueueFlushPrimitives(queue);
+			command->callback(command->data);
+			continue;
+		}
+
+		SGE_SetDrawBlendMode(command->blendMode);
+		SGE_SetDrawColor(command->color);
+		if(command->type == SGE_RENDER_COMMAND_FILL_RECT)
+		{
+			SGE_DrawFillRect(&command->rect);
+		}
+		else if(command->type == SGE_RENDER_COMMAND_RECT)
+		{
+			SGE_DrawRect(&command->rect);
+		}
+		else
+		{
+			SGE_DrawLine(command->rect.x, command->rect.y, command->rect.w, command->rect.h);
+		}
+	}
+	SGE_RenderQueueEndSprites(queue, &isSpriteRunOpen);
+	SGE_RenderQueueFlushPrimitives(queue);
+
+	SGE_SetCamera(previousCamera);
+	SGE_SetClipRect(wasClipEnabled ? &previousClipRect : NULL);
+	SGE_SetDrawBlendMode(previousBlendMode);
+	SGE_SetDrawColor(previousColor);
+
+	queue->count = 0;
+}
+
+SGE_RenderQueue *SGE_GetFrameRenderQueue()
+{
+	if(frameQueue == NULL)
+	{
+		frameQueue = SGE_CreateRenderQueue(256);
+	}
+	return frameQueue;
+}
+
+void SGE_RenderQueueQuit()
+{
+	if(frameQueue != NULL)
+	{
+		SGE_FreeRenderQueue(frameQueue);
+		frameQueue = NULL;
+	}
+}
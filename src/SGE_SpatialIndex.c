@@ -0,0 +1,517 @@
+#include "SGE_SpatialIndex.h"
+#include "SGE_Logger.h"
+
+#include <stdlib.h>
+
+#define SGE_SPATIAL_INDEX_DEFAULT_BUCKETS 1024
+
+SGE_SpatialIndex *SGE_CreateSpatialIndex(float cellSize, int bucketCount)
+{
+	if(cellSize <= 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Spatial index cell size has to be more than 0!");
+		return NULL;
+	}
+
+	if(bucketCount <= 0)
+	{
+		bucketCount = SGE_SPATIAL_INDEX_DEFAULT_BUCKETS;
+	}
+	int buckets = 1;
+	while(buckets < bucketCount)
+	{
+		buckets *= 2;
+	}
+
+	SGE_SpatialIndex *index = (SGE_SpatialIndex*)malloc(sizeof(SGE_SpatialIndex));
+	index->cellSize = cellSize;
+	index->buckets = (SGE_SpatialBucket*)calloc(buckets, sizeof(SGE_SpatialBucket));
+	index->bucketCount = buckets;
+	index->cellItemCount = 0;
+	index->entries = NULL;
+	index->entryCount = 0;
+	index->entryCapacity = 0;
+	index->firstFree = -1;
+	index->count = 0;
+	index->large.items = NULL;
+	index->large.count = 0;
+	index->large.capacity = 0;
+	index->queryMark = 0;
+	index->lastTests = 0;
+	return index;
+}
+
+void SGE_FreeSpatialIndex(SGE_SpatialIndex *index)
+{
+	if(index == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL spatial index!");
+		return;
+	}
+
+	int i = 0;
+	for(i = 0; i < index->bucketCount; i++)
+	{
+		free(index->buckets[i].items);
+	}
+	free(index->buckets);
+	free(index->large.items);
+	free(index->entries);
+	free(index);
+}
+
+void SGE_SpatialIndexClear(SGE_SpatialIndex *index)
+{
+	int i = 0;
+	for(i = 0; i < index->bucketCount; i++)
+	{
+		index->buckets[i].count = 0;
+	}
+	index->large.count = 0;
+	index->cellItemCount = 0;
+	index->entryCount = 0;
+	index->firstFree = -1;
+	index->count = 0;
+}
+
+static SGE_SpatialBucket *SGE_GetSpatialBucket(SGE_SpatialIndex *index, int cellX, int cellY)
+{
+	unsigned int hash = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellY * 19349663u);
+	return &index->buckets[hash & (index->bucketCount - 1)];
+}
+
+static int SGE_GetSpatialCell(SGE_SpatialIndex *index, float position)
+{
+	return (int)SDL_floorf(position / index->cellSize);
+}
+
+static bool SGE_SpatialRectsOverlap(const SDL_FRect *a, const SDL_FRect *b)
+{
+	return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static bool SGE_AddSpatialBucketItem(SGE_SpatialBucket *bucket, int cellX, int cellY, int entry)
+{
+	if(bucket->count == bucket->capacity)
+	{
+		int capacity = (bucket->capacity > 0) ? bucket->capacity * 2 : 4;
+		SGE_SpatialCellItem *items = (SGE_SpatialCellItem*)realloc(bucket->items, capacity * sizeof(SGE_SpatialCellItem));
+		if(items == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow spatial index bucket!");
+			return false;
+		}
+		bucket->items = items;
+		bucket->capacity = capacity;
+	}
+
+	bucket->items[bucket->count].cellX = cellX;
+	bucket->items[bucket->count].cellY = cellY;
+	bucket->items[bucket->count].entry = entry;
+	bucket->count++;
+	return true;
+}
+
+static bool SGE_RemoveSpatialBucketItem(SGE_SpatialBucket *bucket, int cellX, int cellY, int entry)
+{
+	int i = 0;
+	for(i = 0; i < bucket->count; i++)
+	{
+		SGE_SpatialCellItem *item = &bucket->items[i];
+		if(item->entry == entry && item->cellX == cellX && item->cellY == cellY)
+		{
+			bucket->items[i] = bucket->items[bucket->count - 1];
+			bucket->count--;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Sets the cell range of an entry from it's rect */
+static void SGE_UpdateSpatialEntryCells(SGE_SpatialIndex *index, SGE_SpatialEntry *entry)
+{
+	entry->minCellX = SGE_GetSpatialCell(index, entry->rect.x);
+	entry->minCellY = SGE_GetSpatialCell(index, entry->rect.y);
+	entry->maxCellX = SGE_GetSpatialCell(index, entry->rect.x + entry->rect.w);
+	entry->maxCellY = SGE_GetSpatialCell(index, entry->rect.y + entry->rect.h);
+	entry->isLarge = entry->maxCellX - entry->minCellX >= SGE_SPATIAL_INDEX_MAX_SPAN || entry->maxCellY - entry->minCellY >= SGE_SPATIAL_INDEX_MAX_SPAN;
+}
+
+/* Adds an entry to the cells of it's range that are not in the "skip" range, a NULL skip adds it to all of them */
+static void SGE_LinkSpatialEntry(SGE_SpatialIndex *index, int handle, const SGE_SpatialEntry *skip)
+{
+	SGE_SpatialEntry *entry = &index->entries[handle];
+	if(entry->isLarge)
+	{
+		SGE_AddSpatialBucketItem(&index->large, 0, 0, handle);
+		return;
+	}
+
+	int x = 0;
+	int y = 0;
+	for(y = entry->minCellY; y <= entry->maxCellY; y++)
+	{
+		for(x = entry->minCellX; x <= entry->maxCellX; x++)
+		{
+			if(skip != NULL && x >= skip->minCellX && x <= skip->maxCellX && y >= skip->minCellY && y <= skip->maxCellY)
+			{
+				continue;
+			}
+			if(SGE_AddSpatialBucketItem(SGE_GetSpatialBucket(index, x, y), x, y, handle))
+			{
+				index->cellItemCount++;
+			}
+		}
+	}
+}
+
+/* Removes an entry from the cells of it's range that are not in the "keep" range, a NULL keep removes it from all of them */
+static void SGE_UnlinkSpatialEntry(SGE_SpatialIndex *index, int handle, const SGE_SpatialEntry *keep)
+{
+	SGE_SpatialEntry *entry = &index->entries[handle];
+	if(entry->isLarge)
+	{
+		SGE_RemoveSpatialBucketItem(&index->large, 0, 0, handle);
+		return;
+	}
+
+	int x = 0;
+	int y = 0;
+	for(y = entry->minCellY; y <= entry->maxCellY; y++)
+	{
+		for(x = entry->minCellX; x <= entry->maxCellX; x++)
+		{
+			if(keep != NULL && x >= keep->minCellX && x <= keep->maxCellX && y >= keep->minCellY && y <= keep->maxCellY)
+			{
+				continue;
+			}
+			if(SGE_RemoveSpatialBucketItem(SGE_GetSpatialBucket(index, x, y), x, y, handle))
+			{
+				index->cellItemCount--;
+			}
+		}
+	}
+}
+
+static bool SGE_IsSpatialHandleValid(SGE_SpatialIndex *index, int handle)
+{
+	if(handle < 0 || handle >= index->entryCount || !index->entries[handle].isUsed)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Invalid spatial index handle %d!", handle);
+		return false;
+	}
+	return true;
+}
+
+int SGE_SpatialIndexInsert(SGE_SpatialIndex *index, const SDL_FRect *rect, void *data)
+{
+	int handle = index->firstFree;
+	if(handle != -1)
+	{
+		index->firstFree = index->entries[handle].nextFree;
+	}
+	else
+	{
+		if(index->entryCount == index->entryCapacity)
+		{
+			int capacity = (index->entryCapacity > 0) ? index->entryCapacity * 2 : 64;
+			SGE_SpatialEntry *entries = (SGE_SpatialEntry*)realloc(index->entries, capacity * sizeof(SGE_SpatialEntry));
+			if(entries == NULL)
+			{
+				SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow spatial index!");
+				return -1;
+			}
+			index->entries = entries;
+			index->entryCapacity = capacity;
+		}
+		handle = index->entryCount;
+		index->entryCount++;
+	}
+
+	SGE_SpatialEntry *entry = &index->entries[handle];
+	entry->rect = *rect;
+	entry->data = data;
+	entry->isUsed = true;
+	entry->queryMark = 0;
+	entry->nextFree = -1;
+	SGE_UpdateSpatialEntryCells(index, entry);
+	SGE_LinkSpatialEntry(index, handle, NULL);
+	index->count++;
+	return handle;
+}
+
+void SGE_SpatialIndexMove(SGE_SpatialIndex *index, int handle, const SDL_FRect *rect)
+{
+	if(!SGE_IsSpatialHandleValid(index, handle))
+	{
+		return;
+	}
+
+	SGE_SpatialEntry *entry = &index->entries[handle];
+	SGE_SpatialEntry old = *entry;
+	entry->rect = *rect;
+	SGE_UpdateSpatialEntryCells(index, entry);
+
+	/* Still in the same cells or in the large list, nothing else to do */
+	if(entry->isLarge && old.isLarge)
+	{
+		return;
+	}
+	if(entry->isLarge == old.isLarge && entry->minCellX == old.minCellX && entry->minCellY == old.minCellY && entry->maxCellX == old.maxCellX && entry->maxCellY == old.maxCellY)
+	{
+		return;
+	}
+
+	if(entry->isLarge || old.isLarge)
+	{
+		SGE_SpatialEntry moved = *entry;
+		*entry = old;
+		SGE_UnlinkSpatialEntry(index, handle, NULL);
+		*entry = moved;
+		SGE_LinkSpatialEntry(index, handle, NULL);
+		return;
+	}
+
+	/* Only touch the cells that were left or entered */
+	SGE_SpatialEntry moved = *entry;
+	*entry = old;
+	SGE_UnlinkSpatialEntry(index, handle, &moved);
+	*entry = moved;
+	SGE_LinkSpatialEntry(index, handle, &old);
+}
+
+void SGE_SpatialIndexRemove(SGE_SpatialIndex *index, int handle)
+{
+	if(!SGE_IsSpatialHandleValid(index, handle))
+	{
+		return;
+	}
+
+	SGE_UnlinkSpatialEntry(index, handle, NULL);
+	index->entries[handle].isUsed = false;
+	index->entries[handle].data = NULL;
+	index->entries[handle].nextFree = index->firstFree;
+	index->firstFree = handle;
+	index->count--;
+}
+
+void *SGE_SpatialIndexGetData(SGE_SpatialIndex *index, int handle)
+{
+	if(!SGE_IsSpatialHandleValid(index, handle))
+	{
+		return NULL;
+	}
+	return index->entries[handle].data;
+}
+
+const SDL_FRect *SGE_SpatialIndexGetRect(SGE_SpatialIndex *index, int handle)
+{
+	if(!SGE_IsSpatialHandleValid(index, handle))
+	{
+		return NULL;
+	}
+	return &index->entries[handle].rect;
+}
+
+/* Starts a new query, entries tested in it are marked so they are only tested once */
+static unsigned int SGE_NextSpatialQueryMark(SGE_SpatialIndex *index)
+{
+	index->queryMark++;
+	if(index->queryMark == 0)
+	{
+		int i = 0;
+		for(i = 0; i < index->entryCount; i++)
+		{
+			index->entries[i].queryMark = 0;
+		}
+		index->queryMark = 1;
+	}
+	return index->queryMark;
+}
+
+/* Tests an entry against a query area once, returns true if it overlaps */
+static bool SGE_TestSpatialEntry(SGE_SpatialIndex *index, int handle, const SDL_FRect *area, unsigned int mark)
+{
+	SGE_SpatialEntry *entry = &index->entries[handle];
+	if(entry->queryMark == mark)
+	{
+		return false;
+	}
+	entry->queryMark = mark;
+	index->lastTests++;
+	return SGE_SpatialRectsOverlap(&entry->rect, area);
+}
+
+int SGE_SpatialIndexQuery(SGE_SpatialIndex *index, const SDL_FRect *area, void (*callback)(int handle, void *data, void *userData), void *userData)
+{
+	unsigned int mark = SGE_NextSpatialQueryMark(index);
+	int found = 0;
+	int i = 0;
+	index->lastTests = 0;
+
+	int minX = SGE_GetSpatialCell(index, area->x);
+	int minY = SGE_GetSpatialCell(index, area->y);
+	int maxX = SGE_GetSpatialCell(index, area->x + area->w);
+	int maxY = SGE_GetSpatialCell(index, area->y + area->h);
+	double areaCells = ((double)maxX - minX + 1) * ((double)maxY - minY + 1);
+
+	if(areaCells > index->cellItemCount)
+	{
+		/* Visiting every cell of the area costs more than testing every entry */
+		for(i = 0; i < index->entryCount; i++)
+		{
+			if(index->entries[i].isUsed && !index->entries[i].isLarge && SGE_TestSpatialEntry(index, i, area, mark))
+			{
+				if(callback != NULL)
+				{
+					callback(i, index->entries[i].data, userData);
+				}
+				found++;
+			}
+		}
+	}
+	else
+	{
+		int x = 0;
+		int y = 0;
+		for(y = minY; y <= maxY; y++)
+		{
+			for(x = minX; x <= maxX; x++)
+			{
+				SGE_SpatialBucket *bucket = SGE_GetSpatialBucket(index, x, y);
+				for(i = 0; i < bucket->count; i++)
+				{
+					SGE_SpatialCellItem *item = &bucket->items[i];
+					if(item->cellX == x && item->cellY == y && SGE_TestSpatialEntry(index, item->entry, area, mark))
+					{
+						if(callback != NULL)
+						{
+							callback(item->entry, index->entries[item->entry].data, userData);
+						}
+						found++;
+					}
+				}
+			}
+		}
+	}
+
+	for(i = 0; i < index->large.count; i++)
+	{
+		int handle = index->large.items[i].entry;
+		if(SGE_TestSpatialEntry(index, handle, area, mark))
+		{
+			if(callback != NULL)
+			{
+				callback(handle, index->entries[handle].data, userData);
+			}
+			found++;
+		}
+	}
+
+	return found;
+}
+
+typedef struct
+{
+	SGE_SpatialIndex *index;
+	int largeHandle;
+	int found;
+	void (*callback)(int handleA, void *dataA, int handleB, void *dataB, void *userData);
+	void *userData;
+} SGE_SpatialPairQuery;
+
+static void SGE_ReportLargeSpatialPair(int handle, void *data, void *userData)
+{
+	SGE_SpatialPairQuery *query = (SGE_SpatialPairQuery*)userData;
+	SGE_SpatialIndex *index = query->index;
+
+	/* Pairs of two large rects are reported from the large list */
+	if(index->entries[handle].isLarge)
+	{
+		return;
+	}
+	if(query->callback != NULL)
+	{
+		query->callback(query->largeHandle, index->entries[query->largeHandle].data, handle, data, query->userData);
+	}
+	query->found++;
+}
+
+int SGE_SpatialIndexPairs(SGE_SpatialIndex *index, void (*callback)(int handleA, void *dataA, int handleB, void *dataB, void *userData), void *userData)
+{
+	int found = 0;
+	int tests = 0;
+	int bucketIndex = 0;
+	int i = 0;
+	int j = 0;
+
+	for(bucketIndex = 0; bucketIndex < index->bucketCount; bucketIndex++)
+	{
+		SGE_SpatialBucket *bucket = &index->buckets[bucketIndex];
+		for(i = 0; i < bucket->count; i++)
+		{
+			SGE_SpatialCellItem *itemA = &bucket->items[i];
+			for(j = i + 1; j < bucket->count; j++)
+			{
+				SGE_SpatialCellItem *itemB = &bucket->items[j];
+				if(itemA->cellX != itemB->cellX || itemA->cellY != itemB->cellY)
+				{
+					continue;
+				}
+
+				const SDL_FRect *a = &index->entries[itemA->entry].rect;
+				const SDL_FRect *b = &index->entries[itemB->entry].rect;
+				tests++;
+				if(!SGE_SpatialRectsOverlap(a, b))
+				{
+					continue;
+				}
+
+				/* Rects sharing several cells are only reported from the cell holding the top left corner of their overlap */
+				if(SGE_GetSpatialCell(index, SDL_max(a->x, b->x)) != itemA->cellX || SGE_GetSpatialCell(index, SDL_max(a->y, b->y)) != itemA->cellY)
+				{
+					continue;
+				}
+
+				if(callback != NULL)
+				{
+					callback(itemA->entry, index->entries[itemA->entry].data, itemB->entry, index->entries[itemB->entry].data, userData);
+				}
+				found++;
+			}
+		}
+	}
+
+	/* Large rects are tested against the grid with a query each, and against each other directly */
+	SGE_SpatialPairQuery query;
+	query.index = index;
+	query.callback = callback;
+	query.userData = userData;
+	query.found = 0;
+	for(i = 0; i < index->large.count; i++)
+	{
+		int handleA = index->large.items[i].entry;
+		query.largeHandle = handleA;
+		SGE_SpatialIndexQuery(index, &index->entries[handleA].rect, SGE_ReportLargeSpatialPair, &query);
+		tests += index->lastTests;
+
+		for(j = i + 1; j < index->large.count; j++)
+		{
+			int handleB = index->large.items[j].entry;
+			tests++;
+			if(SGE_SpatialRectsOverlap(&index->entries[handleA].rect, &index->entries[handleB].rect))
+			{
+				if(callback != NULL)
+				{
+					callback(handleA, index->entries[handleA].data, handleB, index->entries[handleB].data, userData);
+				}
+				found++;
+			}
+		}
+	}
+
+	found += query.found;
+	index->lastTests = tests;
+	return found;
+}
@@ -0,0 +1,345 @@
+#include "SGE_SpriteBatch.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+#include "SGE_PrimitiveBatch.h"
+#include "SGE_Camera.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Items of the batch being sorted, qsort() has no way to pass them to the compare function */
+static SGE_SpriteBatchItem *sortItems = NULL;
+
+/* Orders items by texture, then blend mode, then submission order to keep the sort stable */
+static int SGE_SpriteBatchCompare(const void *a, const void *b)
+{
+	int indexA = *(const int *)a;
+	int indexB = *(const int *)b;
+	const SGE_SpriteBatchItem *itemA = &sortItems[indexA];
+	const SGE_SpriteBatchItem *itemB = &sortItems[indexB];
+
+	if(itemA->texture != itemB->texture)
+	{
+		return ((uintptr_t)itemA->texture < (uintptr_t)itemB->texture) ? -1 : 1;
+	}
+	if(itemA->blendMode != itemB->blendMode)
+	{
+		return (itemA->blendMode < itemB->blendMode) ? -1 : 1;
+	}
+	return indexA - indexB;
+}
+
+/* Grows all the batch's buffers to hold at least "capacity" quads */
+static bool SGE_SpriteBatchReserve(SGE_SpriteBatch *batch, int capacity)
+{
+	if(capacity <= batch->capacity)
+	{
+		return true;
+	}
+
+	SGE_SpriteBatchItem *items = (SGE_SpriteBatchItem*)realloc(batch->items, capacity * sizeof(SGE_SpriteBatchItem));
+	int *order = (int*)realloc(batch->order, capacity * sizeof(int));
+	if(items != NULL) batch->items = items;
+	if(order != NULL) batch->order = order;
+	if(items == NULL || order == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow sprite batch to %d sprites!", capacity);
+		return false;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_Vertex *vertices = (SDL_Vertex*)realloc(batch->vertices, capacity * 4 * sizeof(SDL_Vertex));
+	int *indices = (int*)realloc(batch->indices, capacity * 6 * sizeof(int));
+	if(vertices != NULL) batch->vertices = vertices;
+	if(indices != NULL) batch->indices = indices;
+	if(vertices == NULL || indices == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow sprite batch to %d sprites!", capacity);
+		return false;
+	}
+
+	/* The index pattern is the same for every quad, so it only has to be written once */
+	int i = 0;
+	for(i = batch->capacity; i < capacity; i++)
+	{
+		batch->indices[i * 6 + 0] = i * 4 + 0;
+		batch->indices[i * 6 + 1] = i * 4 + 1;
+		batch->indices[i * 6 + 2] = i * 4 + 2;
+		batch->indices[i * 6 + 3] = i * 4 + 2;
+		batch->indices[i * 6 + 4] = i * 4 + 3;
+		batch->indices[i * 6 + 5] = i * 4 + 0;
+	}
+#endif
+
+	batch->capacity = capacity;
+	return true;
+}
+
+SGE_SpriteBatch *SGE_CreateSpriteBatch(int capacity)
+{
+	SGE_SpriteBatch *batch = (SGE_SpriteBatch*)malloc(sizeof(SGE_SpriteBatch));
+	batch->items = NULL;
+	batch->itemCount = 0;
+	batch->capacity = 0;
+	batch->order = NULL;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	batch->vertices = NULL;
+	batch->indices = NULL;
+#endif
+	batch->sortByTexture = true;
+	batch->lastDrawCalls = 0;
+
+	if(capacity < 1)
+	{
+		capacity = 64;
+	}
+	if(!SGE_SpriteBatchReserve(batch, capacity))
+	{
+		SGE_FreeSpriteBatch(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+void SGE_FreeSpriteBatch(SGE_SpriteBatch *batch)
+{
+	if(batch == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL sprite batch!");
+		return;
+	}
+	free(batch->items);
+	free(batch->order);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	free(batch->vertices);
+	free(batch->indices);
+#endif
+	free(batch);
+}
+
+void SGE_SpriteBatchBegin(SGE_SpriteBatch *batch)
+{
+	batch->itemCount = 0;
+}
+
+void SGE_SpriteBatchDraw(SGE_SpriteBatch *batch, SGE_Texture *texture, const SDL_Rect *clip, const SDL_FRect *dest, double rotation, SDL_RendererFlip flip)
+{
+	/* With a camera the quad is moved into screen space now, and dropped when it is out of view */
+	SDL_FRect screenDest = *dest;
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera != NULL && !SGE_CameraApply(camera, &screenDest, &rotation))
+	{
+		return;
+	}
+	
+	if(texture->isStale)
+	{
+		SGE_RestoreTexture(texture);
+	}
+	if(texture->texture == NULL)
+	{
+		return;
+	}
+
+	if(batch->itemCount == batch->capacity && !SGE_SpriteBatchReserve(batch, batch->capacity * 2))
+	{
+		return;
+	}
+
+	/* Regions are drawn from their parent's SDL_Texture */
+	SGE_Texture *owner = (texture->parent != NULL) ? texture->parent : texture;
+	
+	SGE_SpriteBatchItem *item = &batch->items[batch->itemCount];
+	item->texture = texture->texture;
+	item->textureWidth = owner->original_w;
+	item->textureHeight = owner->original_h;
+	item->blendMode = texture->blendMode;
+	if(clip != NULL)
+	{
+		item->clip = *clip;
+	}
+	else
+	{
+		item->clip.x = texture->regionX;
+		item->clip.y = texture->regionY;
+		item->clip.w = texture->original_w;
+		item->clip.h = texture->original_h;
+	}
+	item->dest = screenDest;
+	item->rotation = rotation;
+	item->flip = flip;
+	item->color = SGE_GetTextureDrawColor(texture);
+	batch->itemCount++;
+}
+
+void SGE_SpriteBatchDrawItem(SGE_SpriteBatch *batch, const SGE_SpriteBatchItem *item)
+{
+	if(batch->itemCount == batch->capacity && !SGE_SpriteBatchReserve(batch, batch->capacity * 2))
+	{
+		return;
+	}
+	batch->items[batch->itemCount] = *item;
+	batch->itemCount++;
+}
+
+void SGE_SpriteBatchDrawTexture(SGE_SpriteBatch *batch, SGE_Texture *texture)
+{
+	SDL_FRect dest = {texture->x, texture->y, texture->w, texture->h};
+	SGE_SpriteBatchDraw(batch, texture, &texture->clipRect, &dest, texture->rotation, texture->flip);
+}
+
+void SGE_SpriteBatchDrawAnimatedSprite(SGE_SpriteBatch *batch, SGE_AnimatedSprite *sprite)
+{
+	SGE_UpdateAnimatedSpriteFrame(sprite);
+	SGE_SpriteBatchDrawTexture(batch, sprite->texture);
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/* Writes the four corners of an item, rotated around the center of it's destination like SDL_RenderCopyEx() */
+static void SGE_SpriteBatchBuildQuad(const SGE_SpriteBatchItem *item, SDL_Vertex *quad)
+{
+	float u0 = (float)item->clip.x / item->textureWidth;
+	float v0 = (float)item->clip.y / item->textureHeight;
+	float u1 = (float)(item->clip.x + item->clip.w) / item->textureWidth;
+	float v1 = (float)(item->clip.y + item->clip.h) / item->textureHeight;
+	float temp = 0;
+	if(item->flip & SDL_FLIP_HORIZONTAL)
+	{
+		temp = u0; u0 = u1; u1 = temp;
+	}
+	if(item->flip & SDL_FLIP_VERTICAL)
+	{
+		temp = v0; v0 = v1; v1 = temp;
+	}
+
+	float halfW = item->dest.w / 2.0f;
+	float halfH = item->dest.h / 2.0f;
+	float centerX = item->dest.x + halfW;
+	float centerY = item->dest.y + halfH;
+	float cornersX[4] = {-halfW, halfW, halfW, -halfW};
+	float cornersY[4] = {-halfH, -halfH, halfH, halfH};
+	float cornersU[4] = {u0, u1, u1, u0};
+	float cornersV[4] = {v0, v0, v1, v1};
+
+	float c = 1.0f;
+	float s = 0.0f;
+	if(item->rotation != 0)
+	{
+		float radians = (float)(item->rotation * M_PI / 180.0);
+		c = SDL_cosf(radians);
+		s = SDL_sinf(radians);
+	}
+
+	int i = 0;
+	for(i = 0; i < 4; i++)
+	{
+		quad[i].position.x = centerX + cornersX[i] * c - cornersY[i] * s;
+		quad[i].position.y = centerY + cornersX[i] * s + cornersY[i] * c;
+		quad[i].tex_coord.x = cornersU[i];
+		quad[i].tex_coord.y = cornersV[i];
+		/* Geometry ignores the texture's color and alpha mod, so they go into the vertex color */
+		quad[i].color = item->color;
+	}
+}
+#endif
+
+void SGE_SpriteBatchEnd(SGE_SpriteBatch *batch)
+{
+	SDL_Renderer *renderer = SGE_GetEngineData()->renderer;
+	int i = 0;
+
+	batch->lastDrawCalls = 0;
+	if(batch->itemCount == 0)
+	{
+		return;
+	}
+
+	/* Draw queued primitives first to keep the drawing order */
+	if(SGE_PrimitiveBatchGetCount() > 0)
+	{
+		SGE_PrimitiveBatchFlush();
+	}
+	
+	for(i = 0; i < batch->itemCount; i++)
+	{
+		batch->order[i] = i;
+	}
+	if(batch->sortByTexture)
+	{
+		sortItems = batch->items;
+		qsort(batch->order, batch->itemCount, sizeof(int), SGE_SpriteBatchCompare);
+		sortItems = NULL;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	for(i = 0; i < batch->itemCount; i++)
+	{
+		SGE_SpriteBatchBuildQuad(&batch->items[batch->order[i]], &batch->vertices[i * 4]);
+	}
+
+	/* Submit every run of quads sharing a texture and blend mode in one call */
+	int runStart = 0;
+	while(runStart < batch->itemCount)
+	{
+		SGE_SpriteBatchItem *first = &batch->items[batch->order[runStart]];
+		int runEnd = runStart + 1;
+		while(runEnd < batch->itemCount)
+		{
+			SGE_SpriteBatchItem *next = &batch->items[batch->order[runEnd]];
+			if(next->texture != first->texture || next->blendMode != first->blendMode)
+			{
+				break;
+			}
+			runEnd++;
+		}
+
+		/* The texture's own blend mode is put back for drawing it outside the batch */
+		SDL_BlendMode savedBlendMode = SDL_BLENDMODE_BLEND;
+		SDL_GetTextureBlendMode(first->texture, &savedBlendMode);
+		/* Blended quads write premultiplied color while premultiplied drawing is on */
+		SDL_SetTextureBlendMode(first->texture, SGE_MapDrawBlendMode(first->blendMode));
+		SDL_RenderGeometry(renderer, first->texture, &batch->vertices[runStart * 4], (runEnd - runStart) * 4, batch->indices, (runEnd - runStart) * 6);
+		SDL_SetTextureBlendMode(first->texture, savedBlendMode);
+		batch->lastDrawCalls++;
+		runStart = runEnd;
+	}
+#else
+	/*
+	 * No geometry support, copy each quad on it's own.
+	 * Every run of quads sharing a texture puts back the texture's own modulation when it's done,
+	 * for drawing it outside the batch.
+	 */
+	Uint8 savedColor[4] = {255, 255, 255, 255};
+	SDL_BlendMode savedBlendMode = SDL_BLENDMODE_BLEND;
+	for(i = 0; i < batch->itemCount; i++)
+	{
+		SGE_SpriteBatchItem *item = &batch->items[batch->order[i]];
+		if(i == 0 || batch->items[batch->order[i - 1]].texture != item->texture)
+		{
+			SDL_GetTextureColorMod(item->texture, &savedColor[0], &savedColor[1], &savedColor[2]);
+			SDL_GetTextureAlphaMod(item->texture, &savedColor[3]);
+			SDL_GetTextureBlendMode(item->texture, &savedBlendMode);
+		}
+
+		/* Rounded like SGE_RenderTexture() does */
+		SDL_Rect dest;
+		dest.x = (int)SDL_floorf(item->dest.x + 0.5f);
+		dest.y = (int)SDL_floorf(item->dest.y + 0.5f);
+		dest.w = (int)SDL_floorf(item->dest.x + item->dest.w + 0.5f) - dest.x;
+		dest.h = (int)SDL_floorf(item->dest.y + item->dest.h + 0.5f) - dest.y;
+		SDL_SetTextureColorMod(item->texture, item->color.r, item->color.g, item->color.b);
+		SDL_SetTextureAlphaMod(item->texture, item->color.a);
+		SDL_SetTextureBlendMode(item->texture, SGE_MapDrawBlendMode(item->blendMode));
+		SDL_RenderCopyEx(renderer, item->texture, &item->clip, &dest, item->rotation, NULL, item->flip);
+		batch->lastDrawCalls++;
+
+		if(i == batch->itemCount - 1 || batch->items[batch->order[i + 1]].texture != item->texture)
+		{
+			SDL_SetTextureColorMod(item->texture, savedColor[0], savedColor[1], savedColor[2]);
+			SDL_SetTextureAlphaMod(item->texture, savedColor[3]);
+			SDL_SetTextureBlendMode(item->texture, savedBlendMode);
+		}
+	}
+#endif
+}
@@ -0,0 +1,410 @@
+#include "SGE_SpriteSheet.h"
+#include "SGE_Logger.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Builds "[prefix][suffix]" in a new heap allocated string */
+static char *SGE_JoinPath(const char *prefix, int prefixLength, const char *suffix)
+{
+	char *path = (char*)malloc(prefixLength + strlen(suffix) + 1);
+	memcpy(path, prefix, prefixLength);
+	strcpy(path + prefixLength, suffix);
+	return path;
+}
+
+/* Returns the length of the folder part of a path, including the last separator */
+static int SGE_GetFolderLength(const char *path)
+{
+	int length = strlen(path);
+	while(length > 0 && path[length - 1] != '/' && path[length - 1] != '\\')
+	{
+		length--;
+	}
+	return length;
+}
+
+SGE_SpriteSheet *SGE_LoadSpriteSheet(const char *path)
+{
+	SDL_RWops *file = SDL_RWFromFile(path, "rb");
+	if(file == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to open sprite sheet: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return NULL;
+	}
+
+	char magic[4];
+	if(SDL_RWread(file, magic, 4, 1) != 1 || memcmp(magic, "SGES", 4) != 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "%s is not a sprite sheet!", path);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	int version = SDL_ReadLE16(file);
+	if(version != SGE_SPRITE_SHEET_VERSION)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Sprite sheet %s has unsupported version %d!", path, version);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	int frameCount = SDL_ReadLE16(file);
+	int nameLength = SDL_ReadLE16(file);
+	char *name = (char*)malloc(nameLength + 1);
+	if(frameCount == 0 || SDL_RWread(file, name, 1, nameLength) != (size_t)nameLength)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Sprite sheet %s is corrupt!", path);
+		free(name);
+		SDL_RWclose(file);
+		return NULL;
+	}
+	name[nameLength] = '\0';
+
+	SGE_SpriteSheet *sheet = (SGE_SpriteSheet*)malloc(sizeof(SGE_SpriteSheet));
+	sheet->imagePath = SGE_JoinPath(path, SGE_GetFolderLength(path), name);
+	sheet->frameCount = frameCount;
+	sheet->frames = (SGE_SpriteSheetFrame*)malloc(frameCount * sizeof(SGE_SpriteSheetFrame));
+	free(name);
+
+	int i = 0;
+	for(i = 0; i < frameCount; i++)
+	{
+		SGE_SpriteSheetFrame *frame = &sheet->frames[i];
+		frame->rect.x = SDL_ReadLE16(file);
+		frame->rect.y = SDL_ReadLE16(file);
+		frame->rect.w = SDL_ReadLE16(file);
+		frame->rect.h = SDL_ReadLE16(file);
+		frame->offsetX = (Sint16)SDL_ReadLE16(file);
+		frame->offsetY = (Sint16)SDL_ReadLE16(file);
+		frame->sourceW = SDL_ReadLE16(file);
+		frame->sourceH = SDL_ReadLE16(file);
+		frame->pivotX = (Sint16)SDL_ReadLE16(file);
+		frame->pivotY = (Sint16)SDL_ReadLE16(file);
+		frame->duration = SDL_ReadLE16(file);
+	}
+
+	/* SDL_ReadLE16() returns 0 past the end, so a short file only shows as missing data */
+	if(SDL_RWtell(file) != SDL_RWsize(file))
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Sprite sheet %s is corrupt!", path);
+		SGE_FreeSpriteSheet(sheet);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	SDL_RWclose(file);
+	return sheet;
+}
+
+void SGE_FreeSpriteSheet(SGE_SpriteSheet *sheet)
+{
+	if(sheet == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL sprite sheet!");
+		return;
+	}
+	free(sheet->imagePath);
+	free(sheet->frames);
+	free(sheet);
+}
+
+/* Finds the smallest rect holding all the non transparent pixels of an RGBA32 surface */
+static SDL_Rect SGE_TrimSurface(SDL_Surface *surface)
+{
+	SDL_Rect trim = {surface->w, surface->h, 0, 0};
+	int right = -1;
+	int bottom = -1;
+	int x = 0;
+	int y = 0;
+
+	for(y = 0; y < surface->h; y++)
+	{
+		const Uint8 *row = (const Uint8*)surface->pixels + y * surface->pitch;
+		for(x = 0; x < surface->w; x++)
+		{
+			if(row[x * 4 + 3] != 0)
+			{
+				if(x < trim.x) trim.x = x;
+				if(y < trim.y) trim.y = y;
+				if(x > right) right = x;
+				if(y > bottom) bottom = y;
+			}
+		}
+	}
+
+	/* Fully transparent frames keep a single pixel */
+	if(right < 0)
+	{
+		trim.x = 0;
+		trim.y = 0;
+		trim.w = 1;
+		trim.h = 1;
+		return trim;
+	}
+	trim.w = right - trim.x + 1;
+	trim.h = bottom - trim.y + 1;
+	return trim;
+}
+
+/* Frames being packed, sorted by height */
+static const SDL_Rect *packTrims = NULL;
+
+static int SGE_SpriteSheetCompare(const void *a, const void *b)
+{
+	int indexA = *(const int*)a;
+	int indexB = *(const int*)b;
+	if(packTrims[indexA].h != packTrims[indexB].h)
+	{
+		return packTrims[indexB].h - packTrims[indexA].h;
+	}
+	return indexA - indexB;
+}
+
+/*
+ * Packs the trimmed frames into rows on a sheet "width" pixels wide, tallest frames first.
+ * Returns the sheet height, or -1 if a frame doesn't fit the width.
+ */
+static int SGE_SpriteSheetPackRows(const SDL_Rect *trims, const int *order, int count, int width, SDL_Rect *placed)
+{
+	const int padding = 1;
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	int i = 0;
+
+	for(i = 0; i < count; i++)
+	{
+		const SDL_Rect *trim = &trims[order[i]];
+		if(trim->w > width)
+		{
+			return -1;
+		}
+		if(x + trim->w > width)
+		{
+			x = 0;
+			y += rowHeight + padding;
+			rowHeight = 0;
+		}
+		placed[order[i]].x = x;
+		placed[order[i]].y = y;
+		placed[order[i]].w = trim->w;
+		placed[order[i]].h = trim->h;
+		x += trim->w + padding;
+		if(trim->h > rowHeight)
+		{
+			rowHeight = trim->h;
+		}
+	}
+	return y + rowHeight;
+}
+
+/* Writes the sheet metadata next to the sheet image */
+static bool SGE_WriteSpriteSheet(const char *path, const char *imageName, SGE_SpriteSheetFrame *frames, int frameCount)
+{
+	SDL_RWops *file = SDL_RWFromFile(path, "wb");
+	if(file == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create sprite sheet: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
+	}
+
+	int nameLength = strlen(imageName);
+	SDL_RWwrite(file, "SGES", 4, 1);
+	SDL_WriteLE16(file, SGE_SPRITE_SHEET_VERSION);
+	SDL_WriteLE16(file, frameCount);
+	SDL_WriteLE16(file, nameLength);
+	SDL_RWwrite(file, imageName, 1, nameLength);
+
+	int i = 0;
+	for(i = 0; i < frameCount; i++)
+	{
+		SGE_SpriteSheetFrame *frame = &frames[i];
+		SDL_WriteLE16(file, frame->rect.x);
+		SDL_WriteLE16(file, frame->rect.y);
+		SDL_WriteLE16(file, frame->rect.w);
+		SDL_WriteLE16(file, frame->rect.h);
+		SDL_WriteLE16(file, (Uint16)frame->offsetX);
+		SDL_WriteLE16(file, (Uint16)frame->offsetY);
+		SDL_WriteLE16(file, frame->sourceW);
+		SDL_WriteLE16(file, frame->sourceH);
+		SDL_WriteLE16(file, (Uint16)frame->pivotX);
+		SDL_WriteLE16(file, (Uint16)frame->pivotY);
+		SDL_WriteLE16(file, frame->duration);
+	}
+
+	SDL_RWclose(file);
+	return true;
+}
+
+/* Loads and trims the frames 1.png ... [nFrames].png, the surfaces are left NULL from the first frame that fails */
+static bool SGE_SpriteSheetLoadFrames(const char *folderPath, int nFrames, int frameDuration, SDL_Surface **surfaces, SDL_Rect *trims, SGE_SpriteSheetFrame *frames)
+{
+	char *path = (char*)malloc(strlen(folderPath) + 16);
+	int i = 0;
+
+	for(i = 0; i < nFrames; i++)
+	{
+		sprintf(path, "%s/%d.png", folderPath, i + 1);
+		SDL_Surface *loaded = IMG_Load(path);
+		if(loaded == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load frame: %s!", path);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+			free(path);
+			return false;
+		}
+		surfaces[i] = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+		if(surfaces[i] == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to convert frame: %s!", path);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+			free(path);
+			return false;
+		}
+
+		trims[i] = SGE_TrimSurface(surfaces[i]);
+		frames[i].offsetX = trims[i].x;
+		frames[i].offsetY = trims[i].y;
+		frames[i].sourceW = surfaces[i]->w;
+		frames[i].sourceH = surfaces[i]->h;
+		frames[i].pivotX = surfaces[i]->w / 2;
+		frames[i].pivotY = surfaces[i]->h / 2;
+		frames[i].duration = frameDuration;
+	}
+
+	free(path);
+	return true;
+}
+
+/* Packs the trimmed frames into a new sheet surface no larger than maxSize, and stores where each frame went */
+static SDL_Surface *SGE_SpriteSheetPack(SDL_Surface **surfaces, const SDL_Rect *trims, SGE_SpriteSheetFrame *frames, int nFrames, int maxSize)
+{
+	SDL_Rect *placed = (SDL_Rect*)malloc(nFrames * sizeof(SDL_Rect));
+	int *order = (int*)malloc(nFrames * sizeof(int));
+	int area = 0;
+	int widest = 0;
+	int i = 0;
+
+	for(i = 0; i < nFrames; i++)
+	{
+		order[i] = i;
+		area += (trims[i].w + 1) * (trims[i].h + 1);
+		if(trims[i].w > widest)
+		{
+			widest = trims[i].w;
+		}
+	}
+
+	packTrims = trims;
+	qsort(order, nFrames, sizeof(int), SGE_SpriteSheetCompare);
+	packTrims = NULL;
+
+	/* Start from a square sheet and widen it until the rows fit under the height limit */
+	int width = 64;
+	int height = -1;
+	while(width * width < area || width < widest)
+	{
+		width *= 2;
+	}
+	while(width <= maxSize)
+	{
+		height = SGE_SpriteSheetPackRows(trims, order, nFrames, width, placed);
+		if(height >= 0 && height <= maxSize)
+		{
+			break;
+		}
+		width *= 2;
+	}
+
+	SDL_Surface *sheetSurface = NULL;
+	if(width > maxSize)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Frames don't fit a %dx%d sprite sheet!", maxSize, maxSize);
+	}
+	else
+	{
+		sheetSurface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+		if(sheetSurface == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create sprite sheet surface! SDL_Error: %s", SDL_GetError());
+		}
+	}
+
+	if(sheetSurface != NULL)
+	{
+		for(i = 0; i < nFrames; i++)
+		{
+			/* Copy the pixels as they are instead of blending them onto the empty sheet */
+			SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surfaces[i], (SDL_Rect*)&trims[i], sheetSurface, &placed[i]);
+			frames[i].rect = placed[i];
+		}
+	}
+
+	free(placed);
+	free(order);
+	return sheetSurface;
+}
+
+bool SGE_BuildSpriteSheet(const char *folderPath, int nFrames, const char *outputPath, int frameDuration, int maxSize)
+{
+	SDL_Surface **surfaces = (SDL_Surface**)calloc(nFrames, sizeof(SDL_Surface*));
+	SGE_SpriteSheetFrame *frames = (SGE_SpriteSheetFrame*)calloc(nFrames, sizeof(SGE_SpriteSheetFrame));
+	SDL_Rect *trims = (SDL_Rect*)malloc(nFrames * sizeof(SDL_Rect));
+	SDL_Surface *sheetSurface = NULL;
+	bool success = false;
+	int i = 0;
+
+	if(maxSize <= 0)
+	{
+		maxSize = 4096;
+	}
+
+	if(SGE_SpriteSheetLoadFrames(folderPath, nFrames, frameDuration, surfaces, trims, frames))
+	{
+		sheetSurface = SGE_SpriteSheetPack(surfaces, trims, frames, nFrames, maxSize);
+	}
+
+	if(sheetSurface != NULL)
+	{
+		char *imagePath = SGE_JoinPath(outputPath, strlen(outputPath), ".png");
+		char *sheetPath = SGE_JoinPath(outputPath, strlen(outputPath), ".sgesheet");
+		if(IMG_SavePNG(sheetSurface, imagePath) != 0)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to save sprite sheet image: %s!", imagePath);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+		}
+		else
+		{
+			/* The metadata stores the image name relative to itself */
+			success = SGE_WriteSpriteSheet(sheetPath, imagePath + SGE_GetFolderLength(imagePath), frames, nFrames);
+		}
+
+		if(success)
+		{
+			SGE_LogPrintLine(SGE_LOG_INFO, "Packed %d frames into a %dx%d sprite sheet: %s", nFrames, sheetSurface->w, sheetSurface->h, sheetPath);
+		}
+		free(imagePath);
+		free(sheetPath);
+		SDL_FreeSurface(sheetSurface);
+	}
+
+	for(i = 0; i < nFrames; i++)
+	{
+		if(surfaces[i] != NULL)
+		{
+			SDL_FreeSurface(surfaces[i]);
+		}
+	}
+	free(surfaces);
+	free(frames);
+	free(trims);
+	return success;
+}
@@ -1,11 +1,16 @@
 #include "SGE_Texture.h"
 #include "SGE.h"
 #include "SGE_Logger.h"
+#include "SGE_PrimitiveBatch.h"
+#include "SGE_TextureAtlas.h"
+#include "SGE_TextureFile.h"
+#include "SGE_Camera.h"
 
 #include <SDL2/SDL_image.h>
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 /* Background color for Shaded text mode. Default is transparent white. */
 static SDL_Color fontBGColor = {255, 255, 255, 1};
@@ -13,6 +18,11 @@ static SDL_Color fontBGColor = {255, 255, 255, 1};
 /* Word wrap in pixels for Blended text mode. */
 static int wordWrap = 500;
 
+/* List of all live textures, used to upload them again when the renderer loses them */
+static SGE_Texture *textureList = NULL;
+static int textureCount = 0;
+static size_t textureMemory = 0;
+
 void SGE_SetTextureFontBGColor(SDL_Color bgColor)
 {
 	fontBGColor = bgColor;
@@ -40,151 +50,965 @@ void SGE_EmptyTextureData(SGE_Texture *gTexture)
 	gTexture->destRect.y = 0;
 	gTexture->destRect.w = 0;
 	gTexture->destRect.h = 0;
+	gTexture->drawnRect = gTexture->destRect;
 	
 	gTexture->clipRect.x = 0;
 	gTexture->clipRect.y = 0;
 	gTexture->clipRect.w = 0;
 	gTexture->clipRect.h = 0;
+	
+	gTexture->colorMod.r = 255;
+	gTexture->colorMod.g = 255;
+	gTexture->colorMod.b = 255;
+	gTexture->colorMod.a = 255;
+	gTexture->blendMode = SDL_BLENDMODE_BLEND;
+	
+	gTexture->source = SGE_TEXTURE_SOURCE_NONE;
+	gTexture->sourcePath = NULL;
+	gTexture->sourceText = NULL;
+	gTexture->sourceFont = NULL;
+	gTexture->sourceTextMode = SGE_TEXT_MODE_BLENDED;
+	gTexture->sourceWordWrap = 0;
+	gTexture->sourcePixels = NULL;
+	
+	gTexture->isStale = false;
+	gTexture->loadState = SGE_TEXTURE_READY;
+	gTexture->memorySize = 0;
+	
+	gTexture->parent = NULL;
+	gTexture->regionCount = 0;
+	gTexture->regionX = 0;
+	gTexture->regionY = 0;
+	gTexture->atlas = NULL;
+	
+	gTexture->prev = NULL;
+	gTexture->next = NULL;
 }
 
-SGE_Texture* SGE_LoadTexture(const char *path)
+/* Returns a heap allocated copy of a string */
+static char *SGE_CopyString(const char *str)
 {
-	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
+	char *copy = (char*)malloc(strlen(str) + 1);
+	strcpy(copy, str);
+	return copy;
+}
+
+/* Adds a texture to the live texture list */
+static void SGE_TrackTexture(SGE_Texture *gTexture)
+{
+	gTexture->prev = NULL;
+	gTexture->next = textureList;
+	if(textureList != NULL)
+	{
+		textureList->prev = gTexture;
+	}
+	textureList = gTexture;
+	textureCount++;
+}
+
+/* Removes a texture from the live texture list */
+static void SGE_UntrackTexture(SGE_Texture *gTexture)
+{
+	if(gTexture->prev != NULL)
+	{
+		gTexture->prev->next = gTexture->next;
+	}
+	else
+	{
+		textureList = gTexture->next;
+	}
 	
-	SGE_EmptyTextureData(gTexture);
+	if(gTexture->next != NULL)
+	{
+		gTexture->next->prev = gTexture->prev;
+	}
+	gTexture->prev = NULL;
+	gTexture->next = NULL;
+	textureCount--;
+}
+
+/* Points the texture's regions at it's current SDL_Texture after it was created again or released */
+static void SGE_UpdateRegionTextures(SGE_Texture *gTexture)
+{
+	SGE_Texture *current = textureList;
+	int found = 0;
 	
+	while(current != NULL && found < gTexture->regionCount)
+	{
+		if(current->parent == gTexture)
+		{
+			current->texture = gTexture->texture;
+			found++;
+		}
+		current = current->next;
+	}
+}
+
+/* Releases the texture's SDL_Texture, or only forgets it if it was already destroyed with it's renderer */
+static void SGE_ReleaseTextureData(SGE_Texture *gTexture, bool destroy)
+{
+	/* Regions don't own their SDL_Texture */
+	if(destroy && gTexture->texture != NULL && gTexture->parent == NULL)
+	{
+		SDL_DestroyTexture(gTexture->texture);
+	}
+	gTexture->texture = NULL;
+	textureMemory -= gTexture->memorySize;
+	gTexture->memorySize = 0;
+	if(gTexture->regionCount > 0)
+	{
+		SGE_UpdateRegionTextures(gTexture);
+	}
+}
+
+/* Renders text into a new surface using the given text settings */
+static SDL_Surface *SGE_RenderTextSurface(const char *text, TTF_Font *font, SDL_Color fg, SDL_Color bg, SGE_TextRenderMode textMode, int wrap)
+{
 	SDL_Surface *tempSurface = NULL;
-	tempSurface = IMG_Load(path);
+	
+	if(textMode == SGE_TEXT_MODE_SOLID)
+	{
+		tempSurface = TTF_RenderText_Solid(font, text, fg);
+	}
+	else if(textMode == SGE_TEXT_MODE_SHADED)
+	{
+		tempSurface = TTF_RenderText_Shaded(font, text, fg, bg);
+	}
+	else
+	{
+		tempSurface = TTF_RenderText_Blended_Wrapped(font, text, fg, wrap);
+	}
+	
 	if(tempSurface == NULL)
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load image: %s!", path, IMG_GetError());
-		SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
-		free(gTexture);
-		return NULL;
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to render text surface!");
+		SGE_LogPrintLine(SGE_LOG_ERROR, "TTF_Error: %s", TTF_GetError());
+	}
+	return tempSurface;
+}
+
+/* Premultiplied colors are drawn as they are and only fade when the color mod is scaled by the alpha mod too */
+SDL_Color SGE_GetTextureDrawColor(SGE_Texture *gTexture)
+{
+	SDL_Color color = gTexture->colorMod;
+	if(gTexture->blendMode == SGE_GetPremultipliedBlendMode())
+	{
+		color.r = (Uint8)(color.r * color.a / 255);
+		color.g = (Uint8)(color.g * color.a / 255);
+		color.b = (Uint8)(color.b * color.a / 255);
+	}
+	return color;
+}
+
+/* Applies the texture's color and alpha mods to it's SDL_Texture */
+static void SGE_ApplyTextureMods(SGE_Texture *gTexture)
+{
+	SDL_Color color = SGE_GetTextureDrawColor(gTexture);
+	SDL_SetTextureColorMod(gTexture->texture, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(gTexture->texture, color.a);
+}
+
+void SGE_RestoreTextureMods(SGE_Texture *gTexture)
+{
+	SDL_SetTextureBlendMode(gTexture->texture, gTexture->blendMode);
+	SGE_ApplyTextureMods(gTexture);
+}
+
+/*
+ * Counts the memory of a newly created SDL_Texture.
+ * A new texture keeps the blend mode it was created with,
+ * otherwise the texture's previous modulation and blend mode are applied again.
+ */
+static void SGE_FinishTextureUpload(SGE_Texture *gTexture, bool restoreMods)
+{
+	Uint32 format = 0;
+	int w = 0;
+	int h = 0;
+	SDL_QueryTexture(gTexture->texture, &format, NULL, &w, &h);
+	gTexture->memorySize = (size_t)w * h * (SDL_ISPIXELFORMAT_FOURCC(format) ? 2 : SDL_BYTESPERPIXEL(format));
+	textureMemory += gTexture->memorySize;
+	gTexture->isStale = false;
+	if(gTexture->regionCount > 0)
+	{
+		SGE_UpdateRegionTextures(gTexture);
+	}
+	
+	if(restoreMods)
+	{
+		SGE_RestoreTextureMods(gTexture);
+	}
+	else
+	{
+		SDL_GetTextureBlendMode(gTexture->texture, &gTexture->blendMode);
+	}
+}
+
+/*
+ * Creates the texture's SDL_Texture from a surface and frees the surface.
+ * A new texture takes the blend mode SDL picked for the surface.
+ */
+static bool SGE_UploadTextureSurface(SGE_Texture *gTexture, SDL_Surface *surface, bool restoreMods)
+{
+	gTexture->texture = SDL_CreateTextureFromSurface(SGE_GetEngineData()->renderer, surface);
+	SDL_FreeSurface(surface);
+	if(gTexture->texture == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from image!");
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
+	}
+	
+	SGE_FinishTextureUpload(gTexture, restoreMods);
+	return true;
+}
+
+/*
+ * Creates the texture's SDL_Texture from the pixels of a texture file and closes the file.
+ * The pixels are uploaded as they are, a new texture with premultiplied pixels gets a premultiplied blend mode.
+ */
+static bool SGE_UploadTextureFile(SGE_Texture *gTexture, SGE_TextureFile *file, bool restoreMods)
+{
+	gTexture->texture = SDL_CreateTexture(SGE_GetEngineData()->renderer, SDL_PIXELFORMAT_BGRA32, SDL_TEXTUREACCESS_STATIC, file->w, file->h);
+	if(gTexture->texture != NULL && SDL_UpdateTexture(gTexture->texture, NULL, file->pixels, file->w * 4) != 0)
+	{
+		SDL_DestroyTexture(gTexture->texture);
+		gTexture->texture = NULL;
+	}
+	bool isPremultiplied = (file->flags & SGE_TEXTURE_FILE_PREMULTIPLIED) != 0;
+	SGE_CloseTextureFile(file);
+	if(gTexture->texture == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from texture file!");
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
+	}
+	
+	if(!restoreMods)
+	{
+		SDL_BlendMode blendMode = isPremultiplied ? SGE_GetPremultipliedBlendMode() : SDL_BLENDMODE_BLEND;
+		if(SDL_SetTextureBlendMode(gTexture->texture, blendMode) != 0)
+		{
+			SGE_LogPrintLine(SGE_LOG_WARNING, "Renderer can't blend premultiplied alpha, drawing with normal blending!");
+			SDL_SetTextureBlendMode(gTexture->texture, SDL_BLENDMODE_BLEND);
+		}
+	}
+	SGE_FinishTextureUpload(gTexture, restoreMods);
+	return true;
+}
+
+/*
+ * Creates the texture's SDL_Texture from it's RGBA32 source pixels.
+ * The texture is created in RGBA32 itself, so later SDL_UpdateTexture() calls with the same pixels
+ * show the right colors on renderers preferring another format.
+ */
+static bool SGE_UploadTexturePixels(SGE_Texture *gTexture, bool restoreMods)
+{
+	gTexture->texture = SDL_CreateTexture(SGE_GetEngineData()->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, gTexture->original_w, gTexture->original_h);
+	if(gTexture->texture != NULL && SDL_UpdateTexture(gTexture->texture, NULL, gTexture->sourcePixels, gTexture->original_w * 4) != 0)
+	{
+		SDL_DestroyTexture(gTexture->texture);
+		gTexture->texture = NULL;
+	}
+	if(gTexture->texture == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from pixels!");
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
 	}
 	
-	gTexture->w = tempSurface->w;
-	gTexture->h = tempSurface->h;
+	if(!restoreMods)
+	{
+		SDL_SetTextureBlendMode(gTexture->texture, SDL_BLENDMODE_BLEND);
+	}
+	SGE_FinishTextureUpload(gTexture, restoreMods);
+	return true;
+}
+
+/* Sets the size of a newly loaded texture */
+static void SGE_SetTextureDimensions(SGE_Texture *gTexture, int w, int h)
+{
+	gTexture->w = w;
+	gTexture->h = h;
 	gTexture->original_w = gTexture->w;
 	gTexture->original_h = gTexture->h;
 	gTexture->destRect.w = gTexture->w;
 	gTexture->destRect.h = gTexture->h;
 	gTexture->clipRect.w = gTexture->w;
 	gTexture->clipRect.h = gTexture->h;
+}
+
+/* Sets the texture size from a newly loaded surface */
+static void SGE_SetTextureSize(SGE_Texture *gTexture, SDL_Surface *surface)
+{
+	SGE_SetTextureDimensions(gTexture, surface->w, surface->h);
+}
+
+/* Stores the text settings of a text texture so it can be rendered again */
+static void SGE_SetTextureTextSource(SGE_Texture *gTexture, const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode)
+{
+	free(gTexture->sourceText);
+	gTexture->source = SGE_TEXTURE_SOURCE_TEXT;
+	gTexture->sourceText = SGE_CopyString(text);
+	gTexture->sourceFont = font;
+	gTexture->sourceFG = fg;
+	gTexture->sourceBG = fontBGColor;
+	gTexture->sourceTextMode = textMode;
+	gTexture->sourceWordWrap = wordWrap;
+}
+
+SGE_Texture* SGE_LoadTexture(const char *path)
+{
+	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
 	
-	gTexture->texture = SDL_CreateTextureFromSurface(SGE_GetEngineData()->renderer, tempSurface);
-	SDL_FreeSurface(tempSurface);
-	if(gTexture->texture == NULL)
+	SGE_EmptyTextureData(gTexture);
+	
+	if(SGE_IsTextureFilePath(path))
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from image!");
-		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
-		free(gTexture);
-		return NULL;
+		/* Texture files are already decoded, their pixels go straight from the mapped file to the renderer */
+		SGE_TextureFile *file = SGE_OpenTextureFile(path);
+		if(file == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load texture file: %s!", path);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+			free(gTexture);
+			return NULL;
+		}
+		
+		SGE_SetTextureDimensions(gTexture, file->w, file->h);
+		if(!SGE_UploadTextureFile(gTexture, file, false))
+		{
+			free(gTexture);
+			return NULL;
+		}
+	}
+	else
+	{
+		SDL_Surface *tempSurface = NULL;
+		tempSurface = IMG_Load(path);
+		if(tempSurface == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load image: %s!", path, IMG_GetError());
+			SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+			free(gTexture);
+			return NULL;
+		}
+		
+		SGE_SetTextureSize(gTexture, tempSurface);
+		if(!SGE_UploadTextureSurface(gTexture, tempSurface, false))
+		{
+			free(gTexture);
+			return NULL;
+		}
 	}
 	
+	gTexture->source = SGE_TEXTURE_SOURCE_FILE;
+	gTexture->sourcePath = SGE_CopyString(path);
+	SGE_TrackTexture(gTexture);
 	return gTexture;
 }
 
-SGE_Texture* SGE_CreateTextureFromText(const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode)
+/*
+ * Asynchronous loading
+ * Jobs are kept in a single list in the order they were queued. The loading threads decode the first queued job,
+ * and the main thread uploads decoded jobs in order. The list is only used with loaderMutex locked.
+ */
+#define SGE_TEXTURE_LOADER_MAX_THREADS 4
+
+typedef enum
+{
+	SGE_LOAD_JOB_QUEUED,
+	SGE_LOAD_JOB_DECODING,
+	SGE_LOAD_JOB_DECODED
+} SGE_TextureLoadJobState;
+
+typedef struct SGE_TextureLoadJob
+{
+	SGE_TextureLoadJobState state;
+	/* NULL once the texture was freed while it's image was being decoded */
+	SGE_Texture *texture;
+	char *path;
+	/* Decoded image, or the mapped texture file for .sgetex paths, both NULL if loading failed */
+	SDL_Surface *surface;
+	SGE_TextureFile *file;
+	char error[256];
+	struct SGE_TextureLoadJob *next;
+} SGE_TextureLoadJob;
+
+static SDL_Thread *loaderThreads[SGE_TEXTURE_LOADER_MAX_THREADS];
+static int loaderThreadCount = 0;
+static SDL_mutex *loaderMutex = NULL;
+static SDL_cond *loaderCondition = NULL;
+static bool isLoaderQuitting = false;
+static SGE_TextureLoadJob *firstLoadJob = NULL;
+static SGE_TextureLoadJob *lastLoadJob = NULL;
+static int loadingTextureCount = 0;
+static double uploadBudget = 4.0;
+
+/* Converts a decoded image to the format renderers take directly, so the upload on the main thread doesn't convert it */
+static SDL_Surface *SGE_ConvertLoadedSurface(SDL_Surface *surface)
+{
+	/* Color keyed images become transparent while they are uploaded, SDL has to convert them itself */
+	Uint32 colorKey = 0;
+	if(SDL_GetColorKey(surface, &colorKey) == 0)
+	{
+		return surface;
+	}
+	
+	Uint32 format = (surface->format->Amask != 0) ? SDL_PIXELFORMAT_ARGB8888 : SDL_PIXELFORMAT_RGB888;
+	if(surface->format->format == format)
+	{
+		return surface;
+	}
+	
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+	if(converted == NULL)
+	{
+		return surface;
+	}
+	SDL_FreeSurface(surface);
+	return converted;
+}
+
+/* Decodes queued images until the loader quits */
+static int SGE_TextureLoaderThread(void *data)
+{
+	SDL_LockMutex(loaderMutex);
+	while(!isLoaderQuitting)
+	{
+		SGE_TextureLoadJob *job = firstLoadJob;
+		while(job != NULL && job->state != SGE_LOAD_JOB_QUEUED)
+		{
+			job = job->next;
+		}
+		if(job == NULL)
+		{
+			SDL_CondWait(loaderCondition, loaderMutex);
+			continue;
+		}
+		
+		job->state = SGE_LOAD_JOB_DECODING;
+		SDL_UnlockMutex(loaderMutex);
+		
+		/* The logger isn't thread safe, errors are logged by the main thread */
+		SDL_Surface *surface = NULL;
+		SGE_TextureFile *file = NULL;
+		if(SGE_IsTextureFilePath(job->path))
+		{
+			file = SGE_OpenTextureFile(job->path);
+			if(file == NULL)
+			{
+				SDL_strlcpy(job->error, SDL_GetError(), sizeof(job->error));
+			}
+		}
+		else
+		{
+			surface = IMG_Load(job->path);
+			if(surface != NULL)
+			{
+				surface = SGE_ConvertLoadedSurface(surface);
+			}
+			else
+			{
+				SDL_strlcpy(job->error, IMG_GetError(), sizeof(job->error));
+			}
+		}
+		
+		SDL_LockMutex(loaderMutex);
+		job->surface = surface;
+		job->file = file;
+		job->state = SGE_LOAD_JOB_DECODED;
+	}
+	SDL_UnlockMutex(loaderMutex);
+	return 0;
+}
+
+/* Starts the loading threads the first time they are needed */
+static bool SGE_StartTextureLoader()
+{
+	if(loaderThreadCount > 0)
+	{
+		return true;
+	}
+	
+	if(loaderMutex == NULL)
+	{
+		loaderMutex = SDL_CreateMutex();
+		loaderCondition = SDL_CreateCond();
+		if(loaderMutex == NULL || loaderCondition == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture loader lock! SDL_Error: %s", SDL_GetError());
+			return false;
+		}
+	}
+	
+	/* One core is left to the main thread */
+	int threadCount = SDL_max(1, SDL_min(SGE_TEXTURE_LOADER_MAX_THREADS, SDL_GetCPUCount() - 1));
+	isLoaderQuitting = false;
+	while(loaderThreadCount < threadCount)
+	{
+		SDL_Thread *thread = SDL_CreateThread(SGE_TextureLoaderThread, "SGE_TextureLoader", NULL);
+		if(thread == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_WARNING, "Failed to create texture loading thread! SDL_Error: %s", SDL_GetError());
+			break;
+		}
+		loaderThreads[loaderThreadCount] = thread;
+		loaderThreadCount++;
+	}
+	
+	if(loaderThreadCount == 0)
+	{
+		return false;
+	}
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Started %d texture loading threads.", loaderThreadCount);
+	return true;
+}
+
+SGE_Texture* SGE_LoadTextureAsync(const char *path)
 {
+	if(!SGE_StartTextureLoader())
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Loading %s right away instead.", path);
+		return SGE_LoadTexture(path);
+	}
+	
 	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
+	SGE_TextureLoadJob *job = (SGE_TextureLoadJob*)malloc(sizeof(SGE_TextureLoadJob));
+	if(gTexture == NULL || job == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for texture: %s!", path);
+		free(gTexture);
+		free(job);
+		return NULL;
+	}
 	
 	SGE_EmptyTextureData(gTexture);
+	gTexture->source = SGE_TEXTURE_SOURCE_FILE;
+	gTexture->sourcePath = SGE_CopyString(path);
+	gTexture->loadState = SGE_TEXTURE_LOADING;
+	SGE_TrackTexture(gTexture);
 	
-	SDL_Surface *tempSurface = NULL;
+	job->state = SGE_LOAD_JOB_QUEUED;
+	job->texture = gTexture;
+	job->path = SGE_CopyString(path);
+	job->surface = NULL;
+	job->file = NULL;
+	job->error[0] = '\0';
+	job->next = NULL;
 	
-	if(textMode == SGE_TEXT_MODE_SOLID)
+	SDL_LockMutex(loaderMutex);
+	if(lastLoadJob != NULL)
 	{
-		tempSurface = TTF_RenderText_Solid(font, text, fg);
+		lastLoadJob->next = job;
 	}
-	else if(textMode == SGE_TEXT_MODE_SHADED)
+	else
 	{
-		tempSurface = TTF_RenderText_Shaded(font, text, fg, fontBGColor);
+		firstLoadJob = job;
+	}
+	lastLoadJob = job;
+	loadingTextureCount++;
+	SDL_CondSignal(loaderCondition);
+	SDL_UnlockMutex(loaderMutex);
+	
+	return gTexture;
+}
+
+bool SGE_IsTextureReady(SGE_Texture *gTexture)
+{
+	/* Regions are ready with their parent */
+	SGE_Texture *owner = (gTexture->parent != NULL) ? gTexture->parent : gTexture;
+	return owner->loadState == SGE_TEXTURE_READY;
+}
+
+int SGE_GetLoadingTextureCount()
+{
+	return loadingTextureCount;
+}
+
+void SGE_SetTextureUploadBudget(double milliseconds)
+{
+	uploadBudget = milliseconds;
+}
+
+/* Removes a job from the job list, the lock must be held */
+static void SGE_UnlinkLoadJob(SGE_TextureLoadJob *job, SGE_TextureLoadJob *previous)
+{
+	if(previous != NULL)
+	{
+		previous->next = job->next;
 	}
 	else
 	{
-		tempSurface = TTF_RenderText_Blended_Wrapped(font, text, fg, wordWrap);
+		firstLoadJob = job->next;
+	}
+	if(lastLoadJob == job)
+	{
+		lastLoadJob = previous;
+	}
+}
+
+static void SGE_FreeLoadJob(SGE_TextureLoadJob *job)
+{
+	if(job->surface != NULL)
+	{
+		SDL_FreeSurface(job->surface);
+	}
+	SGE_CloseTextureFile(job->file);
+	free(job->path);
+	free(job);
+}
+
+/* Uploads a decoded image into it's texture on the main thread */
+static void SGE_FinishLoadJob(SGE_TextureLoadJob *job)
+{
+	SGE_Texture *gTexture = job->texture;
+	if(gTexture != NULL)
+	{
+		gTexture->loadState = SGE_TEXTURE_LOAD_FAILED;
+		/* Blend modes other than the default one were set while loading and replace the one the upload picks */
+		SDL_BlendMode requestedBlendMode = gTexture->blendMode;
+		bool isUploaded = false;
+		if(job->file != NULL)
+		{
+			/* The file is closed by the upload */
+			SGE_SetTextureDimensions(gTexture, job->file->w, job->file->h);
+			isUploaded = SGE_UploadTextureFile(gTexture, job->file, false);
+			job->file = NULL;
+		}
+		else if(job->surface != NULL)
+		{
+			/* The surface is freed by the upload */
+			SGE_SetTextureSize(gTexture, job->surface);
+			isUploaded = SGE_UploadTextureSurface(gTexture, job->surface, false);
+			job->surface = NULL;
+		}
+		else
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load image: %s!", job->path);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", job->error);
+		}
+		
+		if(isUploaded)
+		{
+			gTexture->loadState = SGE_TEXTURE_READY;
+			if(requestedBlendMode != SDL_BLENDMODE_BLEND)
+			{
+				gTexture->blendMode = requestedBlendMode;
+				SDL_SetTextureBlendMode(gTexture->texture, requestedBlendMode);
+			}
+			SGE_ApplyTextureMods(gTexture);
+		}
+	}
+	SGE_FreeLoadJob(job);
+}
+
+/* Uploads decoded images in the order they were queued until "milliseconds" passed, at least one is uploaded */
+static void SGE_UploadLoadedTextures(double milliseconds)
+{
+	if(loaderMutex == NULL)
+	{
+		return;
 	}
 	
+	Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 budget = (Uint64)(milliseconds * SDL_GetPerformanceFrequency() / 1000.0);
+	while(true)
+	{
+		SDL_LockMutex(loaderMutex);
+		SGE_TextureLoadJob *previous = NULL;
+		SGE_TextureLoadJob *job = firstLoadJob;
+		while(job != NULL && job->state != SGE_LOAD_JOB_DECODED)
+		{
+			previous = job;
+			job = job->next;
+		}
+		if(job != NULL)
+		{
+			SGE_UnlinkLoadJob(job, previous);
+			if(job->texture != NULL)
+			{
+				loadingTextureCount--;
+			}
+		}
+		SDL_UnlockMutex(loaderMutex);
+		
+		if(job == NULL)
+		{
+			return;
+		}
+		SGE_FinishLoadJob(job);
+		if(SDL_GetPerformanceCounter() - start >= budget)
+		{
+			return;
+		}
+	}
+}
+
+void SGE_UpdateTextureLoading()
+{
+	SGE_UploadLoadedTextures(uploadBudget);
+}
+
+void SGE_FinishTextureLoading()
+{
+	while(loadingTextureCount > 0 && loaderThreadCount > 0)
+	{
+		SGE_UploadLoadedTextures(1000.0);
+		if(loadingTextureCount > 0)
+		{
+			SDL_Delay(1);
+		}
+	}
+}
+
+/* Stops loading a texture that is being freed */
+static void SGE_CancelTextureLoad(SGE_Texture *gTexture)
+{
+	SDL_LockMutex(loaderMutex);
+	SGE_TextureLoadJob *previous = NULL;
+	SGE_TextureLoadJob *job = firstLoadJob;
+	while(job != NULL && job->texture != gTexture)
+	{
+		previous = job;
+		job = job->next;
+	}
+	if(job != NULL)
+	{
+		loadingTextureCount--;
+		if(job->state == SGE_LOAD_JOB_DECODING)
+		{
+			/* A loading thread still uses the job, it is thrown away once decoded */
+			job->texture = NULL;
+			job = NULL;
+		}
+		else
+		{
+			SGE_UnlinkLoadJob(job, previous);
+		}
+	}
+	SDL_UnlockMutex(loaderMutex);
+	
+	if(job != NULL)
+	{
+		SGE_FreeLoadJob(job);
+	}
+}
+
+void SGE_TextureLoadingQuit()
+{
+	if(loaderMutex == NULL)
+	{
+		return;
+	}
+	
+	SDL_LockMutex(loaderMutex);
+	isLoaderQuitting = true;
+	SDL_CondBroadcast(loaderCondition);
+	SDL_UnlockMutex(loaderMutex);
+	
+	int i = 0;
+	for(i = 0; i < loaderThreadCount; i++)
+	{
+		SDL_WaitThread(loaderThreads[i], NULL);
+	}
+	loaderThreadCount = 0;
+	
+	while(firstLoadJob != NULL)
+	{
+		SGE_TextureLoadJob *job = firstLoadJob;
+		firstLoadJob = job->next;
+		if(job->texture != NULL)
+		{
+			job->texture->loadState = SGE_TEXTURE_LOAD_FAILED;
+		}
+		SGE_FreeLoadJob(job);
+	}
+	lastLoadJob = NULL;
+	loadingTextureCount = 0;
+	
+	SDL_DestroyCond(loaderCondition);
+	SDL_DestroyMutex(loaderMutex);
+	loaderCondition = NULL;
+	loaderMutex = NULL;
+}
+
+SGE_Texture* SGE_CreateTextureFromText(const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode)
+{
+	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
+	
+	SGE_EmptyTextureData(gTexture);
+	
+	SDL_Surface *tempSurface = SGE_RenderTextSurface(text, font, fg, fontBGColor, textMode, wordWrap);
 	if(tempSurface == NULL)
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to render text surface!");
-		SGE_LogPrintLine(SGE_LOG_ERROR, "TTF_Error: %s", TTF_GetError());
 		free(gTexture);
 		return NULL;
 	}
 	
-	gTexture->w = tempSurface->w;
-	gTexture->h = tempSurface->h;
-	gTexture->original_w = gTexture->w;
-	gTexture->original_h = gTexture->h;
-	gTexture->destRect.w = gTexture->w;
-	gTexture->destRect.h = gTexture->h;
-	gTexture->clipRect.w = gTexture->w;
-	gTexture->clipRect.h = gTexture->h;
-	
-	gTexture->texture = SDL_CreateTextureFromSurface(SGE_GetEngineData()->renderer, tempSurface);
-	SDL_FreeSurface(tempSurface);
-	if(gTexture->texture == NULL)
+	SGE_SetTextureSize(gTexture, tempSurface);
+	if(!SGE_UploadTextureSurface(gTexture, tempSurface, false))
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from image!");
-		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
 		free(gTexture);
 		return NULL;
 	}
 	
+	SGE_SetTextureTextSource(gTexture, text, font, fg, textMode);
+	SGE_TrackTexture(gTexture);
 	return gTexture;
 }
 
-void SGE_UpdateTextureFromText(SGE_Texture *gTexture, const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode)
+/*
+ * Creates a texture from 32 bit RGBA pixels, "pitch" is the length of a row in bytes.
+ * The pixels are copied so the texture can be uploaded again later.
+ */
+SGE_Texture* SGE_CreateTextureFromPixels(const void *pixels, int w, int h, int pitch)
 {
-	SDL_DestroyTexture(gTexture->texture);
-	gTexture->texture = NULL;
+	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
 	
-	SDL_Surface *tempSurface = NULL;
+	SGE_EmptyTextureData(gTexture);
 	
-	if(textMode == SGE_TEXT_MODE_SOLID)
+	/* Keep a tightly packed copy of the pixels */
+	int y = 0;
+	gTexture->sourcePixels = malloc((size_t)w * h * 4);
+	for(y = 0; y < h; y++)
 	{
-		tempSurface = TTF_RenderText_Solid(font, text, fg);
+		memcpy((Uint8*)gTexture->sourcePixels + (size_t)y * w * 4, (const Uint8*)pixels + (size_t)y * pitch, (size_t)w * 4);
 	}
-	else if(textMode == SGE_TEXT_MODE_SHADED)
+	
+	SGE_SetTextureDimensions(gTexture, w, h);
+	if(!SGE_UploadTexturePixels(gTexture, false))
 	{
-		tempSurface = TTF_RenderText_Shaded(font, text, fg, fontBGColor);
+		free(gTexture->sourcePixels);
+		free(gTexture);
+		return NULL;
 	}
-	else
+	
+	gTexture->source = SGE_TEXTURE_SOURCE_PIXELS;
+	SGE_TrackTexture(gTexture);
+	return gTexture;
+}
+
+/*
+ * Creates a texture showing a part of another texture, sharing it's SDL_Texture.
+ * The parent has to outlive the region.
+ */
+SGE_Texture* SGE_CreateTextureRegion(SGE_Texture *parent, const SDL_Rect *region)
+{
+	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
+	
+	SGE_EmptyTextureData(gTexture);
+	gTexture->texture = parent->texture;
+	gTexture->parent = parent;
+	gTexture->regionX = region->x;
+	gTexture->regionY = region->y;
+	gTexture->w = region->w;
+	gTexture->h = region->h;
+	gTexture->original_w = region->w;
+	gTexture->original_h = region->h;
+	gTexture->destRect.w = region->w;
+	gTexture->destRect.h = region->h;
+	gTexture->clipRect = *region;
+	gTexture->blendMode = parent->blendMode;
+	gTexture->isStale = parent->isStale;
+	
+	gTexture->source = SGE_TEXTURE_SOURCE_REGION;
+	parent->regionCount++;
+	SGE_TrackTexture(gTexture);
+	return gTexture;
+}
+
+/* Creates the texture's SDL_Texture as an empty render target with the texture's modulation */
+static bool SGE_CreateTargetTextureData(SGE_Texture *gTexture)
+{
+	gTexture->texture = SDL_CreateTexture(SGE_GetEngineData()->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, gTexture->original_w, gTexture->original_h);
+	if(gTexture->texture == NULL)
 	{
-		tempSurface = TTF_RenderText_Blended_Wrapped(font, text, fg, wordWrap);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create render target texture!");
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
 	}
 	
-	if(tempSurface == NULL)
+	gTexture->memorySize = (size_t)gTexture->original_w * gTexture->original_h * 4;
+	textureMemory += gTexture->memorySize;
+	gTexture->isStale = false;
+	if(gTexture->regionCount > 0)
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to render text surface!");
-		SGE_LogPrintLine(SGE_LOG_ERROR, "TTF_Error: %s", TTF_GetError());
+		SGE_UpdateRegionTextures(gTexture);
 	}
 	
-	gTexture->w = tempSurface->w;
-	gTexture->h = tempSurface->h;
-	gTexture->original_w = gTexture->w;
-	gTexture->original_h = gTexture->h;
-	gTexture->destRect.w = gTexture->w;
-	gTexture->destRect.h = gTexture->h;
-	gTexture->clipRect.w = gTexture->w;
-	gTexture->clipRect.h = gTexture->h;
+	SGE_RestoreTextureMods(gTexture);
+	return true;
+}
+
+/*
+ * Creates an empty texture to render into with SGE_SetRenderTarget(), it's contents start out undefined.
+ * A target has no source to upload again, when it goes stale it is given back empty.
+ */
+SGE_Texture* SGE_CreateTargetTexture(int w, int h)
+{
+	SGE_Texture *gTexture = (SGE_Texture*)malloc(sizeof(SGE_Texture));
 	
-	gTexture->texture = SDL_CreateTextureFromSurface(SGE_GetEngineData()->renderer, tempSurface);
-	SDL_FreeSurface(tempSurface);
-	if(gTexture->texture == NULL)
+	SGE_EmptyTextureData(gTexture);
+	gTexture->w = w;
+	gTexture->h = h;
+	gTexture->original_w = w;
+	gTexture->original_h = h;
+	gTexture->destRect.w = w;
+	gTexture->destRect.h = h;
+	gTexture->clipRect.w = w;
+	gTexture->clipRect.h = h;
+	
+	if(!SGE_CreateTargetTextureData(gTexture))
 	{
-		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create texture from image!");
-		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		free(gTexture);
+		return NULL;
 	}
+	
+	gTexture->source = SGE_TEXTURE_SOURCE_TARGET;
+	SGE_TrackTexture(gTexture);
+	return gTexture;
+}
+
+void SGE_UpdateTextureFromText(SGE_Texture *gTexture, const char *text, TTF_Font *font, SDL_Color fg, SGE_TextRenderMode textMode)
+{
+	SGE_ReleaseTextureData(gTexture, true);
+	
+	SDL_Surface *tempSurface = SGE_RenderTextSurface(text, font, fg, fontBGColor, textMode, wordWrap);
+	if(tempSurface == NULL)
+	{
+		return;
+	}
+	
+	SGE_SetTextureSize(gTexture, tempSurface);
+	SGE_UploadTextureSurface(gTexture, tempSurface, true);
+	SGE_SetTextureTextSource(gTexture, text, font, fg, textMode);
 }
 
 void SGE_FreeTexture(SGE_Texture *gTexture)
 {
 	if(gTexture != NULL)
 	{
-		SDL_DestroyTexture(gTexture->texture);
+		/* Packed textures give their space back to the atlas, which frees them */
+		if(gTexture->atlas != NULL)
+		{
+			SGE_TextureAtlasRemove(gTexture->atlas, gTexture);
+			return;
+		}
+		
+		if(gTexture->loadState == SGE_TEXTURE_LOADING)
+		{
+			SGE_CancelTextureLoad(gTexture);
+		}
+		
+		if(gTexture->parent != NULL)
+		{
+			gTexture->parent->regionCount--;
+		}
+		SGE_UntrackTexture(gTexture);
+		SGE_ReleaseTextureData(gTexture, true);
+		free(gTexture->sourcePath);
+		free(gTexture->sourceText);
+		free(gTexture->sourcePixels);
 		free(gTexture);
 	}
 	else
@@ -193,26 +1017,338 @@ void SGE_FreeTexture(SGE_Texture *gTexture)
 	}
 }
 
+/* Screen area covered by a rect rotated around it's center, with a pixel of margin for filtering */
+static SDL_Rect SGE_GetRotatedRectBounds(const SDL_Rect *rect, double rotation)
+{
+	SDL_Rect bounds = *rect;
+	if(rotation != 0)
+	{
+		float radius = SDL_sqrtf((float)rect->w * rect->w + (float)rect->h * rect->h) / 2.0f;
+		float centerX = rect->x + rect->w / 2.0f;
+		float centerY = rect->y + rect->h / 2.0f;
+		bounds.x = (int)SDL_floorf(centerX - radius);
+		bounds.y = (int)SDL_floorf(centerY - radius);
+		bounds.w = (int)SDL_ceilf(centerX + radius) - bounds.x;
+		bounds.h = (int)SDL_ceilf(centerY + radius) - bounds.y;
+	}
+	bounds.x -= 1;
+	bounds.y -= 1;
+	bounds.w += 2;
+	bounds.h += 2;
+	return bounds;
+}
+
 void SGE_RenderTexture(SGE_Texture *gTexture)
 {
-	gTexture->destRect.x = gTexture->x;
-	gTexture->destRect.y = gTexture->y;
-	gTexture->destRect.w = gTexture->w;
-	gTexture->destRect.h = gTexture->h;
-	SDL_RenderCopyEx(SGE_GetEngineData()->renderer, gTexture->texture, &gTexture->clipRect, &gTexture->destRect, gTexture->rotation, NULL, gTexture->flip);
+	/* Textures still loading have nothing to draw yet, regions wait for their parent */
+	if(!SGE_IsTextureReady(gTexture))
+	{
+		gTexture->drawnRect.w = 0;
+		gTexture->drawnRect.h = 0;
+		return;
+	}
+	
+	/* With a camera the texture is placed in the world, and skipped when it is out of view */
+	double rotation = gTexture->rotation;
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera != NULL)
+	{
+		SDL_FRect worldRect = {gTexture->x, gTexture->y, gTexture->w, gTexture->h};
+		if(!SGE_CameraApply(camera, &worldRect, &rotation))
+		{
+			gTexture->drawnRect.w = 0;
+			gTexture->drawnRect.h = 0;
+			return;
+		}
+		gTexture->destRect.x = (int)SDL_floorf(worldRect.x + 0.5f);
+		gTexture->destRect.y = (int)SDL_floorf(worldRect.y + 0.5f);
+		gTexture->destRect.w = (int)SDL_floorf(worldRect.x + worldRect.w + 0.5f) - gTexture->destRect.x;
+		gTexture->destRect.h = (int)SDL_floorf(worldRect.y + worldRect.h + 0.5f) - gTexture->destRect.y;
+	}
+	else
+	{
+		gTexture->destRect.x = gTexture->x;
+		gTexture->destRect.y = gTexture->y;
+		gTexture->destRect.w = gTexture->w;
+		gTexture->destRect.h = gTexture->h;
+	}
+	gTexture->drawnRect = SGE_GetRotatedRectBounds(&gTexture->destRect, rotation);
+	
+	if(gTexture->isStale)
+	{
+		SGE_RestoreTexture(gTexture);
+	}
+	
+	/* Draw queued primitives first to keep the drawing order */
+	if(SGE_PrimitiveBatchGetCount() > 0)
+	{
+		SGE_PrimitiveBatchFlush();
+	}
+	
+	/*
+	 * A shared SDL_Texture keeps the modulation of whichever texture drew it last,
+	 * so regions and textures with regions apply their own every time.
+	 */
+	if(gTexture->parent != NULL)
+	{
+		/* Read through the parent, it's SDL_Texture is created again by SGE_UpdateTextureFromText() */
+		gTexture->texture = gTexture->parent->texture;
+	}
+	if(gTexture->parent != NULL || gTexture->regionCount > 0)
+	{
+		SGE_RestoreTextureMods(gTexture);
+	}
+	
+	/* Blended textures write premultiplied color while premultiplied drawing is on */
+	SDL_BlendMode blendMode = SGE_MapDrawBlendMode(gTexture->blendMode);
+	if(blendMode != gTexture->blendMode)
+	{
+		SDL_SetTextureBlendMode(gTexture->texture, blendMode);
+	}
+	
+	SDL_RenderCopyEx(SGE_GetEngineData()->renderer, gTexture->texture, &gTexture->clipRect, &gTexture->destRect, rotation, NULL, gTexture->flip);
+	
+	if(blendMode != gTexture->blendMode)
+	{
+		SDL_SetTextureBlendMode(gTexture->texture, gTexture->blendMode);
+	}
 }
 
+/*
+ * The texture's mods shadow the SDL texture's, setting the same values again is skipped.
+ * Stale textures only store the values, they are applied when the texture is restored.
+ * Regions only store them too, they are applied when the region is rendered.
+ * Textures with regions apply theirs again whenever they are rendered, as regions change the shared SDL_Texture's.
+ * Textures drawn with the premultiplied blend mode get their color mod scaled by their alpha mod, so they fade instead of glowing.
+*/
 void SGE_SetTextureColor(SGE_Texture *gTexture, Uint8 red, Uint8 green, Uint8 blue)
 {
-	SDL_SetTextureColorMod(gTexture->texture, red, green, blue);
+	if(gTexture->colorMod.r == red && gTexture->colorMod.g == green && gTexture->colorMod.b == blue)
+	{
+		SGE_GetEngineData()->renderStateCallsAvoided++;
+		return;
+	}
+	gTexture->colorMod.r = red;
+	gTexture->colorMod.g = green;
+	gTexture->colorMod.b = blue;
+	if(gTexture->parent == NULL)
+		SGE_ApplyTextureMods(gTexture);
 }
 
 void SGE_SetTextureBlendMode(SGE_Texture *gTexture, SDL_BlendMode blending)
 {
-	SDL_SetTextureBlendMode(gTexture->texture, blending);
+	if(gTexture->blendMode == blending)
+	{
+		SGE_GetEngineData()->renderStateCallsAvoided++;
+		return;
+	}
+	gTexture->blendMode = blending;
+	if(gTexture->parent == NULL)
+	{
+		SDL_SetTextureBlendMode(gTexture->texture, blending);
+		/* Switching to or from premultiplied blending changes the applied color mod */
+		SGE_ApplyTextureMods(gTexture);
+	}
 }
 
 void SGE_SetTextureAlpha(SGE_Texture *gTexture, Uint8 alpha)
 {
-	SDL_SetTextureAlphaMod(gTexture->texture, alpha);
+	if(gTexture->colorMod.a == alpha)
+	{
+		SGE_GetEngineData()->renderStateCallsAvoided++;
+		return;
+	}
+	gTexture->colorMod.a = alpha;
+	if(gTexture->parent == NULL)
+		SGE_ApplyTextureMods(gTexture);
+}
+
+void SGE_AddTextureDirtyRect(SGE_Texture *gTexture)
+{
+	if(!SGE_GetEngineData()->isDirtyRectMode)
+	{
+		return;
+	}
+	SGE_AddDirtyRect(&gTexture->drawnRect);
+	
+	/* Placed the same way SGE_RenderTexture() will place it */
+	SDL_Rect rect = {gTexture->x, gTexture->y, gTexture->w, gTexture->h};
+	double rotation = gTexture->rotation;
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera != NULL)
+	{
+		SDL_FRect worldRect = {gTexture->x, gTexture->y, gTexture->w, gTexture->h};
+		int culledCount = camera->culledCount;
+		bool isVisible = SGE_CameraApply(camera, &worldRect, &rotation);
+		camera->culledCount = culledCount;
+		if(!isVisible)
+		{
+			return;
+		}
+		rect.x = (int)SDL_floorf(worldRect.x);
+		rect.y = (int)SDL_floorf(worldRect.y);
+		rect.w = (int)SDL_ceilf(worldRect.x + worldRect.w) - rect.x;
+		rect.h = (int)SDL_ceilf(worldRect.y + worldRect.h) - rect.y;
+	}
+	rect = SGE_GetRotatedRectBounds(&rect, rotation);
+	SGE_AddDirtyRect(&rect);
+}
+
+void SGE_InvalidateTextures(bool rendererDestroyed)
+{
+	SGE_Texture *current = textureList;
+	while(current != NULL)
+	{
+		SGE_ReleaseTextureData(current, !rendererDestroyed);
+		current->isStale = true;
+		current = current->next;
+	}
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Invalidated %d textures.", textureCount);
+}
+
+void SGE_InvalidateTargetTextures()
+{
+	SGE_Texture *current = textureList;
+	int count = 0;
+	
+	while(current != NULL)
+	{
+		if(current->source == SGE_TEXTURE_SOURCE_TARGET)
+		{
+			SGE_ReleaseTextureData(current, true);
+			current->isStale = true;
+			count++;
+		}
+		current = current->next;
+	}
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Invalidated %d render target textures.", count);
+}
+
+bool SGE_RestoreTexture(SGE_Texture *gTexture)
+{
+	SDL_Surface *tempSurface = NULL;
+	
+	/* Loading textures are uploaded by the loader when their image is decoded */
+	if(gTexture->loadState != SGE_TEXTURE_READY)
+	{
+		return false;
+	}
+	
+	/* Only try once, a texture that fails to restore would otherwise retry on every render */
+	gTexture->isStale = false;
+	
+	if(gTexture->source == SGE_TEXTURE_SOURCE_FILE && SGE_IsTextureFilePath(gTexture->sourcePath))
+	{
+		SGE_TextureFile *file = SGE_OpenTextureFile(gTexture->sourcePath);
+		if(file == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to reload texture file: %s!", gTexture->sourcePath);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+			return false;
+		}
+		return SGE_UploadTextureFile(gTexture, file, true);
+	}
+	else if(gTexture->source == SGE_TEXTURE_SOURCE_FILE)
+	{
+		tempSurface = IMG_Load(gTexture->sourcePath);
+		if(tempSurface == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to reload image: %s!", gTexture->sourcePath);
+			SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+		}
+	}
+	else if(gTexture->source == SGE_TEXTURE_SOURCE_TEXT)
+	{
+		tempSurface = SGE_RenderTextSurface(gTexture->sourceText, gTexture->sourceFont, gTexture->sourceFG, gTexture->sourceBG, gTexture->sourceTextMode, gTexture->sourceWordWrap);
+	}
+	else if(gTexture->source == SGE_TEXTURE_SOURCE_PIXELS)
+	{
+		return SGE_UploadTexturePixels(gTexture, true);
+	}
+	else if(gTexture->source == SGE_TEXTURE_SOURCE_REGION)
+	{
+		/* Regions only need their parent restored */
+		if(gTexture->parent->isStale)
+		{
+			SGE_RestoreTexture(gTexture->parent);
+		}
+		gTexture->texture = gTexture->parent->texture;
+		return gTexture->texture != NULL;
+	}
+	else if(gTexture->source == SGE_TEXTURE_SOURCE_TARGET)
+	{
+		return SGE_CreateTargetTextureData(gTexture);
+	}
+	else
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Texture has no source to restore it from!");
+	}
+	
+	if(tempSurface == NULL)
+	{
+		return false;
+	}
+	return SGE_UploadTextureSurface(gTexture, tempSurface, true);
+}
+
+void SGE_ReloadTextures()
+{
+	SGE_Texture *current = textureList;
+	int count = 0;
+	
+	while(current != NULL)
+	{
+		if(current->isStale && SGE_RestoreTexture(current))
+		{
+			count++;
+		}
+		current = current->next;
+	}
+	
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Reloaded %d textures.", count);
+}
+
+int SGE_GetTextureCount()
+{
+	return textureCount;
+}
+
+size_t SGE_GetTextureMemoryUsage()
+{
+	return textureMemory;
+}
+
+void SGE_PrintTextureList()
+{
+	SGE_Texture *current = textureList;
+	
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "%d textures using %.2f MB:", textureCount, textureMemory / (1024.0 * 1024.0));
+	while(current != NULL)
+	{
+		if(current->loadState == SGE_TEXTURE_LOADING)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "    loading  file: %s", current->sourcePath);
+		}
+		else if(current->source == SGE_TEXTURE_SOURCE_FILE)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "%4dx%-4d file: %s", current->original_w, current->original_h, current->sourcePath);
+		}
+		else if(current->source == SGE_TEXTURE_SOURCE_TEXT)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "%4dx%-4d text: %s", current->original_w, current->original_h, current->sourceText);
+		}
+		else if(current->source == SGE_TEXTURE_SOURCE_REGION)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "%4dx%-4d region at %d, %d", current->original_w, current->original_h, current->regionX, current->regionY);
+		}
+		else if(current->source == SGE_TEXTURE_SOURCE_TARGET)
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "%4dx%-4d render target", current->original_w, current->original_h);
+		}
+		else
+		{
+			SGE_LogPrintLine(SGE_LOG_DEBUG, "%4dx%-4d pixels", current->original_w, current->original_h);
+		}
+		current = current->next;
+	}
 }
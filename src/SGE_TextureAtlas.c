@@ -0,0 +1,488 @@
+#include "SGE_TextureAtlas.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+SGE_TextureAtlas *SGE_CreateTextureAtlas(int pageSize)
+{
+	SGE_TextureAtlas *atlas = (SGE_TextureAtlas*)malloc(sizeof(SGE_TextureAtlas));
+	atlas->pages = NULL;
+	atlas->pageCount = 0;
+	atlas->pageSize = (pageSize > 0) ? pageSize : SGE_ATLAS_DEFAULT_PAGE_SIZE;
+	atlas->regions = NULL;
+	atlas->regionCount = 0;
+	atlas->regionCapacity = 0;
+	atlas->padding = 1;
+	atlas->maxImageSize = atlas->pageSize / 4;
+	return atlas;
+}
+
+/* Frees a page's texture and skyline */
+static void SGE_FreeAtlasPage(SGE_TextureAtlasPage *page)
+{
+	if(page->texture != NULL)
+	{
+		SGE_FreeTexture(page->texture);
+		page->texture = NULL;
+	}
+	free(page->skyline);
+	page->skyline = NULL;
+	page->skylineCount = 0;
+}
+
+/* Frees a region's texture without touching the page it was packed in */
+static void SGE_FreeAtlasRegionTexture(SGE_Texture *texture)
+{
+	texture->atlas = NULL;
+	SGE_FreeTexture(texture);
+}
+
+void SGE_FreeTextureAtlas(SGE_TextureAtlas *atlas)
+{
+	if(atlas == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL texture atlas!");
+		return;
+	}
+
+	int i = 0;
+	for(i = 0; i < atlas->regionCount; i++)
+	{
+		SGE_FreeAtlasRegionTexture(atlas->regions[i].texture);
+	}
+	for(i = 0; i < atlas->pageCount; i++)
+	{
+		SGE_FreeAtlasPage(&atlas->pages[i]);
+	}
+	free(atlas->regions);
+	free(atlas->pages);
+	free(atlas);
+}
+
+/* Empties a page's skyline, the whole page is free again */
+static void SGE_ResetAtlasPageSkyline(SGE_TextureAtlas *atlas, SGE_TextureAtlasPage *page)
+{
+	page->skyline[0].x = 0;
+	page->skyline[0].y = 0;
+	page->skyline[0].w = atlas->pageSize;
+	page->skylineCount = 1;
+	page->regionCount = 0;
+	page->usedArea = 0;
+}
+
+/* Adds a new empty page, returns it's index or -1 */
+static int SGE_AddAtlasPage(SGE_TextureAtlas *atlas)
+{
+	SGE_TextureAtlasPage *pages = (SGE_TextureAtlasPage*)realloc(atlas->pages, (atlas->pageCount + 1) * sizeof(SGE_TextureAtlasPage));
+	if(pages == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to add texture atlas page!");
+		return -1;
+	}
+	atlas->pages = pages;
+
+	/* The page texture keeps these pixels as it's source, regions are copied into them as they are packed */
+	void *pixels = calloc((size_t)atlas->pageSize * atlas->pageSize, 4);
+	if(pixels == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate texture atlas page pixels!");
+		return -1;
+	}
+
+	SGE_TextureAtlasPage *page = &atlas->pages[atlas->pageCount];
+	page->texture = SGE_CreateTextureFromPixels(pixels, atlas->pageSize, atlas->pageSize, atlas->pageSize * 4);
+	free(pixels);
+	if(page->texture == NULL)
+	{
+		return -1;
+	}
+
+	/* The skyline never has more segments than the page is wide */
+	page->skyline = (SGE_AtlasSkylineNode*)malloc(atlas->pageSize * sizeof(SGE_AtlasSkylineNode));
+	SGE_ResetAtlasPageSkyline(atlas, page);
+
+	atlas->pageCount++;
+	return atlas->pageCount - 1;
+}
+
+/*
+ * Finds the height a w pixels wide rect would rest at when placed at skyline node "index".
+ * Returns -1 if it doesn't fit there.
+ */
+static int SGE_AtlasSkylineFit(SGE_TextureAtlas *atlas, SGE_TextureAtlasPage *page, int index, int w, int h)
+{
+	int x = page->skyline[index].x;
+	if(x + w > atlas->pageSize)
+	{
+		return -1;
+	}
+
+	int y = 0;
+	int remaining = w;
+	while(remaining > 0)
+	{
+		if(page->skyline[index].y > y)
+		{
+			y = page->skyline[index].y;
+		}
+		if(y + h > atlas->pageSize)
+		{
+			return -1;
+		}
+		remaining -= page->skyline[index].w;
+		index++;
+	}
+	return y;
+}
+
+/* Raises the skyline over a newly placed rect */
+static void SGE_AtlasSkylineAdd(SGE_TextureAtlasPage *page, int index, int x, int y, int w, int h)
+{
+	int i = 0;
+
+	/* Insert the new segment */
+	memmove(&page->skyline[index + 1], &page->skyline[index], (page->skylineCount - index) * sizeof(SGE_AtlasSkylineNode));
+	page->skyline[index].x = x;
+	page->skyline[index].y = y + h;
+	page->skyline[index].w = w;
+	page->skylineCount++;
+
+	/* Cut away the parts of the following segments now under the new one */
+	for(i = index + 1; i < page->skylineCount; i++)
+	{
+		SGE_AtlasSkylineNode *previous = &page->skyline[i - 1];
+		SGE_AtlasSkylineNode *node = &page->skyline[i];
+		int overlap = previous->x + previous->w - node->x;
+		if(overlap <= 0)
+		{
+			break;
+		}
+
+		node->x += overlap;
+		node->w -= overlap;
+		if(node->w > 0)
+		{
+			break;
+		}
+		memmove(&page->skyline[i], &page->skyline[i + 1], (page->skylineCount - i - 1) * sizeof(SGE_AtlasSkylineNode));
+		page->skylineCount--;
+		i--;
+	}
+
+	/* Merge neighbouring segments at the same height */
+	for(i = 0; i < page->skylineCount - 1; i++)
+	{
+		if(page->skyline[i].y == page->skyline[i + 1].y)
+		{
+			page->skyline[i].w += page->skyline[i + 1].w;
+			memmove(&page->skyline[i + 1], &page->skyline[i + 2], (page->skylineCount - i - 2) * sizeof(SGE_AtlasSkylineNode));
+			page->skylineCount--;
+			i--;
+		}
+	}
+}
+
+/* Places a w by h rect in a page at the lowest spot it fits, leftmost first */
+static bool SGE_AtlasPagePack(SGE_TextureAtlas *atlas, SGE_TextureAtlasPage *page, int w, int h, SDL_Point *position)
+{
+	int bestIndex = -1;
+	int bestTop = atlas->pageSize + 1;
+	int bestWidth = 0;
+	int i = 0;
+
+	for(i = 0; i < page->skylineCount; i++)
+	{
+		int y = SGE_AtlasSkylineFit(atlas, page, i, w, h);
+		if(y < 0)
+		{
+			continue;
+		}
+		if(y + h < bestTop || (y + h == bestTop && page->skyline[i].w < bestWidth))
+		{
+			bestIndex = i;
+			bestTop = y + h;
+			bestWidth = page->skyline[i].w;
+			position->x = page->skyline[i].x;
+			position->y = y;
+		}
+	}
+
+	if(bestIndex < 0)
+	{
+		return false;
+	}
+	SGE_AtlasSkylineAdd(page, bestIndex, position->x, position->y, w, h);
+	page->usedArea += w * h;
+	return true;
+}
+
+/* Copies pixels into a page and uploads the changed part of it */
+static void SGE_AtlasPageWrite(SGE_TextureAtlas *atlas, SGE_TextureAtlasPage *page, const SDL_Rect *rect, const void *pixels, int pitch)
+{
+	SGE_Texture *pageTexture = page->texture;
+	Uint8 *dest = (Uint8*)pageTexture->sourcePixels + ((size_t)rect->y * atlas->pageSize + rect->x) * 4;
+	int y = 0;
+	for(y = 0; y < rect->h; y++)
+	{
+		memcpy(dest + (size_t)y * atlas->pageSize * 4, (const Uint8*)pixels + (size_t)y * pitch, (size_t)rect->w * 4);
+	}
+
+	/* A stale page uploads all of it's pixels when it is restored */
+	if(!pageTexture->isStale && pageTexture->texture != NULL)
+	{
+		SDL_UpdateTexture(pageTexture->texture, rect, dest, atlas->pageSize * 4);
+	}
+}
+
+/* Finds room for a w by h image, adding a page if needed */
+static bool SGE_AtlasPack(SGE_TextureAtlas *atlas, int w, int h, int *pageIndex, SDL_Rect *rect)
+{
+	SDL_Point position = {0, 0};
+	int paddedW = w + atlas->padding;
+	int paddedH = h + atlas->padding;
+	int i = 0;
+
+	for(i = 0; i < atlas->pageCount; i++)
+	{
+		if(SGE_AtlasPagePack(atlas, &atlas->pages[i], paddedW, paddedH, &position))
+		{
+			break;
+		}
+	}
+	if(i == atlas->pageCount)
+	{
+		i = SGE_AddAtlasPage(atlas);
+		if(i < 0 || !SGE_AtlasPagePack(atlas, &atlas->pages[i], paddedW, paddedH, &position))
+		{
+			return false;
+		}
+	}
+
+	*pageIndex = i;
+	rect->x = position.x;
+	rect->y = position.y;
+	rect->w = w;
+	rect->h = h;
+	return true;
+}
+
+SGE_Texture *SGE_TextureAtlasAddPixels(SGE_TextureAtlas *atlas, const void *pixels, int w, int h, int pitch)
+{
+	if(w > atlas->maxImageSize || h > atlas->maxImageSize)
+	{
+		return SGE_CreateTextureFromPixels(pixels, w, h, pitch);
+	}
+
+	if(atlas->regionCount == atlas->regionCapacity)
+	{
+		int capacity = (atlas->regionCapacity == 0) ? 64 : atlas->regionCapacity * 2;
+		SGE_TextureAtlasRegion *regions = (SGE_TextureAtlasRegion*)realloc(atlas->regions, capacity * sizeof(SGE_TextureAtlasRegion));
+		if(regions == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to grow texture atlas to %d images!", capacity);
+			return NULL;
+		}
+		atlas->regions = regions;
+		atlas->regionCapacity = capacity;
+	}
+
+	int pageIndex = 0;
+	SDL_Rect rect;
+	if(!SGE_AtlasPack(atlas, w, h, &pageIndex, &rect))
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to pack %dx%d image into texture atlas!", w, h);
+		return NULL;
+	}
+
+	SGE_TextureAtlasPage *page = &atlas->pages[pageIndex];
+	SGE_AtlasPageWrite(atlas, page, &rect, pixels, pitch);
+
+	SGE_Texture *texture = SGE_CreateTextureRegion(page->texture, &rect);
+	texture->atlas = atlas;
+	page->regionCount++;
+
+	SGE_TextureAtlasRegion *region = &atlas->regions[atlas->regionCount];
+	region->texture = texture;
+	region->page = pageIndex;
+	region->rect = rect;
+	atlas->regionCount++;
+	return texture;
+}
+
+SGE_Texture *SGE_TextureAtlasLoad(SGE_TextureAtlas *atlas, const char *path)
+{
+	SDL_Surface *loaded = IMG_Load(path);
+	if(loaded == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load image: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+		return NULL;
+	}
+
+	if(loaded->w > atlas->maxImageSize || loaded->h > atlas->maxImageSize)
+	{
+		SDL_FreeSurface(loaded);
+		return SGE_LoadTexture(path);
+	}
+
+	SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loaded);
+	if(surface == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to convert image: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return NULL;
+	}
+
+	SDL_LockSurface(surface);
+	SGE_Texture *texture = SGE_TextureAtlasAddPixels(atlas, surface->pixels, surface->w, surface->h, surface->pitch);
+	SDL_UnlockSurface(surface);
+	SDL_FreeSurface(surface);
+	return texture;
+}
+
+void SGE_TextureAtlasRemove(SGE_TextureAtlas *atlas, SGE_Texture *texture)
+{
+	int i = 0;
+	for(i = 0; i < atlas->regionCount; i++)
+	{
+		if(atlas->regions[i].texture == texture)
+		{
+			break;
+		}
+	}
+	if(i == atlas->regionCount)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to remove texture that is not in the texture atlas!");
+		return;
+	}
+
+	SGE_TextureAtlasRegion *region = &atlas->regions[i];
+	SGE_TextureAtlasPage *page = &atlas->pages[region->page];
+	page->regionCount--;
+	page->usedArea -= (region->rect.w + atlas->padding) * (region->rect.h + atlas->padding);
+
+	/* A page with nothing left in it can be filled from scratch */
+	if(page->regionCount == 0)
+	{
+		memset(page->texture->sourcePixels, 0, (size_t)atlas->pageSize * atlas->pageSize * 4);
+		if(!page->texture->isStale && page->texture->texture != NULL)
+		{
+			SDL_UpdateTexture(page->texture->texture, NULL, page->texture->sourcePixels, atlas->pageSize * 4);
+		}
+		SGE_ResetAtlasPageSkyline(atlas, page);
+	}
+
+	SGE_FreeAtlasRegionTexture(texture);
+	atlas->regions[i] = atlas->regions[atlas->regionCount - 1];
+	atlas->regionCount--;
+}
+
+/* Moves an old page into the page list unchanged, returns it's new index or -1 */
+static int SGE_KeepAtlasPage(SGE_TextureAtlas *atlas, SGE_TextureAtlasPage *page)
+{
+	SGE_TextureAtlasPage *pages = (SGE_TextureAtlasPage*)realloc(atlas->pages, (atlas->pageCount + 1) * sizeof(SGE_TextureAtlasPage));
+	if(pages == NULL)
+	{
+		return -1;
+	}
+	atlas->pages = pages;
+	atlas->pages[atlas->pageCount] = *page;
+	atlas->pageCount++;
+	return atlas->pageCount - 1;
+}
+
+/* Orders regions by height, tallest first, which packs a skyline tighter */
+static int SGE_AtlasRegionCompare(const void *a, const void *b)
+{
+	const SGE_TextureAtlasRegion *regionA = (const SGE_TextureAtlasRegion*)a;
+	const SGE_TextureAtlasRegion *regionB = (const SGE_TextureAtlasRegion*)b;
+	if(regionA->rect.h != regionB->rect.h)
+	{
+		return regionB->rect.h - regionA->rect.h;
+	}
+	return regionB->rect.w - regionA->rect.w;
+}
+
+void SGE_TextureAtlasRepack(SGE_TextureAtlas *atlas)
+{
+	int i = 0;
+	SGE_TextureAtlasPage *oldPages = atlas->pages;
+	int oldPageCount = atlas->pageCount;
+
+	/* New index of old pages that had to be kept, -1 for pages that get freed */
+	int *keptPages = (int*)malloc(oldPageCount * sizeof(int));
+	for(i = 0; i < oldPageCount; i++)
+	{
+		keptPages[i] = -1;
+	}
+
+	atlas->pages = NULL;
+	atlas->pageCount = 0;
+	qsort(atlas->regions, atlas->regionCount, sizeof(SGE_TextureAtlasRegion), SGE_AtlasRegionCompare);
+
+	for(i = 0; i < atlas->regionCount; i++)
+	{
+		SGE_TextureAtlasRegion *region = &atlas->regions[i];
+		SGE_TextureAtlasPage *oldPage = &oldPages[region->page];
+		const Uint8 *pixels = (const Uint8*)oldPage->texture->sourcePixels + ((size_t)region->rect.y * atlas->pageSize + region->rect.x) * 4;
+
+		int pageIndex = 0;
+		SDL_Rect rect;
+		if(!SGE_AtlasPack(atlas, region->rect.w, region->rect.h, &pageIndex, &rect))
+		{
+			/* Can only fail when out of memory, the texture stays in it's old page which is kept */
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to repack %dx%d image!", region->rect.w, region->rect.h);
+			if(keptPages[region->page] < 0)
+			{
+				keptPages[region->page] = SGE_KeepAtlasPage(atlas, oldPage);
+			}
+			region->page = keptPages[region->page];
+			continue;
+		}
+		SGE_TextureAtlasPage *page = &atlas->pages[pageIndex];
+		SGE_AtlasPageWrite(atlas, page, &rect, pixels, atlas->pageSize * 4);
+		page->regionCount++;
+
+		/* Move the texture and it's clip rect over to the new spot */
+		SGE_Texture *texture = region->texture;
+		texture->clipRect.x += rect.x - region->rect.x;
+		texture->clipRect.y += rect.y - region->rect.y;
+		texture->regionX = rect.x;
+		texture->regionY = rect.y;
+		texture->parent->regionCount--;
+		texture->parent = page->texture;
+		page->texture->regionCount++;
+		texture->texture = page->texture->texture;
+		texture->isStale = page->texture->isStale;
+		region->page = pageIndex;
+		region->rect = rect;
+	}
+
+	for(i = 0; i < oldPageCount; i++)
+	{
+		if(keptPages[i] < 0)
+		{
+			SGE_FreeAtlasPage(&oldPages[i]);
+		}
+	}
+	free(oldPages);
+	free(keptPages);
+
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Repacked %d images from %d into %d atlas pages.", atlas->regionCount, oldPageCount, atlas->pageCount);
+}
+
+void SGE_PrintTextureAtlas(SGE_TextureAtlas *atlas)
+{
+	int i = 0;
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Texture atlas: %d images in %d pages of %dx%d", atlas->regionCount, atlas->pageCount, atlas->pageSize, atlas->pageSize);
+	for(i = 0; i < atlas->pageCount; i++)
+	{
+		SGE_TextureAtlasPage *page = &atlas->pages[i];
+		SGE_LogPrintLine(SGE_LOG_DEBUG, "Page %d: %d images, %.1f%% used", i, page->regionCount, 100.0 * page->usedArea / ((double)atlas->pageSize * atlas->pageSize));
+	}
+}
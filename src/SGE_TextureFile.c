@@ -0,0 +1,551 @@
+#include "SGE_TextureFile.h"
+#include "SGE_Logger.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#define SGE_TEXTURE_FILE_MMAP
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define SGE_TEXTURE_FILE_MMAP
+#endif
+
+#define SGE_TEXTURE_FILE_HEADER_SIZE 16
+
+/* Smallest match, the part of the block that always ends in literals and how far before the end the last match can start */
+#define SGE_LZ4_MIN_MATCH 4
+#define SGE_LZ4_LAST_LITERALS 5
+#define SGE_LZ4_MATCH_LIMIT 12
+#define SGE_LZ4_MAX_OFFSET 65535
+#define SGE_LZ4_HASH_BITS 16
+
+bool SGE_IsTextureFilePath(const char *path)
+{
+	const char *extension = strrchr(path, '.');
+	return extension != NULL && strcmp(extension, ".sgetex") == 0;
+}
+
+/* Maps a whole file read only, returns NULL if it can't be mapped */
+static void *SGE_MapFile(const char *path, size_t *size)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	void *data = NULL;
+	if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping != NULL)
+		{
+			/* The view keeps the file open after the handles are closed */
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	*size = (data != NULL) ? (size_t)fileSize.QuadPart : 0;
+	return data;
+#elif defined(SGE_TEXTURE_FILE_MMAP)
+	int file = open(path, O_RDONLY);
+	if(file < 0)
+	{
+		return NULL;
+	}
+
+	struct stat info;
+	void *data = NULL;
+	if(fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if(data == MAP_FAILED)
+		{
+			data = NULL;
+		}
+	}
+	close(file);
+	*size = (data != NULL) ? (size_t)info.st_size : 0;
+	return data;
+#else
+	*size = 0;
+	return NULL;
+#endif
+}
+
+static void SGE_UnmapFile(void *data, size_t size)
+{
+#if defined(_WIN32)
+	UnmapViewOfFile(data);
+#elif defined(SGE_TEXTURE_FILE_MMAP)
+	munmap(data, size);
+#endif
+}
+
+static Uint16 SGE_ReadLE16At(const Uint8 *data)
+{
+	return (Uint16)(data[0] | (data[1] << 8));
+}
+
+static Uint32 SGE_ReadLE32At(const Uint8 *data)
+{
+	return (Uint32)data[0] | ((Uint32)data[1] << 8) | ((Uint32)data[2] << 16) | ((Uint32)data[3] << 24);
+}
+
+SGE_TextureFile *SGE_OpenTextureFile(const char *path)
+{
+	SGE_TextureFile *file = (SGE_TextureFile *)malloc(sizeof(SGE_TextureFile));
+	if(file == NULL)
+	{
+		SDL_SetError("Out of memory opening %s", path);
+		return NULL;
+	}
+	file->pixels = NULL;
+	file->decompressed = NULL;
+	file->isMapped = true;
+	file->data = SGE_MapFile(path, &file->dataSize);
+	if(file->data == NULL)
+	{
+		/* Files that can't be mapped, like assets packed inside an Android APK, are read instead */
+		file->isMapped = false;
+		file->data = SDL_LoadFile(path, &file->dataSize);
+		if(file->data == NULL)
+		{
+			free(file);
+			return NULL;
+		}
+	}
+
+	const Uint8 *header = (const Uint8 *)file->data;
+	if(file->dataSize < SGE_TEXTURE_FILE_HEADER_SIZE || memcmp(header, "SGET", 4) != 0)
+	{
+		SDL_SetError("%s is not a texture file", path);
+		SGE_CloseTextureFile(file);
+		return NULL;
+	}
+	if(SGE_ReadLE16At(header + 4) != SGE_TEXTURE_FILE_VERSION)
+	{
+		SDL_SetError("%s has unsupported texture file version %d", path, SGE_ReadLE16At(header + 4));
+		SGE_CloseTextureFile(file);
+		return NULL;
+	}
+
+	file->flags = SGE_ReadLE16At(header + 6);
+	file->w = SGE_ReadLE16At(header + 8);
+	file->h = SGE_ReadLE16At(header + 10);
+	Uint64 pixelSize = (Uint64)file->w * file->h * 4;
+	size_t storedSize = SGE_ReadLE32At(header + 12);
+	if(file->w == 0 || file->h == 0 || storedSize > file->dataSize - SGE_TEXTURE_FILE_HEADER_SIZE)
+	{
+		SDL_SetError("%s is missing pixel data", path);
+		SGE_CloseTextureFile(file);
+		return NULL;
+	}
+	/* Sizes are passed to SDL and the LZ4 decoder as ints */
+	if(pixelSize > INT_MAX || storedSize > INT_MAX)
+	{
+		SDL_SetError("%s is too large, %dx%d", path, file->w, file->h);
+		SGE_CloseTextureFile(file);
+		return NULL;
+	}
+
+	if(file->flags & SGE_TEXTURE_FILE_LZ4)
+	{
+		file->decompressed = malloc((size_t)pixelSize);
+		if(file->decompressed == NULL)
+		{
+			SDL_SetError("Out of memory decompressing %s", path);
+			SGE_CloseTextureFile(file);
+			return NULL;
+		}
+		if(!SGE_LZ4Decompress(header + SGE_TEXTURE_FILE_HEADER_SIZE, (int)storedSize, (Uint8 *)file->decompressed, (int)pixelSize))
+		{
+			SDL_SetError("%s has corrupt compressed pixels", path);
+			SGE_CloseTextureFile(file);
+			return NULL;
+		}
+		file->pixels = file->decompressed;
+	}
+	else
+	{
+		if(storedSize != pixelSize)
+		{
+			SDL_SetError("%s is missing pixel data", path);
+			SGE_CloseTextureFile(file);
+			return NULL;
+		}
+		file->pixels = header + SGE_TEXTURE_FILE_HEADER_SIZE;
+	}
+	return file;
+}
+
+void SGE_CloseTextureFile(SGE_TextureFile *file)
+{
+	if(file == NULL)
+	{
+		return;
+	}
+
+	if(file->isMapped)
+	{
+		SGE_UnmapFile(file->data, file->dataSize);
+	}
+	else
+	{
+		SDL_free(file->data);
+	}
+	free(file->decompressed);
+	free(file);
+}
+
+bool SGE_SaveTextureFile(SDL_Surface *surface, const char *path, int flags)
+{
+	/* Sizes are stored in 16 and 32 bits and passed to SDL and the LZ4 encoder as ints */
+	if(surface->w > 0xFFFF || surface->h > 0xFFFF || (Uint64)surface->w * surface->h * 4 > INT_MAX)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Image is too large for a texture file: %dx%d!", surface->w, surface->h);
+		return false;
+	}
+
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_BGRA32, 0);
+	if(converted == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to convert image for texture file: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
+	}
+
+	/* Pack the rows tightly */
+	int w = converted->w;
+	int h = converted->h;
+	int pixelSize = w * h * 4;
+	Uint8 *pixels = (Uint8 *)malloc(pixelSize);
+	if(pixels == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for texture file: %s!", path);
+		SDL_FreeSurface(converted);
+		return false;
+	}
+	int y = 0;
+	SDL_LockSurface(converted);
+	for(y = 0; y < h; y++)
+	{
+		memcpy(pixels + (size_t)y * w * 4, (const Uint8 *)converted->pixels + (size_t)y * converted->pitch, (size_t)w * 4);
+	}
+	SDL_UnlockSurface(converted);
+	SDL_FreeSurface(converted);
+
+	if(flags & SGE_TEXTURE_FILE_PREMULTIPLIED)
+	{
+		int i = 0;
+		for(i = 0; i < pixelSize; i += 4)
+		{
+			int alpha = pixels[i + 3];
+			pixels[i + 0] = (Uint8)((pixels[i + 0] * alpha + 127) / 255);
+			pixels[i + 1] = (Uint8)((pixels[i + 1] * alpha + 127) / 255);
+			pixels[i + 2] = (Uint8)((pixels[i + 2] * alpha + 127) / 255);
+		}
+	}
+
+	Uint8 *stored = pixels;
+	int storedSize = pixelSize;
+	Uint8 *compressed = NULL;
+	/* The compressed block has to fit in an int too */
+	if((flags & SGE_TEXTURE_FILE_LZ4) && pixelSize <= INT_MAX - INT_MAX / 255 - 16)
+	{
+		compressed = (Uint8 *)malloc(SGE_LZ4CompressBound(pixelSize));
+	}
+	if(compressed != NULL)
+	{
+		int compressedSize = SGE_LZ4Compress(pixels, pixelSize, compressed);
+		if(compressedSize < pixelSize)
+		{
+			stored = compressed;
+			storedSize = compressedSize;
+		}
+		else
+		{
+			/* Pixels that don't compress are loaded faster as they are */
+			flags &= ~SGE_TEXTURE_FILE_LZ4;
+		}
+	}
+	else
+	{
+		flags &= ~SGE_TEXTURE_FILE_LZ4;
+	}
+
+	SDL_RWops *file = SDL_RWFromFile(path, "wb");
+	if(file == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to write texture file: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		free(compressed);
+		free(pixels);
+		return false;
+	}
+
+	SDL_RWwrite(file, "SGET", 4, 1);
+	SDL_WriteLE16(file, SGE_TEXTURE_FILE_VERSION);
+	SDL_WriteLE16(file, flags & (SGE_TEXTURE_FILE_PREMULTIPLIED | SGE_TEXTURE_FILE_LZ4));
+	SDL_WriteLE16(file, w);
+	SDL_WriteLE16(file, h);
+	SDL_WriteLE32(file, storedSize);
+	bool success = SDL_RWwrite(file, stored, 1, storedSize) == (size_t)storedSize;
+	SDL_RWclose(file);
+	free(compressed);
+	free(pixels);
+
+	if(!success)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to write texture file: %s!", path);
+		return false;
+	}
+	SGE_LogPrintLine(SGE_LOG_DEBUG, "Wrote %dx%d texture file %s, %d bytes of pixels.", w, h, path, storedSize);
+	return true;
+}
+
+bool SGE_ConvertTextureFile(const char *imagePath, const char *outputPath, int flags)
+{
+	SDL_Surface *surface = IMG_Load(imagePath);
+	if(surface == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to load image: %s!", imagePath);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "IMG_Error: %s", IMG_GetError());
+		return false;
+	}
+
+	bool success = SGE_SaveTextureFile(surface, outputPath, flags);
+	SDL_FreeSurface(surface);
+	return success;
+}
+
+/*
+ * LZ4 blocks
+ * A block is a list of sequences, each a token byte holding the literal count in it's high and the match length in it's low 4 bits,
+ * extra length bytes when the literal count is 15, the literals, a Uint16 offset back into the output,
+ * then extra length bytes when the match length is 15. Match lengths are stored minus 4,
+ * and the last sequence has only literals.
+ */
+int SGE_LZ4CompressBound(int srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+static Uint32 SGE_LZ4Read32(const Uint8 *data)
+{
+	Uint32 value = 0;
+	memcpy(&value, data, 4);
+	return value;
+}
+
+static Uint32 SGE_LZ4Hash(Uint32 sequence)
+{
+	return (sequence * 2654435761u) >> (32 - SGE_LZ4_HASH_BITS);
+}
+
+/* Writes a length that didn't fit into it's 4 bits of the token */
+static int SGE_LZ4WriteLength(Uint8 *dst, int length)
+{
+	int written = 0;
+	while(length >= 255)
+	{
+		dst[written++] = 255;
+		length -= 255;
+	}
+	dst[written++] = (Uint8)length;
+	return written;
+}
+
+/* Writes a sequence of literals and a match, or only literals when "matchLength" is 0 */
+static int SGE_LZ4WriteSequence(Uint8 *dst, const Uint8 *literals, int literalCount, int offset, int matchLength)
+{
+	Uint8 *token = dst;
+	int written = 1;
+
+	if(literalCount >= 15)
+	{
+		*token = 15 << 4;
+		written += SGE_LZ4WriteLength(dst + written, literalCount - 15);
+	}
+	else
+	{
+		*token = (Uint8)(literalCount << 4);
+	}
+	memcpy(dst + written, literals, literalCount);
+	written += literalCount;
+
+	if(matchLength == 0)
+	{
+		return written;
+	}
+
+	dst[written++] = (Uint8)(offset & 0xFF);
+	dst[written++] = (Uint8)(offset >> 8);
+	matchLength -= SGE_LZ4_MIN_MATCH;
+	if(matchLength >= 15)
+	{
+		*token |= 15;
+		written += SGE_LZ4WriteLength(dst + written, matchLength - 15);
+	}
+	else
+	{
+		*token |= (Uint8)matchLength;
+	}
+	return written;
+}
+
+int SGE_LZ4Compress(const Uint8 *src, int srcSize, Uint8 *dst)
+{
+	int written = 0;
+	int anchor = 0;
+	int pos = 0;
+
+	/* Last position every 4 byte sequence was seen at, -1 for none, without it everything is stored as literals */
+	int *table = NULL;
+	if(srcSize > SGE_LZ4_MATCH_LIMIT)
+	{
+		table = (int *)malloc(sizeof(int) << SGE_LZ4_HASH_BITS);
+	}
+	if(table != NULL)
+	{
+		int matchStartLimit = srcSize - SGE_LZ4_MATCH_LIMIT;
+		int matchEndLimit = srcSize - SGE_LZ4_LAST_LITERALS;
+		int misses = 0;
+		memset(table, 0xFF, sizeof(int) << SGE_LZ4_HASH_BITS);
+
+		while(pos <= matchStartLimit)
+		{
+			Uint32 sequence = SGE_LZ4Read32(src + pos);
+			Uint32 hash = SGE_LZ4Hash(sequence);
+			int candidate = table[hash];
+			table[hash] = pos;
+
+			if(candidate < 0 || pos - candidate > SGE_LZ4_MAX_OFFSET || SGE_LZ4Read32(src + candidate) != sequence)
+			{
+				/* Skip ahead faster through data that doesn't compress */
+				misses++;
+				pos += 1 + (misses >> 6);
+				continue;
+			}
+			misses = 0;
+
+			/* Grow the match backwards over the pending literals, then forwards */
+			while(pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1])
+			{
+				pos--;
+				candidate--;
+			}
+			int matchLength = SGE_LZ4_MIN_MATCH;
+			while(pos + matchLength < matchEndLimit && src[pos + matchLength] == src[candidate + matchLength])
+			{
+				matchLength++;
+			}
+
+			written += SGE_LZ4WriteSequence(dst + written, src + anchor, pos - anchor, pos - candidate, matchLength);
+			pos += matchLength;
+			anchor = pos;
+			if(pos - 2 >= 0 && pos - 2 <= matchStartLimit)
+			{
+				table[SGE_LZ4Hash(SGE_LZ4Read32(src + pos - 2))] = pos - 2;
+			}
+		}
+		free(table);
+	}
+
+	written += SGE_LZ4WriteSequence(dst + written, src + anchor, srcSize - anchor, 0, 0);
+	return written;
+}
+
+/* Reads the extra length bytes following a token, returns false if they run past the end of the block */
+static bool SGE_LZ4ReadLength(const Uint8 *src, int srcSize, int *pos, size_t *length)
+{
+	Uint8 value = 255;
+	while(value == 255)
+	{
+		if(*pos >= srcSize)
+		{
+			return false;
+		}
+		value = src[(*pos)++];
+		*length += value;
+	}
+	return true;
+}
+
+bool SGE_LZ4Decompress(const Uint8 *src, int srcSize, Uint8 *dst, int dstSize)
+{
+	int pos = 0;
+	size_t written = 0;
+
+	while(pos < srcSize)
+	{
+		Uint8 token = src[pos++];
+
+		size_t literalCount = token >> 4;
+		if(literalCount == 15 && !SGE_LZ4ReadLength(src, srcSize, &pos, &literalCount))
+		{
+			return false;
+		}
+		if(literalCount > (size_t)(srcSize - pos) || literalCount > dstSize - written)
+		{
+			return false;
+		}
+		memcpy(dst + written, src + pos, literalCount);
+		pos += (int)literalCount;
+		written += literalCount;
+
+		/* The last sequence ends after it's literals */
+		if(pos == srcSize)
+		{
+			break;
+		}
+
+		if(srcSize - pos < 2)
+		{
+			return false;
+		}
+		size_t offset = src[pos] | (src[pos + 1] << 8);
+		pos += 2;
+		if(offset == 0 || offset > written)
+		{
+			return false;
+		}
+
+		size_t matchLength = token & 15;
+		if(matchLength == 15 && !SGE_LZ4ReadLength(src, srcSize, &pos, &matchLength))
+		{
+			return false;
+		}
+		matchLength += SGE_LZ4_MIN_MATCH;
+		if(matchLength > dstSize - written)
+		{
+			return false;
+		}
+
+		/* Matches can overlap their own output, copy them in growing steps that never overlap */
+		Uint8 *out = dst + written;
+		const Uint8 *match = out - offset;
+		size_t remaining = matchLength;
+		while(remaining > 0)
+		{
+			size_t step = SDL_min((size_t)(out - match), remaining);
+			memcpy(out, match, step);
+			out += step;
+			remaining -= step;
+		}
+		written += matchLength;
+	}
+	return written == (size_t)dstSize;
+}
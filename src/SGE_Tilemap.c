@@ -0,0 +1,522 @@
+#include "SGE_Tilemap.h"
+#include "SGE.h"
+#include "SGE_Logger.h"
+#include "SGE_Camera.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static SGE_TilemapChunk *SGE_TilemapGetChunk(SGE_Tilemap *map, int layer, int chunkX, int chunkY)
+{
+	return &map->layers[layer].chunks[chunkY * map->chunksX + chunkX];
+}
+
+static void SGE_FreeTilemapLayers(SGE_Tilemap *map)
+{
+	int i = 0;
+	int j = 0;
+	for(i = 0; i < map->layerCount; i++)
+	{
+		if(map->layers[i].chunks != NULL)
+		{
+			for(j = 0; j < map->chunksX * map->chunksY; j++)
+			{
+				if(map->layers[i].chunks[j].texture != NULL)
+				{
+					SGE_FreeTexture(map->layers[i].chunks[j].texture);
+				}
+			}
+		}
+		free(map->layers[i].tiles);
+		free(map->layers[i].chunks);
+	}
+	free(map->layers);
+}
+
+/* Halves the chunk size until a chunk's render target fits in the renderer's largest texture */
+static int SGE_TilemapGetChunkSize(int tileWidth, int tileHeight)
+{
+	int chunkSize = SGE_TILEMAP_CHUNK_SIZE;
+	SDL_RendererInfo info;
+	if(SGE_GetEngineData()->renderer == NULL || SDL_GetRendererInfo(SGE_GetEngineData()->renderer, &info) != 0)
+	{
+		return chunkSize;
+	}
+
+	/* A max size of 0 means there is no limit */
+	while(chunkSize > 1 && ((info.max_texture_width > 0 && chunkSize * tileWidth > info.max_texture_width) || (info.max_texture_height > 0 && chunkSize * tileHeight > info.max_texture_height)))
+	{
+		chunkSize /= 2;
+	}
+	if((info.max_texture_width > 0 && tileWidth > info.max_texture_width) || (info.max_texture_height > 0 && tileHeight > info.max_texture_height))
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Tiles of %dx%d are larger than the renderer's largest texture of %dx%d!", tileWidth, tileHeight, info.max_texture_width, info.max_texture_height);
+	}
+	return chunkSize;
+}
+
+SGE_Tilemap *SGE_CreateTilemap(SGE_Texture *tileset, int tileWidth, int tileHeight, int w, int h, int layerCount)
+{
+	if(tileset == NULL || tileWidth <= 0 || tileHeight <= 0 || w <= 0 || h <= 0 || layerCount <= 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Invalid tilemap size %dx%d with %d layers of %dx%d tiles!", w, h, layerCount, tileWidth, tileHeight);
+		return NULL;
+	}
+
+	SGE_Tilemap *map = (SGE_Tilemap*)malloc(sizeof(SGE_Tilemap));
+	if(map == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for tilemap!");
+		return NULL;
+	}
+
+	/* Regions report their own size in original_w and original_h */
+	map->tileset = tileset;
+	map->tileWidth = tileWidth;
+	map->tileHeight = tileHeight;
+	map->tilesetColumns = tileset->original_w / tileWidth;
+	map->tilesetTileCount = map->tilesetColumns * (tileset->original_h / tileHeight);
+	if(map->tilesetTileCount == 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Tileset is smaller than a single %dx%d tile!", tileWidth, tileHeight);
+	}
+
+	map->w = w;
+	map->h = h;
+	map->x = 0;
+	map->y = 0;
+	map->chunkSize = SGE_TilemapGetChunkSize(tileWidth, tileHeight);
+	map->chunksX = (w + map->chunkSize - 1) / map->chunkSize;
+	map->chunksY = (h + map->chunkSize - 1) / map->chunkSize;
+	map->lastDrawCalls = 0;
+	map->lastBakeCount = 0;
+
+	map->layerCount = layerCount;
+	map->layers = (SGE_TilemapLayer*)calloc(layerCount, sizeof(SGE_TilemapLayer));
+	if(map->layers == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for tilemap!");
+		free(map);
+		return NULL;
+	}
+
+	int i = 0;
+	for(i = 0; i < layerCount; i++)
+	{
+		map->layers[i].tiles = (Uint16*)calloc((size_t)w * h, sizeof(Uint16));
+		map->layers[i].chunks = (SGE_TilemapChunk*)calloc(map->chunksX * map->chunksY, sizeof(SGE_TilemapChunk));
+		map->layers[i].isVisible = true;
+		if(map->layers[i].tiles == NULL || map->layers[i].chunks == NULL)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to allocate memory for tilemap!");
+			SGE_FreeTilemapLayers(map);
+			free(map);
+			return NULL;
+		}
+	}
+
+	return map;
+}
+
+void SGE_FreeTilemap(SGE_Tilemap *map)
+{
+	if(map == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Attempt to free NULL tilemap!");
+		return;
+	}
+
+	SGE_FreeTilemapLayers(map);
+	free(map);
+}
+
+/* Counts the tiles of every chunk after a whole layer was filled in */
+static void SGE_TilemapCountTiles(SGE_Tilemap *map, int layer)
+{
+	int x = 0;
+	int y = 0;
+	for(y = 0; y < map->h; y++)
+	{
+		for(x = 0; x < map->w; x++)
+		{
+			if(map->layers[layer].tiles[y * map->w + x] != 0)
+			{
+				SGE_TilemapGetChunk(map, layer, x / map->chunkSize, y / map->chunkSize)->tileCount++;
+			}
+		}
+	}
+}
+
+SGE_Tilemap *SGE_LoadTilemap(const char *path, SGE_Texture *tileset)
+{
+	SDL_RWops *file = SDL_RWFromFile(path, "rb");
+	if(file == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to open tilemap: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return NULL;
+	}
+
+	char magic[4];
+	if(SDL_RWread(file, magic, 4, 1) != 1 || memcmp(magic, "SGEM", 4) != 0)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "%s is not a tilemap!", path);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	int version = SDL_ReadLE16(file);
+	if(version != SGE_TILEMAP_VERSION)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Tilemap %s has unsupported version %d!", path, version);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	int w = SDL_ReadLE16(file);
+	int h = SDL_ReadLE16(file);
+	int tileWidth = SDL_ReadLE16(file);
+	int tileHeight = SDL_ReadLE16(file);
+	int layerCount = SDL_ReadLE16(file);
+	SGE_Tilemap *map = SGE_CreateTilemap(tileset, tileWidth, tileHeight, w, h, layerCount);
+	if(map == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Tilemap %s is corrupt!", path);
+		SDL_RWclose(file);
+		return NULL;
+	}
+
+	int i = 0;
+	int j = 0;
+	for(i = 0; i < layerCount; i++)
+	{
+		Uint16 *tiles = map->layers[i].tiles;
+		if(SDL_RWread(file, tiles, sizeof(Uint16), (size_t)w * h) != (size_t)w * h)
+		{
+			SGE_LogPrintLine(SGE_LOG_ERROR, "Tilemap %s is corrupt!", path);
+			SGE_FreeTilemap(map);
+			SDL_RWclose(file);
+			return NULL;
+		}
+		for(j = 0; j < w * h; j++)
+		{
+			tiles[j] = SDL_SwapLE16(tiles[j]);
+		}
+		SGE_TilemapCountTiles(map, i);
+	}
+
+	SDL_RWclose(file);
+	return map;
+}
+
+bool SGE_SaveTilemap(SGE_Tilemap *map, const char *path)
+{
+	SDL_RWops *file = SDL_RWFromFile(path, "wb");
+	if(file == NULL)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to create tilemap file: %s!", path);
+		SGE_LogPrintLine(SGE_LOG_ERROR, "SDL_Error: %s", SDL_GetError());
+		return false;
+	}
+
+	bool isWritten = SDL_RWwrite(file, "SGEM", 4, 1) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, SGE_TILEMAP_VERSION) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, map->w) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, map->h) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, map->tileWidth) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, map->tileHeight) == 1;
+	isWritten = isWritten && SDL_WriteLE16(file, map->layerCount) == 1;
+
+	int i = 0;
+	int j = 0;
+	for(i = 0; i < map->layerCount && isWritten; i++)
+	{
+		for(j = 0; j < map->w * map->h && isWritten; j++)
+		{
+			isWritten = SDL_WriteLE16(file, map->layers[i].tiles[j]) == 1;
+		}
+	}
+
+	if(!isWritten)
+	{
+		SGE_LogPrintLine(SGE_LOG_ERROR, "Failed to write tilemap: %s!", path);
+	}
+	SDL_RWclose(file);
+	return isWritten;
+}
+
+static bool SGE_IsTileValid(SGE_Tilemap *map, int layer, int x, int y)
+{
+	return layer >= 0 && layer < map->layerCount && x >= 0 && x < map->w && y >= 0 && y < map->h;
+}
+
+/* Marks a tile's screen area as dirty, so a changed tile is drawn again in dirty rect mode */
+static void SGE_TilemapAddTileDirtyRect(SGE_Tilemap *map, int x, int y)
+{
+	if(!SGE_GetEngineData()->isDirtyRectMode)
+	{
+		return;
+	}
+
+	SDL_Rect rect = {map->x + x * map->tileWidth, map->y + y * map->tileHeight, map->tileWidth, map->tileHeight};
+	SGE_Camera *camera = SGE_GetCamera();
+	if(camera != NULL)
+	{
+		/* The tile can be rotated on screen, so the dirty rect covers all it's corners */
+		float cornersX[4] = {rect.x, rect.x + rect.w, rect.x + rect.w, rect.x};
+		float cornersY[4] = {rect.y, rect.y, rect.y + rect.h, rect.y + rect.h};
+		float left = 0, top = 0, right = 0, bottom = 0;
+		int i = 0;
+		for(i = 0; i < 4; i++)
+		{
+			float screenX = 0, screenY = 0;
+			SGE_CameraWorldToScreen(camera, cornersX[i], cornersY[i], &screenX, &screenY);
+			left = (i == 0) ? screenX : SDL_min(left, screenX);
+			top = (i == 0) ? screenY : SDL_min(top, screenY);
+			right = (i == 0) ? screenX : SDL_max(right, screenX);
+			bottom = (i == 0) ? screenY : SDL_max(bottom, screenY);
+		}
+		rect.x = (int)SDL_floorf(left) - 1;
+		rect.y = (int)SDL_floorf(top) - 1;
+		rect.w = (int)SDL_ceilf(right) + 1 - rect.x;
+		rect.h = (int)SDL_ceilf(bottom) + 1 - rect.y;
+	}
+	SGE_AddDirtyRect(&rect);
+}
+
+void SGE_TilemapSetTile(SGE_Tilemap *map, int layer, int x, int y, Uint16 tile)
+{
+	if(!SGE_IsTileValid(map, layer, x, y))
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Invalid tile %d, %d on tilemap layer %d!", x, y, layer);
+		return;
+	}
+
+	Uint16 *current = &map->layers[layer].tiles[y * map->w + x];
+	if(*current == tile)
+	{
+		return;
+	}
+
+	SGE_TilemapChunk *chunk = SGE_TilemapGetChunk(map, layer, x / map->chunkSize, y / map->chunkSize);
+	chunk->tileCount += (tile != 0) - (*current != 0);
+	chunk->isDirty = true;
+	*current = tile;
+	SGE_TilemapAddTileDirtyRect(map, x, y);
+
+	/* Chunks left empty give their texture back */
+	if(chunk->tileCount == 0 && chunk->texture != NULL)
+	{
+		SGE_FreeTexture(chunk->texture);
+		chunk->texture = NULL;
+	}
+}
+
+Uint16 SGE_TilemapGetTile(SGE_Tilemap *map, int layer, int x, int y)
+{
+	if(!SGE_IsTileValid(map, layer, x, y))
+	{
+		return 0;
+	}
+	return map->layers[layer].tiles[y * map->w + x];
+}
+
+bool SGE_TilemapGetTileAt(SGE_Tilemap *map, float worldX, float worldY, int *tileX, int *tileY)
+{
+	int x = (int)SDL_floorf((worldX - map->x) / map->tileWidth);
+	int y = (int)SDL_floorf((worldY - map->y) / map->tileHeight);
+	if(x < 0 || x >= map->w || y < 0 || y >= map->h)
+	{
+		return false;
+	}
+	*tileX = x;
+	*tileY = y;
+	return true;
+}
+
+void SGE_TilemapInvalidate(SGE_Tilemap *map)
+{
+	int i = 0;
+	int j = 0;
+	for(i = 0; i < map->layerCount; i++)
+	{
+		for(j = 0; j < map->chunksX * map->chunksY; j++)
+		{
+			map->layers[i].chunks[j].isDirty = true;
+		}
+	}
+	if(SGE_GetEngineData()->isDirtyRectMode)
+	{
+		SGE_InvalidateScreen();
+	}
+}
+
+/* Draws a chunk's tiles into it's texture, creating the texture the first time */
+static bool SGE_TilemapBakeChunk(SGE_Tilemap *map, int layer, int chunkX, int chunkY)
+{
+	SGE_EngineData *engine = SGE_GetEngineData();
+	SGE_TilemapChunk *chunk = SGE_TilemapGetChunk(map, layer, chunkX, chunkY);
+	int firstX = chunkX * map->chunkSize;
+	int firstY = chunkY * map->chunkSize;
+	int tilesX = SDL_min(map->chunkSize, map->w - firstX);
+	int tilesY = SDL_min(map->chunkSize, map->h - firstY);
+
+	if(chunk->texture == NULL)
+	{
+		chunk->texture = SGE_CreateTargetTexture(tilesX * map->tileWidth, tilesY * map->tileHeight);
+		if(chunk->texture == NULL)
+		{
+			return false;
+		}
+	}
+
+	/* Targets come back empty after the renderer lost them, so they are simply baked again */
+	if(chunk->texture->isStale && !SGE_RestoreTexture(chunk->texture))
+	{
+		return false;
+	}
+	if(map->tileset->isStale)
+	{
+		SGE_RestoreTexture(map->tileset);
+	}
+	if(map->tileset->texture == NULL)
+	{
+		return false;
+	}
+
+	SDL_Texture *previousTarget = engine->renderTarget;
+	bool wasClipEnabled = engine->isClipEnabled;
+	SDL_Rect previousClip = engine->clipRect;
+	SGE_SetRenderTarget(chunk->texture->texture);
+	if(engine->renderTarget != chunk->texture->texture)
+	{
+		return false;
+	}
+	SGE_SetClipRect(NULL);
+	SGE_ClearScreenRGBA(0, 0, 0, 0);
+
+	/* Tiles never overlap, so they are copied as they are and keep their own alpha */
+	SDL_Texture *tileset = map->tileset->texture;
+	SDL_SetTextureBlendMode(tileset, SDL_BLENDMODE_NONE);
+	SDL_SetTextureColorMod(tileset, 255, 255, 255);
+	SDL_SetTextureAlphaMod(tileset, 255);
+
+	Uint16 *tiles = map->layers[layer].tiles;
+	int x = 0;
+	int y = 0;
+	for(y = 0; y < tilesY; y++)
+	{
+		for(x = 0; x < tilesX; x++)
+		{
+			int tile = tiles[(firstY + y) * map->w + firstX + x];
+			if(tile == 0 || tile > map->tilesetTileCount)
+			{
+				continue;
+			}
+
+			SDL_Rect source;
+			source.x = map->tileset->regionX + ((tile - 1) % map->tilesetColumns) * map->tileWidth;
+			source.y = map->tileset->regionY + ((tile - 1) / map->tilesetColumns) * map->tileHeight;
+			source.w = map->tileWidth;
+			source.h = map->tileHeight;
+			SDL_Rect dest = {x * map->tileWidth, y * map->tileHeight, map->tileWidth, map->tileHeight};
+			SDL_RenderCopy(engine->renderer, tileset, &source, &dest);
+		}
+	}
+
+	SGE_RestoreTextureMods(map->tileset);
+	/* The chunk holds the tileset's pixels as they are, premultiplied ones included, so it blends like the tileset */
+	SGE_SetTextureBlendMode(chunk->texture, map->tileset->blendMode);
+
+	/* Changing the target resets the clip rect, the one set before baking is put back */
+	SGE_SetRenderTarget(previousTarget);
+	SGE_SetClipRect(wasClipEnabled ? &previousClip : NULL);
+
+	chunk->isDirty = false;
+	map->lastBakeCount++;
+	return true;
+}
+
+/* Bakes and draws the chunks of a layer that overlap the visible area */
+static void SGE_TilemapDrawLayer(SGE_Tilemap *map, int layer)
+{
+	SGE_EngineData *engine = SGE_GetEngineData();
+	SGE_Camera *camera = SGE_GetCamera();
+	SDL_FRect view = {0, 0, engine->screenWidth, engine->screenHeight};
+	if(camera != NULL)
+	{
+		view = camera->visibleArea;
+	}
+
+	int chunkWidth = map->chunkSize * map->tileWidth;
+	int chunkHeight = map->chunkSize * map->tileHeight;
+	int firstX = SDL_max(0, (int)SDL_floorf((view.x - map->x) / chunkWidth));
+	int firstY = SDL_max(0, (int)SDL_floorf((view.y - map->y) / chunkHeight));
+	int lastX = SDL_min(map->chunksX - 1, (int)SDL_floorf((view.x + view.w - map->x) / chunkWidth));
+	int lastY = SDL_min(map->chunksY - 1, (int)SDL_floorf((view.y + view.h - map->y) / chunkHeight));
+	int x = 0;
+	int y = 0;
+
+	/* Baking switches the render target, so all chunks are baked before any is drawn */
+	for(y = firstY; y <= lastY; y++)
+	{
+		for(x = firstX; x <= lastX; x++)
+		{
+			SGE_TilemapChunk *chunk = SGE_TilemapGetChunk(map, layer, x, y);
+			if(chunk->tileCount == 0)
+			{
+				continue;
+			}
+			if(chunk->texture == NULL || chunk->isDirty || chunk->texture->isStale)
+			{
+				if(!SGE_TilemapBakeChunk(map, layer, x, y))
+				{
+					SGE_LogPrintLine(SGE_LOG_WARNING, "Failed to bake tilemap chunk %d, %d of layer %d!", x, y, layer);
+				}
+			}
+		}
+	}
+
+	for(y = firstY; y <= lastY; y++)
+	{
+		for(x = firstX; x <= lastX; x++)
+		{
+			SGE_TilemapChunk *chunk = SGE_TilemapGetChunk(map, layer, x, y);
+			if(chunk->tileCount == 0 || chunk->texture == NULL || chunk->isDirty)
+			{
+				continue;
+			}
+			chunk->texture->x = map->x + x * chunkWidth;
+			chunk->texture->y = map->y + y * chunkHeight;
+			SGE_RenderTexture(chunk->texture);
+			map->lastDrawCalls++;
+		}
+	}
+}
+
+void SGE_TilemapRenderLayer(SGE_Tilemap *map, int layer)
+{
+	map->lastDrawCalls = 0;
+	map->lastBakeCount = 0;
+	if(layer < 0 || layer >= map->layerCount)
+	{
+		SGE_LogPrintLine(SGE_LOG_WARNING, "Invalid tilemap layer %d!", layer);
+		return;
+	}
+	SGE_TilemapDrawLayer(map, layer);
+}
+
+void SGE_TilemapRender(SGE_Tilemap *map)
+{
+	map->lastDrawCalls = 0;
+	map->lastBakeCount = 0;
+
+	int i = 0;
+	for(i = 0; i < map->layerCount; i++)
+	{
+		if(map->layers[i].isVisible)
+		{
+			SGE_TilemapDrawLayer(map, i);
+		}
+	}
+}
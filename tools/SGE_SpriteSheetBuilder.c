@@ -0,0 +1,38 @@
+#include "SGE_SpriteSheet.h"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Packs a folder of animation frames into a sprite sheet ahead of time.
+ * Compile it with the engine sources like any demo and run:
+ *   SGE_SpriteSheetBuilder [frame folder] [frame count] [output path] [frame duration in ms] [max sheet size]
+ * The frames have to be named 1.png, 2.png, ... [frame count].png
+ * Writes [output path].png and [output path].sgesheet, load the .sgesheet with SGE_CreateAnimatedSprite().
+ */
+int main(int argc, char **argv)
+{
+	if(argc < 4)
+	{
+		printf("Usage: %s [frame folder] [frame count] [output path] [frame duration in ms] [max sheet size]\n", argv[0]);
+		return 1;
+	}
+
+	int frameCount = atoi(argv[2]);
+	int frameDuration = (argc > 4) ? atoi(argv[4]) : 0;
+	int maxSize = (argc > 5) ? atoi(argv[5]) : 0;
+	if(frameCount <= 0)
+	{
+		printf("Frame count has to be more than 0!\n");
+		return 1;
+	}
+
+	/* Only surfaces are used, no window or renderer is needed */
+	IMG_Init(IMG_INIT_PNG);
+	bool success = SGE_BuildSpriteSheet(argv[1], frameCount, argv[3], frameDuration, maxSize);
+	IMG_Quit();
+	return success ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#include "SGE_TextureFile.h"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Converts images into .sgetex texture files ahead of time, so they are loaded without decoding them.
+ * Compile it with the engine sources like any demo and run:
+ *   SGE_TextureConverter [image path] [output path] [-lz4] [-premultiplied]
+ * -lz4 compresses the pixels, -premultiplied stores colors premultiplied by alpha.
+ * Load the output with SGE_LoadTexture() like any other image.
+ */
+int main(int argc, char **argv)
+{
+	if(argc < 3)
+	{
+		printf("Usage: %s [image path] [output path] [-lz4] [-premultiplied]\n", argv[0]);
+		return 1;
+	}
+
+	int flags = 0;
+	int i = 0;
+	for(i = 3; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-lz4") == 0)
+		{
+			flags |= SGE_TEXTURE_FILE_LZ4;
+		}
+		else if(strcmp(argv[i], "-premultiplied") == 0)
+		{
+			flags |= SGE_TEXTURE_FILE_PREMULTIPLIED;
+		}
+		else
+		{
+			printf("Unknown option: %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	/* Only surfaces are used, no window or renderer is needed */
+	IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+	bool success = SGE_ConvertTextureFile(argv[1], argv[2], flags);
+	IMG_Quit();
+	return success ? 0 : 1;
+}